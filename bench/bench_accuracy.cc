@@ -0,0 +1,416 @@
+// 精度和速度回归测试: 标注来自 tests/images/joint/<hand>_annotations/<Joint>_Grade<N>.png
+// 1. crops: 把标注好的关节裁剪图直接送进分类模型, 每只手的关节一次 Classify, 和文件名里的等级比较
+// 2. pipeline: 同名的整手图 (tests/images/hand/<hand>.jpg) 走完整的 BoneAgeInferencer, 按关节名和标注比较
+// 输出每个关节的一致率 (完全一致 / 相差不超过 1 级)、延迟和吞吐, 一行 JSON
+// 性能模式 (缩小解码、INT8 模型、batching 等) 先在默认配置下 --out 存一份基线, 再带 --baseline 跑新配置:
+// 吞吐不低于基线的 --min-speedup 倍、一致率下降不超过 --max-accuracy-drop 个百分点才算通过, 否则返回 2
+#include "inference/boneage_inference.h"
+#include "nn/classify.h"
+#include "nn/precision.h"
+#include "logging/logger.h"
+#include "bone_info.h"
+#include "CLI/CLI.hpp"
+#include <nlohmann/json.hpp>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+using inference::BoneAgeInferencer;
+using json = nlohmann::ordered_json;
+
+namespace {
+
+// 标注文件名里的关节名, 和前端 res/js/scripts.js 的 JOINT_NAMES_EN 一致
+struct AnnotatedJoint {
+    std::string_view annotation_name;
+    std::string_view joint;  // BoneInfo::kKeyJoints
+    int category_id;         // BoneInfo::kClsBones
+};
+
+constexpr AnnotatedJoint kAnnotatedJoints[] = {
+    {"Radius", "radius", 0},
+    {"Ulna", "ulna", 1},
+    {"First_Metacarpal", "mcpfirst", 2},
+    {"Third_Metacarpal", "mcpthird", 3},
+    {"Fifth_Metacarpal", "mcpfifth", 3},
+    {"First_Proximal_Phalanx", "pipfirst", 4},
+    {"Third_Proximal_Phalanx", "pipthird", 5},
+    {"Fifth_Proximal_Phalanx", "pipfifth", 5},
+    {"Third_Middle_Phalanx", "mipthird", 6},
+    {"Fifth_Middle_Phalanx", "mipfifth", 6},
+    {"First_Distal_Phalanx", "dipfirst", 7},
+    {"Third_Distal_Phalanx", "dipthird", 8},
+    {"Fifth_Distal_Phalanx", "dipfifth", 8},
+};
+
+struct Crop {
+    std::string joint;
+    int category_id;
+    int grade;
+    cv::Mat image;
+};
+
+struct Case {
+    std::string name;
+    std::vector<Crop> crops;
+    std::vector<unsigned char> hand; // 没有同名整手图时为空
+};
+
+struct Agreement {
+    uint64_t total{0};
+    uint64_t exact{0};
+    uint64_t within_one{0};
+
+    void Add(int predicted, int expected) {
+        total++;
+        exact += predicted == expected ? 1 : 0;
+        within_one += std::abs(predicted - expected) <= 1 ? 1 : 0;
+    }
+};
+
+// 每个关节和总体的一致率
+class AgreementTable {
+public:
+    void Add(const std::string& joint, int predicted, int expected) {
+        per_joint_[joint].Add(predicted, expected);
+        overall_.Add(predicted, expected);
+    }
+
+    double ExactRate() const { return Rate(overall_.exact, overall_.total); }
+
+    json ToJson() const {
+        json per_joint = json::object();
+        for (const auto& annotated : kAnnotatedJoints) {
+            auto it = per_joint_.find(std::string(annotated.joint));
+            if (it != per_joint_.end()) {
+                per_joint[std::string(annotated.joint)] = ToJson_(it->second);
+            }
+        }
+        json result = ToJson_(overall_);
+        result["per_joint"] = per_joint;
+        return result;
+    }
+
+    static double Rate(uint64_t n, uint64_t total) { return total == 0 ? 0.0 : static_cast<double>(n) / total; }
+
+private:
+    static json ToJson_(const Agreement& agreement) {
+        return {{"n", agreement.total},
+                {"exact", Rate(agreement.exact, agreement.total)},
+                {"within_one", Rate(agreement.within_one, agreement.total)}};
+    }
+
+    std::map<std::string, Agreement> per_joint_;
+    Agreement overall_;
+};
+
+json LatencyJson(std::vector<uint64_t> latencies_ns) {
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    auto at = [&latencies_ns](double q) {
+        size_t index = std::min(latencies_ns.size() - 1, static_cast<size_t>(q * latencies_ns.size()));
+        return latencies_ns[index] / 1e6;
+    };
+    if (latencies_ns.empty()) {
+        return json::object();
+    }
+    return {{"p50", at(0.5)}, {"p90", at(0.9)}, {"p99", at(0.99)}, {"max", latencies_ns.back() / 1e6}};
+}
+
+int ImreadFlags(BoneAgeInferencer::DecodeMode mode) {
+    switch (mode) {
+    case BoneAgeInferencer::DecodeMode::kReduced2:
+        return cv::IMREAD_REDUCED_COLOR_2;
+    case BoneAgeInferencer::DecodeMode::kReduced4:
+        return cv::IMREAD_REDUCED_COLOR_4;
+    default:
+        return cv::IMREAD_COLOR;
+    }
+}
+
+std::vector<unsigned char> ReadFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// 裁剪图按和整手图相同的解码方式读取, 缩小解码对分类精度的影响在 crops 里也能看到
+std::vector<Case> LoadCases(const fs::path& joint_dir, const fs::path& hand_dir, int imread_flags) {
+    std::vector<Case> cases;
+    if (!fs::is_directory(joint_dir)) {
+        return cases;
+    }
+    const std::string suffix = "_annotations";
+    for (const auto& entry : fs::directory_iterator(joint_dir)) {
+        std::string dir_name = entry.path().filename().string();
+        if (!entry.is_directory() || dir_name.size() <= suffix.size() ||
+            dir_name.compare(dir_name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        Case c;
+        c.name = dir_name.substr(0, dir_name.size() - suffix.size());
+        for (const auto& file : fs::directory_iterator(entry.path())) {
+            std::string stem = file.path().stem().string();
+            size_t grade_pos = stem.rfind("_Grade");
+            if (grade_pos == std::string::npos) {
+                continue;
+            }
+            std::string_view annotation_name(stem.data(), grade_pos);
+            auto it = std::find_if(std::begin(kAnnotatedJoints), std::end(kAnnotatedJoints),
+                                   [&](const AnnotatedJoint& joint) { return joint.annotation_name == annotation_name; });
+            cv::Mat image = cv::imread(file.path().string(), imread_flags);
+            if (it == std::end(kAnnotatedJoints) || image.empty()) {
+                LOG_WARN("skip annotation {}", file.path().string());
+                continue;
+            }
+            c.crops.push_back({std::string(it->joint), it->category_id, std::atoi(stem.c_str() + grade_pos + 6), image});
+        }
+        for (const char* ext : {".jpg", ".jpeg", ".png", ".bmp"}) {
+            fs::path hand = hand_dir / (c.name + ext);
+            if (fs::exists(hand)) {
+                c.hand = ReadFile(hand);
+                break;
+            }
+        }
+        cases.push_back(std::move(c));
+    }
+    std::sort(cases.begin(), cases.end(), [](const Case& a, const Case& b) { return a.name < b.name; });
+    return cases;
+}
+
+// 按基线判断: 一致率下降不超过 max_drop 个百分点, 吞吐不低于基线的 min_speedup 倍
+json Gate(const json& current, const json& baseline, double max_drop, double min_speedup) {
+    json checks = json::array();
+    bool passed = true;
+    for (const char* section : {"crops", "pipeline"}) {
+        if (!current.contains(section) || !baseline.contains(section) ||
+            current[section].value("n", 0) == 0 || baseline[section].value("n", 0) == 0) {
+            continue;
+        }
+        double now = current[section]["exact"].get<double>();
+        double before = baseline[section]["exact"].get<double>();
+        bool ok = (before - now) * 100 <= max_drop;
+        passed = passed && ok;
+        checks.push_back({{"metric", std::string(section) + ".exact"}, {"baseline", before}, {"current", now}, {"passed", ok}});
+    }
+    // 有整手图时以完整流水线的吞吐为准, 否则看分类
+    const char* speed_section = current["pipeline"].value("n", 0) > 0 ? "pipeline" : "crops";
+    if (baseline.contains(speed_section) && baseline[speed_section].contains("throughput")) {
+        double now = current[speed_section]["throughput"].get<double>();
+        double before = baseline[speed_section]["throughput"].get<double>();
+        bool ok = now >= before * min_speedup;
+        passed = passed && ok;
+        checks.push_back({{"metric", std::string(speed_section) + ".throughput"}, {"baseline", before}, {"current", now}, {"passed", ok}});
+    }
+    return {{"passed", passed}, {"max_accuracy_drop", max_drop}, {"min_speedup", min_speedup}, {"checks", checks}};
+}
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"bone age accuracy and speed regression harness"};
+
+    const fs::path images_root = (fs::path(__FILE__).parent_path() / ".." / "tests" / "images").lexically_normal();
+    std::string joint_dir = (images_root / "joint").string();
+    std::string hand_dir = (images_root / "hand").string();
+    std::string yolo_model = "models/yolo11m_detect.onnx";
+    std::string cls_model = "models/bone_maturity_predict.onnx";
+    size_t threads = 2;
+    size_t batch_size = 1;
+    std::string decode = "full";
+    bool use_gpu = false;
+    std::string detect_precision = "fp32";
+    std::string classify_precision = "fp32";
+    int repeat = 5;
+    std::string baseline_path;
+    std::string out_path;
+    double max_accuracy_drop = 1.0;
+    double min_speedup = 1.0;
+
+    app.add_option("--joints", joint_dir, "Folder of <hand>_annotations directories");
+    app.add_option("--hands", hand_dir, "Folder of full hand images named <hand>.jpg");
+    app.add_option("--yolo-model", yolo_model, "Detection model");
+    app.add_option("--cls-model", cls_model, "Classification model");
+    app.add_option("--threads", threads, "Inference scheduler threads");
+    app.add_option("--batch-size", batch_size, "Max images per model batch");
+    app.add_option("--decode", decode, "full, reduced2 or reduced4")
+        ->check(CLI::IsMember({"full", "reduced2", "reduced4"}));
+    app.add_option("--use-gpu", use_gpu, "Use CUDA when available (default CPU only)");
+    app.add_option("--detect-precision", detect_precision, "fp32, or int8 to load <yolo-model>_int8.onnx")
+        ->check(CLI::IsMember({"fp32", "int8"}));
+    app.add_option("--classify-precision", classify_precision, "fp32, or int8 to load <cls-model>_int8.onnx")
+        ->check(CLI::IsMember({"fp32", "int8"}));
+    app.add_option("--repeat", repeat, "Timed passes over the data set; accuracy comes from the first");
+    app.add_option("--baseline", baseline_path, "Output of an earlier run to gate against");
+    app.add_option("--out", out_path, "Also write the result to this file (to use as a baseline)");
+    app.add_option("--max-accuracy-drop", max_accuracy_drop, "Allowed drop in exact agreement, percentage points");
+    app.add_option("--min-speedup", min_speedup, "Required throughput relative to the baseline");
+    CLI11_PARSE(app, argc, argv);
+
+    logging::InitConsole(logging::LogLevel::Warn);
+    repeat = std::max(repeat, 1);
+
+    std::map<std::string, BoneAgeInferencer::DecodeMode> decode_modes{
+        {"full", BoneAgeInferencer::DecodeMode::kFull},
+        {"reduced2", BoneAgeInferencer::DecodeMode::kReduced2},
+        {"reduced4", BoneAgeInferencer::DecodeMode::kReduced4},
+    };
+    std::map<std::string, nn::Precision> precisions{
+        {"fp32", nn::Precision::kFp32},
+        {"int8", nn::Precision::kInt8},
+    };
+    const auto decode_mode = decode_modes.at(decode);
+
+    auto cases = LoadCases(joint_dir, hand_dir, ImreadFlags(decode_mode));
+    if (cases.empty()) {
+        std::fprintf(stderr, "no annotations in %s\n", joint_dir.c_str());
+        return 1;
+    }
+
+    json result;
+    result["config"] = {{"cls_model", cls_model}, {"yolo_model", yolo_model}, {"decode", decode},
+                        {"batch_size", batch_size}, {"threads", threads}, {"gpu", use_gpu}, {"repeat", repeat},
+                        {"detect_precision", detect_precision}, {"classify_precision", classify_precision}};
+
+    // ====== crops ======
+    {
+        auto env = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "bench_accuracy");
+        // 和 BoneAgeInferencer::Init 一样, 没有 CUDA provider 时退回 CPU
+        auto providers = Ort::GetAvailableProviders();
+        // int8 模型和 BoneAgeInferencer::Init 一样只在 CPU 上跑
+        const auto crops_precision = precisions.at(classify_precision);
+        bool crops_gpu = use_gpu && crops_precision == nn::Precision::kFp32 &&
+                         std::find(providers.begin(), providers.end(), "CUDAExecutionProvider") != providers.end();
+        nn::MaturityClassifier classifier(env, nn::ModelPathFor(cls_model, crops_precision), crops_gpu, {112, 112}, {13});
+        AgreementTable table;
+        std::vector<uint64_t> latencies;
+        size_t classified = 0;
+        auto start = Clock::now();
+        for (int pass = 0; pass < repeat; pass++) {
+            for (const auto& c : cases) {
+                std::vector<cv::Mat> images;
+                std::vector<int64_t> category_ids;
+                for (const auto& crop : c.crops) {
+                    images.push_back(crop.image);
+                    category_ids.push_back(crop.category_id);
+                }
+                auto call_start = Clock::now();
+                auto predictions = classifier.Classify(images, category_ids);
+                latencies.push_back((Clock::now() - call_start).count());
+                classified += images.size();
+                if (pass == 0) {
+                    for (size_t i = 0; i < c.crops.size(); i++) {
+                        table.Add(c.crops[i].joint, predictions[i].maturity_stage, c.crops[i].grade);
+                    }
+                }
+            }
+        }
+        double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+        result["crops"] = table.ToJson();
+        result["crops"]["throughput"] = classified / elapsed_s; // 关节/秒
+        result["crops"]["latency_ms"] = LatencyJson(latencies); // 每只手一次 Classify
+    }
+
+    // ====== pipeline ======
+    {
+        INFERENCER.SetDecodeMode(decode_mode);
+        INFERENCER.Init(threads, yolo_model, cls_model, batch_size, use_gpu,
+                    precisions.at(detect_precision), precisions.at(classify_precision));
+
+        std::vector<const Case*> hands;
+        for (const auto& c : cases) {
+            if (!c.hand.empty()) {
+                hands.push_back(&c);
+            }
+        }
+
+        AgreementTable table;
+        uint64_t missing = 0;
+        uint64_t failed = 0;
+        std::vector<uint64_t> latencies;
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        auto start = Clock::now();
+        for (int pass = 0; pass < repeat && !hands.empty(); pass++) {
+            // 一轮的图一起提交, batch_size > 1 时调度线程能凑 batch
+            std::vector<std::optional<BoneAgeInferencer::InferenceResult>> results(hands.size());
+            size_t remaining = hands.size();
+            for (size_t i = 0; i < hands.size(); i++) {
+                BoneAgeInferencer::InferenceTask task;
+                task.raw_image_data = hands[i]->hand;
+                auto submit = Clock::now();
+                task.on_complete = [&, i, submit](BoneAgeInferencer::InferenceResult r) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    latencies.push_back((Clock::now() - submit).count());
+                    results[i] = std::move(r);
+                    if (--remaining == 0) {
+                        done_cv.notify_one();
+                    }
+                };
+                INFERENCER.PostInference(std::move(task));
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            done_cv.wait(lock, [&remaining]() { return remaining == 0; });
+            if (pass > 0) {
+                continue;
+            }
+            for (size_t i = 0; i < hands.size(); i++) {
+                std::map<std::string, int> predicted;
+                if (results[i]->status == BoneAgeInferencer::Status::kOk) {
+                    auto hand = json::parse(results[i]->result_str, nullptr, false);
+                    if (!hand.is_discarded()) {
+                        for (const auto& bone : hand["bones_detail"]) {
+                            predicted[bone["joint"].get<std::string>()] = bone["maturity_stage"].get<int>();
+                        }
+                    }
+                } else {
+                    failed++;
+                }
+                for (const auto& crop : hands[i]->crops) {
+                    auto it = predicted.find(crop.joint);
+                    if (it == predicted.end()) {
+                        missing++; // 没检出的关节按不一致算
+                    }
+                    table.Add(crop.joint, it == predicted.end() ? -1 : it->second, crop.grade);
+                }
+            }
+        }
+        double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+        result["pipeline"] = table.ToJson();
+        result["pipeline"]["hands"] = hands.size();
+        result["pipeline"]["missing_joints"] = missing;
+        result["pipeline"]["failed"] = failed;
+        result["pipeline"]["throughput"] = hands.empty() ? 0.0 : hands.size() * repeat / elapsed_s; // 图/秒
+        result["pipeline"]["latency_ms"] = LatencyJson(latencies);
+        INFERENCER.Shutdown();
+    }
+
+    int exit_code = 0;
+    if (!baseline_path.empty()) {
+        std::ifstream file(baseline_path);
+        auto baseline = json::parse(file, nullptr, false);
+        if (baseline.is_discarded()) {
+            std::fprintf(stderr, "cannot parse baseline %s\n", baseline_path.c_str());
+            return 1;
+        }
+        result["gate"] = Gate(result, baseline, max_accuracy_drop, min_speedup);
+        exit_code = result["gate"]["passed"].get<bool>() ? 0 : 2;
+    }
+
+    std::printf("%s\n", result.dump().c_str());
+    std::fflush(stdout);
+    if (!out_path.empty()) {
+        std::ofstream(out_path) << result.dump(2) << "\n";
+    }
+    return exit_code;
+}
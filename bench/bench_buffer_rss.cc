@@ -0,0 +1,146 @@
+// 长连接内存占用测试: N 个客户端各上传一次, 然后保持连接空闲, 统计服务端进程的 RSS
+#include "net/tcpserver.h"
+#include "net/eventloop.h"
+#include "net/inetaddress.h"
+#include "CLI/CLI.hpp"
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+long ReadRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::stol(line.substr(6));
+        }
+    }
+    return -1;
+}
+
+void RaiseFdLimit() {
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int ConnectTo(const net::InetAddress& addr) {
+    for (int retry = 0; retry < 100; retry++) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (::connect(fd, addr.GetSockAddr(), sizeof(sockaddr_in)) == 0) {
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+bool SendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"buffer rss benchmark"};
+    int clients = 10000;
+    size_t upload_bytes = 1024 * 1024;
+    int io_threads = 4;
+    int client_threads = 8;
+    uint16_t port = 18080;
+    app.add_option("--clients", clients, "Number of keep-alive clients");
+    app.add_option("--upload-bytes", upload_bytes, "Bytes each client uploads once");
+    app.add_option("--io-threads", io_threads, "Number of server IO threads");
+    app.add_option("--client-threads", client_threads, "Number of client threads");
+    app.add_option("--port", port, "Loopback port");
+    CLI11_PARSE(app, argc, argv);
+
+    RaiseFdLimit();
+    net::InetAddress listen_addr("127.0.0.1", port);
+
+    // 服务端: 收满 upload_bytes 后回复 "ok", 之后连接保持空闲
+    std::thread server_thread([&]() {
+        net::TcpServer server(listen_addr, "rss");
+        server.SetThreadNum(io_threads);
+        server.SetConnectionCallback([](const net::TcpConnection::Ptr& conn) {
+            if (conn->IsConnected()) {
+                conn->SetContext(size_t(0));
+            }
+        });
+        server.SetMessageCallback([upload_bytes](const net::TcpConnection::Ptr& conn, net::Buffer& buf) {
+            size_t* received = std::any_cast<size_t>(conn->GetMutableContext());
+            *received += buf.ReadableBytes();
+            buf.RetrieveAll();
+            if (*received >= upload_bytes) {
+                *received = 0;
+                conn->Send("ok");
+            }
+        });
+        server.Start();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    long baseline_rss = ReadRssKb();
+
+    std::vector<int> fds(clients, -1);
+    std::atomic<int> failed{0};
+    const std::string payload(upload_bytes, 'x');
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < client_threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (int i = t; i < clients; i += client_threads) {
+                int fd = ConnectTo(listen_addr);
+                char ack[2];
+                if (fd < 0 || !SendAll(fd, payload) || ::recv(fd, ack, sizeof(ack), MSG_WAITALL) != 2) {
+                    failed++;
+                }
+                fds[i] = fd;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 等 IO 线程处理完最后的事件
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    long loaded_rss = ReadRssKb();
+
+    std::printf("{\"clients\": %d, \"upload_bytes\": %zu, \"io_threads\": %d, \"failed\": %d, "
+                "\"elapsed_s\": %.3f, \"baseline_rss_kb\": %ld, \"idle_rss_kb\": %ld, "
+                "\"rss_per_conn_bytes\": %.1f}\n",
+                clients, upload_bytes, io_threads, failed.load(), elapsed_s, baseline_rss, loaded_rss,
+                clients > 0 ? (loaded_rss - baseline_rss) * 1024.0 / clients : 0.0);
+    std::fflush(stdout);
+
+    // TcpServer 没有停止接口, 直接退出进程
+    ::_exit(0);
+}
@@ -0,0 +1,69 @@
+// 跨线程投递吞吐测试: 多个线程同时向一个 EventLoop QueueInLoop, 统计每秒投递数和 eventfd 唤醒数
+#include "net/eventloop.h"
+#include "CLI/CLI.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    CLI::App app{"eventloop cross-thread post benchmark"};
+    int producers = 4;
+    int tasks_per_producer = 1000000;
+    app.add_option("--producers", producers, "Number of posting threads");
+    app.add_option("--tasks", tasks_per_producer, "Tasks posted by each thread");
+    CLI11_PARSE(app, argc, argv);
+
+    std::promise<net::EventLoop*> promise;
+    auto future = promise.get_future();
+    std::thread loop_thread([&]() {
+        net::EventLoop loop;
+        promise.set_value(&loop);
+        loop.Loop();
+    });
+    net::EventLoop* loop = future.get();
+
+    const uint64_t total = static_cast<uint64_t>(producers) * tasks_per_producer;
+    std::atomic<uint64_t> executed{0};
+    std::promise<void> done;
+    auto done_future = done.get_future();
+
+    uint64_t wakeups_before = loop->GetWakeupCount();
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < tasks_per_producer; i++) {
+                loop->QueueInLoop([&]() {
+                    if (executed.fetch_add(1, std::memory_order_relaxed) + 1 == total) {
+                        done.set_value();
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto posted = std::chrono::steady_clock::now();
+    done_future.wait();
+    auto finished = std::chrono::steady_clock::now();
+
+    double post_s = std::chrono::duration<double>(posted - start).count();
+    double total_s = std::chrono::duration<double>(finished - start).count();
+    uint64_t wakeups = loop->GetWakeupCount() - wakeups_before;
+
+    std::printf("{\"producers\": %d, \"tasks\": %llu, \"post_s\": %.3f, \"total_s\": %.3f, "
+                "\"posts_per_sec\": %.0f, \"executed_per_sec\": %.0f, \"wakeups\": %llu, "
+                "\"wakeups_per_sec\": %.0f, \"tasks_per_wakeup\": %.1f}\n",
+                producers, static_cast<unsigned long long>(total), post_s, total_s,
+                total / post_s, total / total_s, static_cast<unsigned long long>(wakeups),
+                wakeups / total_s, wakeups > 0 ? static_cast<double>(total) / wakeups : 0.0);
+
+    loop->Quit();
+    loop_thread.join();
+    return 0;
+}
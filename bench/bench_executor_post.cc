@@ -0,0 +1,89 @@
+// Executor 投递吞吐测试: 多个线程通过 EXECUTOR->PostTask 向同一个并行 runner 投递,
+// 统计每秒投递数, 以及每次投递平均的堆分配次数 (替换全局 operator new 计数)
+#include "context/context.h"
+#include "CLI/CLI.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"executor post benchmark"};
+    int producers = 8;
+    int posts_per_producer = 200000;
+    int workers = 4;
+    app.add_option("--producers", producers, "Number of posting threads");
+    app.add_option("--posts", posts_per_producer, "Posts issued by each thread");
+    app.add_option("--workers", workers, "Worker threads of the target runner");
+    CLI11_PARSE(app, argc, argv);
+
+    ctx::TaskRunnerTag tag = NEW_PARALLEL_RUNNER(1, workers);
+
+    const uint64_t total = static_cast<uint64_t>(producers) * posts_per_producer;
+    std::atomic<uint64_t> executed{0};
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    uint64_t allocations_before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            // 捕获几个指针和整数, 是业务代码里常见的 lambda 大小
+            uint64_t a = 1, b = 2;
+            for (int i = 0; i < posts_per_producer; i++) {
+                EXECUTOR->PostTask(tag, [&executed, &done_mutex, &done_cv, total, a, b]() {
+                    if (executed.fetch_add(a + b - 2, std::memory_order_relaxed) + 1 == total) {
+                        std::lock_guard<std::mutex> lock(done_mutex);
+                        done_cv.notify_one();
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto posted = std::chrono::steady_clock::now();
+    uint64_t allocations = g_allocations.load() - allocations_before;
+    {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait(lock, [&]() { return executed.load() == total; });
+    }
+    auto finished = std::chrono::steady_clock::now();
+
+    double post_s = std::chrono::duration<double>(posted - start).count();
+    double total_s = std::chrono::duration<double>(finished - start).count();
+    std::printf("{\"producers\": %d, \"workers\": %d, \"posts\": %llu, \"post_s\": %.3f, \"total_s\": %.3f, "
+                "\"posts_per_sec\": %.0f, \"executed_per_sec\": %.0f, \"allocs_per_post\": %.3f}\n",
+                producers, workers, static_cast<unsigned long long>(total), post_s, total_s,
+                total / post_s, total / total_s, static_cast<double>(allocations) / total);
+    std::fflush(stdout);
+    std::_Exit(0);
+}
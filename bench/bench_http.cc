@@ -0,0 +1,618 @@
+// HTTP 压测工具, 取代 k6 脚本: 基于项目自己的 net::EventLoop, 每个 IO 线程管理一部分连接
+// closed 模式: 每个连接保持 --pipeline 个请求在途, 响应回来马上补发, 测服务端极限
+// open 模式: 总速率 --rate 平均分给所有连接, 每个连接按固定间隔产生请求, 连接忙时在本地排队
+// 延迟从请求的计划发送时刻算起 (和 wrk2 一样), 服务端变慢时排队时间也算进去, 不会出现 coordinated omission;
+// closed 模式没有计划时刻, 可以用 --expected-interval-us 按 HdrHistogram 的方法补记被漏掉的样本
+// 延迟记进 metrics::Histogram, --prom-out 按服务端 /metrics 相同的 Prometheus 格式和桶边界输出, 看板可以直接用
+// 结果打印一行 JSON
+#include "net/buffer.h"
+#include "net/eventloop.h"
+#include "net/eventloopthreadpool.h"
+#include "net/inetaddress.h"
+#include "net/channel.h"
+#include "net/tcpconnection.h"
+#include "logging/logger.h"
+#include "metrics/registry.h"
+#include "CLI/CLI.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 80;
+    std::string method = "POST";
+    std::string path = "/predict";
+    std::string images_dir = (fs::path(__FILE__).parent_path() / ".." / "tests" / "images" / "hand").lexically_normal().string();
+    std::string mode = "closed";
+    size_t connections = 64;
+    int threads = 2;
+    size_t pipeline = 1;
+    bool keep_alive = true;
+    double rate = 100;
+    double duration_s = 10;
+    double warmup_s = 2;
+    double drain_timeout_s = 10;
+    uint64_t expected_interval_us = 0;
+    std::string prom_out;
+};
+
+// 预先拼好的完整请求报文, POST 时每张图一个 multipart 请求
+std::vector<std::string> BuildRequests(const Options& options) {
+    std::string common = "Host: " + options.host + ":" + std::to_string(options.port) + "\r\n";
+    if (!options.keep_alive) {
+        common += "Connection: close\r\n";
+    }
+
+    std::vector<std::string> requests;
+    if (options.method == "GET") {
+        requests.push_back("GET " + options.path + " HTTP/1.1\r\n" + common + "\r\n");
+        return requests;
+    }
+
+    std::vector<fs::path> paths;
+    if (!fs::is_directory(options.images_dir)) {
+        return requests;
+    }
+    for (const auto& entry : fs::directory_iterator(options.images_dir)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    const std::string boundary = "----BoneAgeBenchBoundary7MA4YWxkTrZu0gW";
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string body = "--" + boundary + "\r\n"
+                           "Content-Disposition: form-data; name=\"image\"; filename=\"" + path.filename().string() + "\"\r\n"
+                           "Content-Type: application/octet-stream\r\n\r\n" +
+                           image + "\r\n--" + boundary + "--\r\n";
+        requests.push_back("POST " + options.path + " HTTP/1.1\r\n" + common +
+                           "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+    }
+    return requests;
+}
+
+bool StartsWithNoCase(std::string_view str, std::string_view prefix) {
+    return str.size() >= prefix.size() &&
+           std::equal(prefix.begin(), prefix.end(), str.begin(),
+                      [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+}
+
+bool ContainsNoCase(std::string_view str, std::string_view token) {
+    for (size_t i = 0; i + token.size() <= str.size(); i++) {
+        if (StartsWithNoCase(str.substr(i), token)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 增量解析 HTTP/1.1 响应, 支持 Content-Length 和 chunked, 边解析边丢弃 body
+class ResponseParser {
+public:
+    enum class Result { kNeedMore, kComplete, kError };
+
+    Result Parse(net::Buffer& buf) {
+        while (true) {
+            std::string_view data(buf.Peek(), buf.ReadableBytes());
+            switch (state_) {
+            case State::kHeaders: {
+                size_t end = data.find("\r\n\r\n");
+                if (end == std::string_view::npos) {
+                    return Result::kNeedMore;
+                }
+                if (!ParseHeaders_(data.substr(0, end + 2))) {
+                    return Result::kError;
+                }
+                buf.Retrieve(end + 4);
+                if (chunked_) {
+                    state_ = State::kChunkSize;
+                } else if (remaining_ > 0) {
+                    state_ = State::kBody;
+                } else {
+                    return Result::kComplete;
+                }
+                break;
+            }
+            case State::kBody:
+            case State::kChunkData: {
+                size_t n = std::min(remaining_, data.size());
+                buf.Retrieve(n);
+                remaining_ -= n;
+                if (remaining_ > 0) {
+                    return Result::kNeedMore;
+                }
+                if (state_ == State::kBody) {
+                    state_ = State::kHeaders;
+                    return Result::kComplete;
+                }
+                state_ = State::kChunkSize;
+                break;
+            }
+            case State::kChunkSize: {
+                size_t end = data.find("\r\n");
+                if (end == std::string_view::npos) {
+                    return Result::kNeedMore;
+                }
+                std::string line(data.substr(0, end));
+                char* parse_end = nullptr;
+                unsigned long long size = std::strtoull(line.c_str(), &parse_end, 16);
+                if (parse_end == line.c_str()) {
+                    return Result::kError;
+                }
+                buf.Retrieve(end + 2);
+                if (size == 0) {
+                    state_ = State::kTrailer;
+                } else {
+                    remaining_ = size + 2; // 带上 chunk 末尾的 CRLF
+                    state_ = State::kChunkData;
+                }
+                break;
+            }
+            case State::kTrailer: {
+                size_t end = data.find("\r\n");
+                if (end == std::string_view::npos) {
+                    return Result::kNeedMore;
+                }
+                buf.Retrieve(end + 2);
+                if (end == 0) {
+                    state_ = State::kHeaders;
+                    return Result::kComplete;
+                }
+                break;
+            }
+            }
+        }
+    }
+
+    int GetStatus() const { return status_; }
+    bool KeepAlive() const { return keep_alive_; }
+
+private:
+    enum class State { kHeaders, kBody, kChunkSize, kChunkData, kTrailer };
+
+    // head 包含状态行和所有头部, 每行以 CRLF 结尾
+    bool ParseHeaders_(std::string_view head) {
+        size_t line_end = head.find("\r\n");
+        std::string_view status_line = head.substr(0, line_end);
+        size_t space = status_line.find(' ');
+        if (!StartsWithNoCase(status_line, "HTTP/") || space == std::string_view::npos) {
+            return false;
+        }
+        status_ = std::atoi(std::string(status_line.substr(space + 1, 3)).c_str());
+        keep_alive_ = status_line.substr(0, space) != "HTTP/1.0";
+        chunked_ = false;
+        remaining_ = 0;
+
+        size_t pos = line_end + 2;
+        while (pos < head.size()) {
+            line_end = head.find("\r\n", pos);
+            std::string_view line = head.substr(pos, line_end - pos);
+            pos = line_end + 2;
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            std::string_view name = line.substr(0, colon);
+            std::string_view value = line.substr(colon + 1);
+            if (StartsWithNoCase(name, "content-length") && name.size() == 14) {
+                remaining_ = std::strtoull(std::string(value).c_str(), nullptr, 10);
+            } else if (StartsWithNoCase(name, "transfer-encoding") && name.size() == 17) {
+                chunked_ = ContainsNoCase(value, "chunked");
+            } else if (StartsWithNoCase(name, "connection") && name.size() == 10) {
+                keep_alive_ = !ContainsNoCase(value, "close");
+            }
+        }
+        return true;
+    }
+
+    State state_{State::kHeaders};
+    size_t remaining_{0};
+    bool chunked_{false};
+    bool keep_alive_{true};
+    int status_{0};
+};
+
+// 所有 IO 线程共用的计数, 只统计计划时刻落在测量窗口里的请求, 连接错误全部统计
+struct Stats {
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> non_2xx{0};
+    std::atomic<uint64_t> errors{0};      // 连接失败、解析失败、连接断开时在途的请求
+    std::atomic<uint64_t> unfinished{0};  // 结束时仍在排队或在途的请求
+    std::atomic<uint64_t> connects{0};
+};
+
+// 一个 IO 线程上的一组连接, 除了 GetOutstanding 以外的方法都只在 loop 线程调用
+class Worker {
+public:
+    struct Schedule {
+        Clock::time_point start;          // 开始发送
+        Clock::time_point measure_start;  // 预热结束
+        Clock::time_point end;            // 停止产生新请求
+    };
+
+    Worker(net::EventLoop* loop, const Options& options, const std::vector<std::string>& requests,
+           size_t first_connection, size_t connections, const Schedule& schedule,
+           metrics::Histogram& latency, Stats& stats)
+        : loop_(loop),
+          options_(options),
+          requests_(requests),
+          schedule_(schedule),
+          latency_(latency),
+          stats_(stats),
+          server_addr_(options.host, options.port),
+          open_loop_(options.mode == "open"),
+          pipeline_(options.keep_alive ? std::max<size_t>(options.pipeline, 1) : 1),
+          slots_(connections),
+          next_request_(first_connection) {
+        // open 模式下每个连接的到达间隔相同, 各连接的起点错开, 避免所有连接同时发
+        auto interval = std::chrono::duration<double>(options.connections / options.rate);
+        interval_ = std::chrono::duration_cast<Clock::duration>(interval);
+        for (size_t i = 0; i < slots_.size(); i++) {
+            auto offset = interval_ * static_cast<Clock::rep>(first_connection + i) / static_cast<Clock::rep>(options.connections);
+            slots_[i].next_arrival = schedule_.start + offset;
+        }
+    }
+
+    void Start() {
+        loop_->AssertInLoopThread();
+        timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        itimerspec spec{};
+        spec.it_value.tv_nsec = kTickNs;
+        spec.it_interval.tv_nsec = kTickNs;
+        ::timerfd_settime(timer_fd_, 0, &spec, nullptr);
+        timer_channel_ = std::make_unique<net::Channel>(loop_, timer_fd_);
+        timer_channel_->SetReadCallback([this]() { OnTick_(); });
+        timer_channel_->EnableReading();
+
+        for (size_t i = 0; i < slots_.size(); i++) {
+            Connect_(i);
+        }
+    }
+
+    // 关掉所有连接和定时器, 没完成的请求记为 unfinished
+    void Close() {
+        loop_->AssertInLoopThread();
+        closing_ = true;
+        if (timer_channel_) {
+            timer_channel_->DisableAll();
+            timer_channel_.reset();
+            ::close(timer_fd_);
+        }
+        for (auto& slot : slots_) {
+            stats_.unfinished.fetch_add(slot.in_flight.size() + slot.backlog.size(), std::memory_order_relaxed);
+            if (slot.conn) {
+                slot.conn->ConnectDestroyed();
+                slot.conn.reset();
+            }
+        }
+    }
+
+    // 排队和在途的请求数, 主线程用来等待收尾
+    int64_t GetOutstanding() const { return outstanding_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        net::TcpConnection::Ptr conn;
+        ResponseParser parser;
+        std::deque<Clock::time_point> in_flight; // 已发出请求的计划时刻, 响应按发送顺序返回
+        std::deque<Clock::time_point> backlog;   // open 模式下已到计划时刻但还没发出的请求
+        Clock::time_point next_arrival;
+    };
+
+    static constexpr long kTickNs = 1000 * 1000; // 1ms
+
+    // 回环地址上 connect 几乎立即完成, 直接阻塞 connect 再转成非阻塞交给 TcpConnection
+    void Connect_(size_t index) {
+        if (closing_) {
+            return;
+        }
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::connect(fd, server_addr_.GetSockAddr(), sizeof(sockaddr_in)) < 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            stats_.errors.fetch_add(1, std::memory_order_relaxed);
+            return; // 下一次 tick 重试
+        }
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        stats_.connects.fetch_add(1, std::memory_order_relaxed);
+
+        auto conn = std::make_shared<net::TcpConnection>(loop_, fd, next_conn_id_++, server_addr_);
+        conn->SetMessageCallback([this, index](const net::TcpConnection::Ptr& conn, net::Buffer& buf) {
+            OnMessage_(index, conn, buf);
+        });
+        conn->SetCloseCallback([this, index](const net::TcpConnection::Ptr& conn) {
+            OnClose_(index, conn);
+        });
+        Slot& slot = slots_[index];
+        slot.conn = conn;
+        slot.parser = ResponseParser();
+        conn->ConnectEstablished();
+        FillPipeline_(slot);
+    }
+
+    void OnTick_() {
+        uint64_t expirations = 0;
+        ssize_t n = ::read(timer_fd_, &expirations, sizeof(expirations));
+        (void)n;
+        const auto now = Clock::now();
+        for (size_t i = 0; i < slots_.size(); i++) {
+            Slot& slot = slots_[i];
+            if (open_loop_) {
+                while (slot.next_arrival <= now && slot.next_arrival < schedule_.end) {
+                    slot.backlog.push_back(slot.next_arrival);
+                    slot.next_arrival += interval_;
+                    outstanding_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (!slot.conn && (open_loop_ ? !slot.backlog.empty() : now < schedule_.end)) {
+                Connect_(i);
+            } else if (slot.conn) {
+                FillPipeline_(slot);
+            }
+        }
+    }
+
+    // 把在途请求补到 pipeline_ 个, 多个请求拼在一次 Send 里
+    void FillPipeline_(Slot& slot) {
+        if (!slot.conn || !slot.conn->IsConnected()) {
+            return;
+        }
+        const auto now = Clock::now();
+        net::Buffer out(0);
+        while (slot.in_flight.size() < pipeline_) {
+            Clock::time_point intended;
+            if (open_loop_) {
+                if (slot.backlog.empty()) {
+                    break;
+                }
+                intended = slot.backlog.front();
+                slot.backlog.pop_front();
+            } else {
+                if (now >= schedule_.end) {
+                    break;
+                }
+                intended = now;
+                outstanding_.fetch_add(1, std::memory_order_relaxed);
+            }
+            out.Append(requests_[next_request_++ % requests_.size()]);
+            slot.in_flight.push_back(intended);
+        }
+        if (out.ReadableBytes() > 0) {
+            slot.conn->Send(out);
+        }
+    }
+
+    void OnMessage_(size_t index, const net::TcpConnection::Ptr& conn, net::Buffer& buf) {
+        Slot& slot = slots_[index];
+        if (slot.conn != conn) {
+            buf.RetrieveAll();
+            return;
+        }
+        while (buf.ReadableBytes() > 0) {
+            auto result = slot.parser.Parse(buf);
+            if (result == ResponseParser::Result::kNeedMore) {
+                break;
+            }
+            if (result == ResponseParser::Result::kError || slot.in_flight.empty()) {
+                buf.RetrieveAll();
+                conn->Shutdown(); // 对端关闭后在 OnClose_ 里统计错误并重连
+                return;
+            }
+            const auto now = Clock::now();
+            Clock::time_point intended = slot.in_flight.front();
+            slot.in_flight.pop_front();
+            outstanding_.fetch_sub(1, std::memory_order_relaxed);
+            if (intended >= schedule_.measure_start) {
+                RecordLatency_(std::chrono::duration_cast<std::chrono::nanoseconds>(now - intended).count());
+                stats_.completed.fetch_add(1, std::memory_order_relaxed);
+                int status = slot.parser.GetStatus();
+                if (status < 200 || status >= 300) {
+                    stats_.non_2xx.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (!options_.keep_alive || !slot.parser.KeepAlive()) {
+                // 服务端会关闭连接, 剩下的在途请求在 OnClose_ 里算错误
+                return;
+            }
+        }
+        FillPipeline_(slot);
+    }
+
+    void OnClose_(size_t index, const net::TcpConnection::Ptr& conn) {
+        loop_->QueueInLoop([conn]() { conn->ConnectDestroyed(); });
+        Slot& slot = slots_[index];
+        if (slot.conn != conn) {
+            return;
+        }
+        stats_.errors.fetch_add(slot.in_flight.size(), std::memory_order_relaxed);
+        outstanding_.fetch_sub(slot.in_flight.size(), std::memory_order_relaxed);
+        slot.in_flight.clear();
+        slot.conn.reset();
+        // 短连接模式下每个请求结束都会走到这里, 立即重连
+        if (!options_.keep_alive) {
+            if (open_loop_ ? !slot.backlog.empty() : Clock::now() < schedule_.end) {
+                Connect_(index);
+            }
+        }
+    }
+
+    // closed 模式下一个慢请求会让这个连接少发很多请求, 按 HdrHistogram recordValueWithExpectedInterval
+    // 的做法补记这些被挡住的请求本应看到的延迟
+    void RecordLatency_(uint64_t latency_ns) {
+        latency_.Record(latency_ns);
+        const uint64_t interval_ns = open_loop_ ? 0 : options_.expected_interval_us * 1000;
+        if (interval_ns == 0) {
+            return;
+        }
+        for (uint64_t missing = latency_ns; missing > interval_ns; ) {
+            missing -= interval_ns;
+            if (missing < interval_ns) {
+                break;
+            }
+            latency_.Record(missing);
+        }
+    }
+
+private:
+    net::EventLoop* loop_;
+    const Options& options_;
+    const std::vector<std::string>& requests_;
+    const Schedule schedule_;
+    metrics::Histogram& latency_;
+    Stats& stats_;
+
+    net::InetAddress server_addr_;
+    const bool open_loop_;
+    const size_t pipeline_;
+    Clock::duration interval_;
+
+    std::vector<Slot> slots_;
+    size_t next_request_;
+    uint64_t next_conn_id_{1};
+    bool closing_{false};
+
+    int timer_fd_{-1};
+    std::unique_ptr<net::Channel> timer_channel_;
+
+    std::atomic<int64_t> outstanding_{0};
+};
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"bone age HTTP load generator"};
+    Options options;
+    app.add_option("--host", options.host, "Server IPv4 address");
+    app.add_option("--port", options.port, "Server port");
+    app.add_option("--method", options.method, "GET, or POST with one image per multipart request")
+        ->check(CLI::IsMember({"GET", "POST"}));
+    app.add_option("--path", options.path, "Request path");
+    app.add_option("--images", options.images_dir, "Folder of images uploaded by POST requests");
+    app.add_option("--mode", options.mode, "closed (fixed in-flight requests) or open (constant arrival rate)")
+        ->check(CLI::IsMember({"closed", "open"}));
+    app.add_option("--connections", options.connections, "Number of TCP connections");
+    app.add_option("--threads", options.threads, "Number of IO threads");
+    app.add_option("--pipeline", options.pipeline, "Requests in flight per connection (HTTP pipelining)");
+    app.add_option("--keep-alive", options.keep_alive, "Reuse connections; false sends Connection: close");
+    app.add_option("--rate", options.rate, "Total arrival rate in open mode (requests/s)");
+    app.add_option("--duration", options.duration_s, "Measured seconds");
+    app.add_option("--warmup", options.warmup_s, "Seconds before measuring");
+    app.add_option("--drain-timeout", options.drain_timeout_s, "Seconds to wait for outstanding requests after the run");
+    app.add_option("--expected-interval-us", options.expected_interval_us,
+                   "Closed mode: expected interval between requests on a connection, used to correct coordinated omission");
+    app.add_option("--prom-out", options.prom_out, "Write the latency histogram in Prometheus text format to this file");
+    CLI11_PARSE(app, argc, argv);
+
+    if (options.connections == 0 || options.threads <= 0 || options.rate <= 0) {
+        std::fprintf(stderr, "connections, threads and rate must be positive\n");
+        return 1;
+    }
+
+    logging::InitConsole(logging::LogLevel::Warn);
+
+    auto requests = BuildRequests(options);
+    if (requests.empty()) {
+        std::fprintf(stderr, "no images in %s\n", options.images_dir.c_str());
+        return 1;
+    }
+
+    auto& latency = METRICS.GetHistogram("bench_http_request_duration_seconds",
+                                         "Client-side request latency measured from the intended send time.",
+                                         {{"method", options.method}, {"path", options.path}, {"mode", options.mode}});
+    Stats stats;
+
+    net::EventLoopThreadPool pool(options.threads);
+    pool.Start();
+    const auto& loops = pool.GetLoops();
+
+    Worker::Schedule schedule;
+    schedule.start = Clock::now();
+    schedule.measure_start = schedule.start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup_s));
+    schedule.end = schedule.measure_start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration_s));
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t first_connection = 0;
+    for (size_t i = 0; i < loops.size(); i++) {
+        size_t count = options.connections / loops.size() + (i < options.connections % loops.size() ? 1 : 0);
+        workers.push_back(std::make_unique<Worker>(loops[i], options, requests, first_connection, count, schedule, latency, stats));
+        first_connection += count;
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        loops[i]->RunInLoop([worker = workers[i].get()]() { worker->Start(); });
+    }
+
+    std::this_thread::sleep_until(schedule.end);
+    auto drain_deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.drain_timeout_s));
+    while (Clock::now() < drain_deadline) {
+        int64_t outstanding = 0;
+        for (const auto& worker : workers) {
+            outstanding += worker->GetOutstanding();
+        }
+        if (outstanding <= 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::promise<void> closed;
+        loops[i]->RunInLoop([&closed, worker = workers[i].get()]() {
+            worker->Close();
+            closed.set_value();
+        });
+        closed.get_future().wait();
+    }
+
+    auto snapshot = latency.GetSnapshot();
+    auto ms = [&snapshot](double q) { return snapshot.ValueAtQuantile(q) / 1e6; };
+    uint64_t completed = stats.completed.load();
+    std::printf("{\"mode\": \"%s\", \"method\": \"%s\", \"path\": \"%s\", \"connections\": %zu, \"threads\": %d, "
+                "\"pipeline\": %zu, \"keep_alive\": %s, \"target_rate\": %.1f, \"duration_s\": %.1f, "
+                "\"completed\": %llu, \"non_2xx\": %llu, \"errors\": %llu, \"unfinished\": %llu, \"connects\": %llu, "
+                "\"throughput_rps\": %.1f, \"latency_ms\": {\"mean\": %.3f, \"p50\": %.3f, \"p75\": %.3f, \"p90\": %.3f, "
+                "\"p99\": %.3f, \"p999\": %.3f, \"p9999\": %.3f, \"max\": %.3f}, \"samples\": %llu}\n",
+                options.mode.c_str(), options.method.c_str(), options.path.c_str(), options.connections, options.threads,
+                options.pipeline, options.keep_alive ? "true" : "false", options.mode == "open" ? options.rate : 0.0,
+                options.duration_s, static_cast<unsigned long long>(completed),
+                static_cast<unsigned long long>(stats.non_2xx.load()), static_cast<unsigned long long>(stats.errors.load()),
+                static_cast<unsigned long long>(stats.unfinished.load()), static_cast<unsigned long long>(stats.connects.load()),
+                completed / options.duration_s, snapshot.count > 0 ? snapshot.sum / 1e6 / snapshot.count : 0.0,
+                ms(0.5), ms(0.75), ms(0.9), ms(0.99), ms(0.999), ms(0.9999), snapshot.max / 1e6,
+                static_cast<unsigned long long>(snapshot.count));
+    std::fflush(stdout);
+
+    if (!options.prom_out.empty()) {
+        std::ofstream out(options.prom_out);
+        out << METRICS.Render();
+    }
+    return 0;
+}
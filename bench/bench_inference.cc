@@ -0,0 +1,284 @@
+// 推理吞吐和延迟测试: 把一个文件夹里的图片 (默认 tests/images/hand) 反复送进 BoneAgeInferencer
+// closed 模式: 固定 concurrency 个请求在途, 一个完成马上补一个, 测最大吞吐
+// open 模式: 按 --rate 的泊松到达提交, 延迟从计划提交时刻算起, 不会因为系统变慢而少算排队时间
+// 输出一行 JSON: 吞吐, 端到端延迟分位, 各阶段 (boneage_stage_duration_seconds) 的分位和峰值 RSS
+#include "inference/boneage_inference.h"
+#include "logging/logger.h"
+#include "metrics/stages.h"
+#include "CLI/CLI.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+using inference::BoneAgeInferencer;
+
+namespace {
+
+const char* const kStages[] = {
+    "queue", "batch", "decode",
+    "detect_preprocess", "detect_run", "detect_postprocess", "extract",
+    "classify_preprocess", "classify_run", "classify_postprocess", "serialize",
+};
+
+std::vector<std::vector<unsigned char>> ReadImages(const fs::path& folder) {
+    std::vector<fs::path> paths;
+    if (!fs::is_directory(folder)) {
+        return {};
+    }
+    for (const auto& entry : fs::directory_iterator(folder)) {
+        auto ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (entry.is_regular_file() && (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp")) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end()); // 每次运行顺序相同
+    std::vector<std::vector<unsigned char>> images;
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        images.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    return images;
+}
+
+// 收集完成的请求, 主线程等待全部完成
+class Collector {
+public:
+    explicit Collector(size_t expected) : expected_(expected) { latencies_ns_.reserve(expected); }
+
+    void Add(uint64_t latency_ns, bool ok) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latencies_ns_.push_back(latency_ns);
+        failed_ += ok ? 0 : 1;
+        if (latencies_ns_.size() == expected_) {
+            done_cv_.notify_all();
+        }
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this]() { return latencies_ns_.size() >= expected_; });
+    }
+
+    std::vector<uint64_t> Sorted() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto sorted = latencies_ns_;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+
+    size_t Failed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable done_cv_;
+    size_t expected_;
+    size_t failed_{0};
+    std::vector<uint64_t> latencies_ns_;
+};
+
+// closed 模式一轮测试的状态, 每个回调都持有一份 shared_ptr
+// 最后一个请求的回调可能在 Wait 返回之后才结束, 状态不能放在 run_closed 的栈上
+struct ClosedRun {
+    ClosedRun(const std::vector<std::vector<unsigned char>>& images, size_t total)
+        : images(images), total(total), collector(total) {}
+
+    const std::vector<std::vector<unsigned char>>& images; // main 里的图片, 比所有请求活得久
+    const size_t total;
+    std::atomic<size_t> next{0};
+    Collector collector;
+};
+
+// 提交第 index 个请求, 完成后补一个, 直到提交够 total 个
+// 回调先占好下一个序号再 Add: 能占到序号说明还有请求没完成, Wait 不会返回;
+// 占不到时 Add 之后什么都不做
+void SubmitClosed(const std::shared_ptr<ClosedRun>& run, size_t index) {
+    BoneAgeInferencer::InferenceTask task;
+    task.raw_image_data = run->images[index % run->images.size()];
+    auto start = Clock::now();
+    task.on_complete = [run, start](BoneAgeInferencer::InferenceResult result) {
+        size_t next = run->next.fetch_add(1);
+        run->collector.Add((Clock::now() - start).count(), result.status == BoneAgeInferencer::Status::kOk);
+        if (next < run->total) {
+            SubmitClosed(run, next);
+        }
+    };
+    INFERENCER.PostInference(std::move(task));
+}
+
+double Percentile(const std::vector<uint64_t>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()));
+    return sorted[index] / 1e6;
+}
+
+long PeakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// 两次快照之差, 只统计测量阶段的样本
+metrics::Histogram::Snapshot Subtract(const metrics::Histogram::Snapshot& after, const metrics::Histogram::Snapshot& before) {
+    metrics::Histogram::Snapshot diff = after;
+    for (size_t i = 0; i < diff.counts.size(); i++) {
+        diff.counts[i] -= before.counts[i];
+    }
+    diff.count -= before.count;
+    diff.sum -= before.sum;
+    return diff;
+}
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"bone age inference benchmark"};
+
+    std::string images_dir = (fs::path(__FILE__).parent_path() / ".." / "tests" / "images" / "hand").lexically_normal().string();
+    std::string yolo_model = "models/yolo11m_detect.onnx";
+    std::string cls_model = "models/bone_maturity_predict.onnx";
+    std::string mode = "closed";
+    size_t concurrency = 4;
+    double rate = 2.0;
+    size_t requests = 200;
+    size_t warmup = 20;
+    size_t threads = 2;
+    size_t batch_size = 1;
+    std::string decode = "full";
+    bool use_gpu = false;
+    std::string detect_precision = "fp32";
+    std::string classify_precision = "fp32";
+
+    app.add_option("--images", images_dir, "Folder of images to replay");
+    app.add_option("--yolo-model", yolo_model, "Detection model");
+    app.add_option("--cls-model", cls_model, "Classification model");
+    app.add_option("--mode", mode, "closed (fixed concurrency) or open (Poisson arrivals)")
+        ->check(CLI::IsMember({"closed", "open"}));
+    app.add_option("--concurrency", concurrency, "Requests in flight in closed mode");
+    app.add_option("--rate", rate, "Arrival rate in open mode (requests/s)");
+    app.add_option("--requests", requests, "Measured requests");
+    app.add_option("--warmup", warmup, "Requests run before measuring (closed loop)");
+    app.add_option("--threads", threads, "Inference scheduler threads");
+    app.add_option("--batch-size", batch_size, "Max images per model batch");
+    app.add_option("--decode", decode, "full, reduced2 or reduced4")
+        ->check(CLI::IsMember({"full", "reduced2", "reduced4"}));
+    app.add_option("--use-gpu", use_gpu, "Use CUDA when available (default CPU only)");
+    app.add_option("--detect-precision", detect_precision, "fp32, or int8 to load <yolo-model>_int8.onnx")
+        ->check(CLI::IsMember({"fp32", "int8"}));
+    app.add_option("--classify-precision", classify_precision, "fp32, or int8 to load <cls-model>_int8.onnx")
+        ->check(CLI::IsMember({"fp32", "int8"}));
+    CLI11_PARSE(app, argc, argv);
+
+    logging::InitConsole(logging::LogLevel::Warn);
+
+    auto images = ReadImages(images_dir);
+    if (images.empty()) {
+        std::fprintf(stderr, "no images in %s\n", images_dir.c_str());
+        return 1;
+    }
+
+    std::map<std::string, BoneAgeInferencer::DecodeMode> decode_modes{
+        {"full", BoneAgeInferencer::DecodeMode::kFull},
+        {"reduced2", BoneAgeInferencer::DecodeMode::kReduced2},
+        {"reduced4", BoneAgeInferencer::DecodeMode::kReduced4},
+    };
+    std::map<std::string, nn::Precision> precisions{
+        {"fp32", nn::Precision::kFp32},
+        {"int8", nn::Precision::kInt8},
+    };
+    INFERENCER.SetDecodeMode(decode_modes.at(decode));
+    INFERENCER.Init(threads, yolo_model, cls_model, batch_size, use_gpu,
+                    precisions.at(detect_precision), precisions.at(classify_precision));
+
+    // closed 模式下每个完成的请求立即补一个, 直到提交够 total 个
+    auto run_closed = [&](size_t total) {
+        auto run = std::make_shared<ClosedRun>(images, total);
+        for (size_t i = 0; i < std::min(concurrency, total); i++) {
+            SubmitClosed(run, run->next.fetch_add(1));
+        }
+        run->collector.Wait();
+        return run;
+    };
+
+    if (warmup > 0) {
+        run_closed(warmup);
+    }
+
+    std::vector<metrics::Histogram::Snapshot> stage_before;
+    for (const char* stage : kStages) {
+        stage_before.push_back(metrics::InferenceStage(stage).GetSnapshot());
+    }
+
+    std::shared_ptr<ClosedRun> closed_run;
+    Collector open_collector(requests);
+    Collector* collector = &open_collector;
+    auto bench_start = Clock::now();
+    if (mode == "closed") {
+        closed_run = run_closed(requests);
+        collector = &closed_run->collector;
+    } else {
+        // 提前生成到达时刻, 提交线程按时刻 sleep_until
+        std::mt19937_64 rng(42);
+        std::exponential_distribution<double> gap(rate);
+        auto scheduled = bench_start;
+        for (size_t i = 0; i < requests; i++) {
+            scheduled += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(rng)));
+            std::this_thread::sleep_until(scheduled);
+            BoneAgeInferencer::InferenceTask task;
+            task.raw_image_data = images[i % images.size()];
+            // 回调里 Add 是最后一步, open_collector 一直活到 main 结束
+            task.on_complete = [&open_collector, scheduled](BoneAgeInferencer::InferenceResult result) {
+                open_collector.Add((Clock::now() - scheduled).count(), result.status == BoneAgeInferencer::Status::kOk);
+            };
+            INFERENCER.PostInference(std::move(task));
+        }
+        open_collector.Wait();
+    }
+    double elapsed_s = std::chrono::duration<double>(Clock::now() - bench_start).count();
+
+    std::string stages;
+    for (size_t i = 0; i < std::size(kStages); i++) {
+        auto snapshot = Subtract(metrics::InferenceStage(kStages[i]).GetSnapshot(), stage_before[i]);
+        if (snapshot.count == 0) {
+            continue;
+        }
+        stages += fmt::format("{}\"{}\": {{\"count\": {}, \"mean_ms\": {:.3f}, \"p50_ms\": {:.3f}, \"p99_ms\": {:.3f}}}",
+                              stages.empty() ? "" : ", ", kStages[i], snapshot.count, snapshot.sum / 1e6 / snapshot.count,
+                              snapshot.ValueAtQuantile(0.5) / 1e6, snapshot.ValueAtQuantile(0.99) / 1e6);
+    }
+
+    auto latencies = collector->Sorted();
+    std::printf("%s\n", fmt::format(
+        "{{\"mode\": \"{}\", \"concurrency\": {}, \"rate\": {}, \"requests\": {}, \"images\": {}, \"threads\": {}, "
+        "\"batch_size\": {}, \"decode\": \"{}\", \"gpu\": {}, "
+        "\"precision\": {{\"detect\": \"{}\", \"classify\": \"{}\"}}, \"failed\": {}, \"elapsed_s\": {:.3f}, \"throughput_rps\": {:.2f}, "
+        "\"latency_ms\": {{\"p50\": {:.2f}, \"p90\": {:.2f}, \"p99\": {:.2f}, \"p999\": {:.2f}, \"max\": {:.2f}}}, "
+        "\"stages\": {{{}}}, \"peak_rss_kb\": {}}}",
+        mode, concurrency, rate, requests, images.size(), threads, batch_size, decode, use_gpu, detect_precision, classify_precision, collector->Failed(),
+        elapsed_s, requests / elapsed_s, Percentile(latencies, 0.5), Percentile(latencies, 0.9), Percentile(latencies, 0.99),
+        Percentile(latencies, 0.999), latencies.empty() ? 0.0 : latencies.back() / 1e6, stages, PeakRssKb()).c_str());
+    std::fflush(stdout);
+
+    INFERENCER.Shutdown();
+    return 0;
+}
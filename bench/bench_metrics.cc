@@ -0,0 +1,73 @@
+// 指标记录开销测试: 多个线程同时往同一个直方图里记录, 统计每次 Record 的平均耗时
+// 另外单独测一次 ScopedTimer (两次 steady_clock::now + Record) 的开销
+// 用线程自己的 CPU 时间计算, 线程数超过核数时不把等待调度的时间算进去
+#include "metrics/histogram.h"
+#include "CLI/CLI.hpp"
+#include <cstdio>
+#include <random>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+namespace {
+
+double ThreadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"metrics histogram recording benchmark"};
+    int threads = 4;
+    int samples = 10000000;
+    app.add_option("--threads", threads, "Threads recording into the same histogram");
+    app.add_option("--samples", samples, "Samples recorded by each thread");
+    CLI11_PARSE(app, argc, argv);
+
+    metrics::Histogram histogram;
+    // 预先生成延迟分布的样本, 不把随机数的开销算进去
+    std::vector<uint64_t> values(1 << 16);
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> latency(13.0, 1.5);
+    for (auto& v : values) {
+        v = static_cast<uint64_t>(latency(rng));
+    }
+
+    std::vector<double> record_ns(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            histogram.Record(0); // 分配本线程的分片
+            double start = ThreadCpuNs();
+            for (int i = 0; i < samples; i++) {
+                histogram.Record(values[(i + t) & (values.size() - 1)]);
+            }
+            record_ns[t] = (ThreadCpuNs() - start) / samples;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double worst_record_ns = 0;
+    for (double ns : record_ns) {
+        worst_record_ns = std::max(worst_record_ns, ns);
+    }
+
+    metrics::Histogram timer_histogram;
+    const int timer_samples = samples / 10;
+    double start = ThreadCpuNs();
+    for (int i = 0; i < timer_samples; i++) {
+        metrics::ScopedTimer timer(timer_histogram);
+    }
+    double timer_ns = (ThreadCpuNs() - start) / timer_samples;
+
+    auto snapshot = histogram.GetSnapshot();
+    std::printf("{\"threads\": %d, \"samples\": %llu, \"record_ns\": %.2f, \"scoped_timer_ns\": %.2f, \"p99_ns\": %llu}\n",
+                threads, static_cast<unsigned long long>(snapshot.count), worst_record_ns, timer_ns,
+                static_cast<unsigned long long>(snapshot.ValueAtQuantile(0.99)));
+    std::fflush(stdout);
+    return 0;
+}
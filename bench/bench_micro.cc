@@ -0,0 +1,253 @@
+// net / http 热路径的 Google Benchmark 微基准
+// 基线在 bench/baselines/bench_micro.json, 改动热路径后重新跑一次再和基线比较:
+//   bench_micro --benchmark_format=json --benchmark_out=new.json
+//   compare.py benchmarks bench/baselines/bench_micro.json new.json   (Google Benchmark 自带的 tools/compare.py)
+// 更新基线时用同样的命令输出到 bench/baselines/bench_micro.json, 并在提交说明里写上机器
+#include "net/buffer.h"
+#include "net/eventloop.h"
+#include "http/httpcontext.h"
+#include "http/httprequest.h"
+#include "http/httpresponse.h"
+#include "http/router.h"
+#include "context/thread_pool.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+const std::string kTypicalRequest =
+    "GET /static/index.html?lang=zh&v=3 HTTP/1.1\r\n"
+    "Host: 127.0.0.1:8080\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Cookie: session=6f1c2a9e8b7d4c3f; theme=light\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+// 和上传一张手骨片的 /predict 请求同样大小的 multipart 请求
+std::string MakeUploadRequest(size_t image_size) {
+    const std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    std::string body = "--" + boundary + "\r\n"
+                       "Content-Disposition: form-data; name=\"image\"; filename=\"hand.jpg\"\r\n"
+                       "Content-Type: image/jpeg\r\n\r\n" +
+                       std::string(image_size, '\x5a') + "\r\n--" + boundary + "--\r\n";
+    return "POST /predict HTTP/1.1\r\n"
+           "Host: 127.0.0.1:8080\r\n"
+           "Content-Type: multipart/form-data; boundary=" + boundary + "\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "Connection: keep-alive\r\n\r\n" + body;
+}
+
+// 后台跑一个 EventLoop, 进程退出时停止
+class LoopThread {
+public:
+    LoopThread() {
+        std::promise<net::EventLoop*> promise;
+        auto future = promise.get_future();
+        thread_ = std::thread([&promise]() {
+            net::EventLoop loop;
+            promise.set_value(&loop);
+            loop.Loop();
+        });
+        loop_ = future.get();
+    }
+
+    ~LoopThread() {
+        loop_->Quit();
+        thread_.join();
+    }
+
+    net::EventLoop* GetLoop() const { return loop_; }
+
+private:
+    std::thread thread_;
+    net::EventLoop* loop_;
+};
+
+}
+
+// 小块追加, 容量足够时只有一次拷贝
+static void BM_BufferAppend(benchmark::State& state) {
+    const std::string chunk(state.range(0), 'x');
+    net::Buffer buffer;
+    for (auto _ : state) {
+        buffer.Append(chunk);
+        if (buffer.ReadableBytes() >= 32 * 1024) {
+            buffer.Retrieve(buffer.ReadableBytes() - 1); // 留一个字节, 不走 RetrieveAll 的收缩, 下次 Append 时挪动
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * chunk.size());
+}
+BENCHMARK(BM_BufferAppend)->Arg(16)->Arg(256)->Arg(4096);
+
+// MakeSpace_ 的两条路径: 前面已读的空间够用时把数据挪到开头, 不够时按 2 倍重新分配
+static void BM_BufferMakeSpaceCompact(benchmark::State& state) {
+    const size_t readable = state.range(0);
+    net::Buffer buffer(16 * 1024);
+    const std::string data(buffer.Capacity(), 'x');
+    for (auto _ : state) {
+        buffer.Append(data.data(), buffer.WriteableBytes());
+        buffer.Retrieve(buffer.ReadableBytes() - readable);
+        buffer.Append(data.data(), 1024); // 尾部没有空间, 触发内部挪动
+        benchmark::DoNotOptimize(buffer.Peek());
+        buffer.RetrieveAll();
+    }
+}
+BENCHMARK(BM_BufferMakeSpaceCompact)->Arg(64)->Arg(4096);
+
+static void BM_BufferMakeSpaceGrow(benchmark::State& state) {
+    const std::string data(state.range(0), 'x');
+    for (auto _ : state) {
+        net::Buffer buffer(0);
+        for (size_t written = 0; written < data.size(); written += 4096) {
+            buffer.Append(data.data() + written, std::min<size_t>(4096, data.size() - written));
+        }
+        benchmark::DoNotOptimize(buffer.Peek());
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_BufferMakeSpaceGrow)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+// 每次迭代先往 socketpair 写 n 字节再 ReadFd 读出来, 包含一次 write 和一次 read 系统调用
+static void BM_BufferReadFd(benchmark::State& state) {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        state.SkipWithError("socketpair failed");
+        return;
+    }
+    const std::string data(state.range(0), 'x');
+    net::Buffer buffer;
+    int saved_errno = 0;
+    for (auto _ : state) {
+        if (::write(fds[1], data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+            state.SkipWithError("write failed");
+            break;
+        }
+        size_t total = 0;
+        while (total < data.size()) {
+            ssize_t n = buffer.ReadFd(fds[0], &saved_errno);
+            if (n <= 0) {
+                break;
+            }
+            total += n;
+        }
+        buffer.RetrieveAll();
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+BENCHMARK(BM_BufferReadFd)->Arg(512)->Arg(16 * 1024)->Arg(128 * 1024);
+
+static void BM_HttpRequestParseTypical(benchmark::State& state) {
+    net::Buffer buffer;
+    http::HttpRequest request;
+    for (auto _ : state) {
+        buffer.Append(kTypicalRequest);
+        request.Reset();
+        if (request.Parse(buffer) != http::HttpRequest::HttpCode::kGetRequest) {
+            state.SkipWithError("parse failed");
+            break;
+        }
+        benchmark::DoNotOptimize(request.GetPath().data());
+    }
+    state.SetBytesProcessed(state.iterations() * kTypicalRequest.size());
+}
+BENCHMARK(BM_HttpRequestParseTypical);
+
+// 大请求一次到齐, 主要是 body 的拷贝
+static void BM_HttpRequestParseUpload(benchmark::State& state) {
+    const std::string raw = MakeUploadRequest(state.range(0));
+    net::Buffer buffer;
+    http::HttpRequest request;
+    for (auto _ : state) {
+        buffer.Append(raw);
+        request.Reset();
+        if (request.Parse(buffer) != http::HttpRequest::HttpCode::kGetRequest) {
+            state.SkipWithError("parse failed");
+            break;
+        }
+        benchmark::DoNotOptimize(request.GetBody().data());
+    }
+    state.SetBytesProcessed(state.iterations() * raw.size());
+}
+BENCHMARK(BM_HttpRequestParseUpload)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+// 路由表和服务端规模相当, 命中的路由带一个中间件和一个处理函数, 不发送数据
+static void BM_RouterRoute(benchmark::State& state) {
+    http::Router router;
+    auto pass = [](http::HttpContext&, const net::TcpConnection::Ptr&, const http::Next& next) { next(); };
+    auto handler = [](http::HttpContext& context, const net::TcpConnection::Ptr&, const http::Next&) {
+        context.response.SetStatusCode(200);
+    };
+    for (const char* path : {"/", "/login", "/register", "/logout", "/history", "/metrics", "/admin/trace", "/predict/batch"}) {
+        router.AddRoute("GET", path, {handler});
+    }
+    router.AddRoute("POST", "/predict", {pass, handler});
+
+    const std::string raw = "POST /predict HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: 0\r\n\r\n";
+    net::Buffer buffer;
+    buffer.Append(raw);
+    http::HttpContext context;
+    context.request.Parse(buffer);
+    net::TcpConnection::Ptr conn;
+    for (auto _ : state) {
+        router.Route(context, conn);
+    }
+}
+BENCHMARK(BM_RouterRoute);
+
+static void BM_HttpResponseAppendToBuffer(benchmark::State& state) {
+    const std::string body(state.range(0), 'x');
+    net::Buffer buffer;
+    http::HttpResponse response;
+    for (auto _ : state) {
+        response.Reset();
+        response.SetStatusCode(200);
+        response.SetKeepAlive(true);
+        response.SetContentType("application/json");
+        response.SetBody(body);
+        response.AppendToBuffer(buffer);
+        benchmark::DoNotOptimize(buffer.Peek());
+        buffer.RetrieveAll(); // 超过 kMaxIdleSize 时会释放内存, 和服务端发送大响应后的行为一致
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_HttpResponseAppendToBuffer)->Arg(256)->Arg(64 * 1024);
+
+// 多个线程同时向同一个 loop 投递, 每个线程在计时结束前等自己投递的任务全部执行完
+static void BM_EventLoopQueueInLoop(benchmark::State& state) {
+    static LoopThread loop_thread;
+    net::EventLoop* loop = loop_thread.GetLoop();
+    std::atomic<int64_t> executed{0};
+    int64_t posted = 0;
+    for (auto _ : state) {
+        loop->QueueInLoop([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+        posted++;
+    }
+    while (executed.load(std::memory_order_acquire) < posted) {
+        std::this_thread::yield();
+    }
+    state.SetItemsProcessed(posted);
+}
+BENCHMARK(BM_EventLoopQueueInLoop)->Threads(1)->Threads(4)->UseRealTime();
+
+// 外部线程提交一个任务并等它的结果, 包含唤醒休眠的工作线程
+static void BM_ThreadPoolRoundTrip(benchmark::State& state) {
+    ctx::ThreadPool pool(state.range(0));
+    for (auto _ : state) {
+        auto future = pool.RunRetTask([]() { return 1; });
+        benchmark::DoNotOptimize(future.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ThreadPoolRoundTrip)->Arg(1)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
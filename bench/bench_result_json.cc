@@ -0,0 +1,167 @@
+// 结果序列化测试: 对比 nlohmann DOM + dump(), ResultWriter 直接写 JSON, 以及 MessagePack / CBOR 的大小和耗时
+// 每轮序列化一个 batch 的结果. 默认用随机生成的结果 (每张图 13 个关节并带 RUS-CHN 骨龄);
+// --results 可以给一份 /predict/batch 在测试集上跑出来的 NDJSON, 按真实结果测
+#include "inference/result_writer.h"
+#include "CLI/CLI.hpp"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace inference {
+
+// 原来 boneage_inference.cc 里的写法
+void to_json(json& j, const BoneDetail& bone) {
+    j = {
+        {"joint", bone.joint},
+        {"box", {{"x", bone.box.x}, {"y", bone.box.y}, {"width", bone.box.width}, {"height", bone.box.height}}},
+        {"category_id", bone.category_id},
+        {"maturity_stage", bone.maturity_stage}
+    };
+}
+
+void to_json(json& j, const RusChnResult& rus_chn) {
+    j = {
+        {"sex", rus_chn.sex == BoneInfo::Sex::kBoy ? "boy" : "girl"},
+        {"total_score", rus_chn.total_score},
+        {"bone_age", rus_chn.bone_age}
+    };
+}
+
+void to_json(json& j, const HandDetail& hand) {
+    j = {
+        {"is_valid", hand.is_valid},
+        {"bones_detail", hand.bones_detail}
+    };
+    if (hand.rus_chn) {
+        j["rus_chn"] = *hand.rus_chn;
+    }
+}
+
+void from_json(const json& j, HandDetail& hand) {
+    hand.is_valid = j.at("is_valid");
+    for (const auto& item : j.at("bones_detail")) {
+        const auto& box = item.at("box");
+        hand.bones_detail.push_back({item.at("joint"),
+                                     cv::Rect(box.at("x"), box.at("y"), box.at("width"), box.at("height")),
+                                     item.at("category_id"), item.at("maturity_stage")});
+    }
+    if (j.contains("rus_chn")) {
+        const auto& rus_chn = j.at("rus_chn");
+        hand.rus_chn = RusChnResult{rus_chn.at("sex") == "boy" ? BoneInfo::Sex::kBoy : BoneInfo::Sex::kGirl,
+                                    rus_chn.at("total_score"), rus_chn.at("bone_age")};
+    }
+}
+
+}
+
+namespace {
+
+std::vector<inference::HandDetail> RandomHands(size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 2000);
+    std::uniform_int_distribution<int> stage(0, 12);
+    std::vector<inference::HandDetail> hands(count);
+    for (auto& hand : hands) {
+        hand.is_valid = true;
+        for (size_t j = 0; j < BoneInfo::kKeyJoints.size(); j++) {
+            hand.bones_detail.push_back({std::string(BoneInfo::kKeyJoints[j]),
+                                         cv::Rect(coord(rng), coord(rng), coord(rng) / 10, coord(rng) / 10),
+                                         static_cast<int>(j % 9), stage(rng)});
+        }
+        int total = std::uniform_int_distribution<int>(0, 1000)(rng);
+        hand.rus_chn = inference::RusChnResult{BoneInfo::Sex::kGirl, total, BoneInfo::RusChnBoneAge(BoneInfo::Sex::kGirl, total)};
+    }
+    return hands;
+}
+
+// 每行是 {"index": i, "result": {...}} 或者直接是结果对象, 出错的行跳过
+std::vector<inference::HandDetail> LoadHands(const std::string& path) {
+    std::vector<inference::HandDetail> hands;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        json j = json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.is_object() || j.contains("error")) {
+            continue;
+        }
+        hands.push_back((j.contains("result") ? j["result"] : j).get<inference::HandDetail>());
+    }
+    return hands;
+}
+
+struct Measurement {
+    double per_sec;
+    double bytes_per_result;
+};
+
+// 每个结果都要生成一个独立的 std::string 交给回调, 这次拷贝也算在内
+Measurement Measure(const std::vector<inference::HandDetail>& hands, size_t batch_size, int rounds,
+                    const std::function<std::string(const inference::HandDetail&)>& encode) {
+    size_t bytes = 0;
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < batch_size; i++) {
+            bytes += encode(hands[(static_cast<size_t>(r) * batch_size + i) % hands.size()]).size();
+            count++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return {count / seconds, static_cast<double>(bytes) / count};
+}
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"inference result serialization benchmark"};
+    int batch_size = 16;
+    int rounds = 20000;
+    std::string results_path;
+    app.add_option("--batch-size", batch_size, "Results serialized per round");
+    app.add_option("--rounds", rounds, "Number of batches");
+    app.add_option("--results", results_path, "NDJSON output of /predict/batch on the test set");
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<inference::HandDetail> hands = results_path.empty() ? RandomHands(batch_size) : LoadHands(results_path);
+    if (hands.empty()) {
+        std::fprintf(stderr, "no results loaded from %s\n", results_path.c_str());
+        return 1;
+    }
+
+    inference::ResultWriter json_writer;
+    inference::BinaryResultWriter msgpack_writer(inference::ResultFormat::kMsgPack);
+    inference::BinaryResultWriter cbor_writer(inference::ResultFormat::kCbor);
+    auto write = [](auto& writer) {
+        return [&writer](const inference::HandDetail& hand) {
+            writer.Clear();
+            writer.Write(hand);
+            return writer.ToString();
+        };
+    };
+    Measurement dom = Measure(hands, batch_size, rounds, [](const inference::HandDetail& hand) { return json(hand).dump(); });
+    Measurement fast_json = Measure(hands, batch_size, rounds, write(json_writer));
+    Measurement msgpack = Measure(hands, batch_size, rounds, write(msgpack_writer));
+    Measurement cbor = Measure(hands, batch_size, rounds, write(cbor_writer));
+
+    bool identical = true;
+    for (const auto& hand : hands) {
+        json_writer.Clear();
+        json_writer.Write(hand);
+        identical = identical && json_writer.View() == json(hand).dump();
+    }
+
+    std::printf("{\"results\": %zu, \"batch_size\": %d, \"rounds\": %d, "
+                "\"dom_per_sec\": %.0f, \"json_per_sec\": %.0f, \"msgpack_per_sec\": %.0f, \"cbor_per_sec\": %.0f, "
+                "\"json_bytes\": %.1f, \"msgpack_bytes\": %.1f, \"cbor_bytes\": %.1f, \"json_identical\": %s}\n",
+                hands.size(), batch_size, rounds, dom.per_sec, fast_json.per_sec, msgpack.per_sec, cbor.per_sec,
+                fast_json.bytes_per_result, msgpack.bytes_per_result, cbor.bytes_per_result, identical ? "true" : "false");
+    std::fflush(stdout);
+    return 0;
+}
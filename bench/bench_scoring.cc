@@ -0,0 +1,96 @@
+// RUS-CHN 打分测试: 对比 constexpr 查表 + Horner 和前端那种按关节名查 map + 逐项 pow 的写法
+// 输入是随机的 13 个关节等级, 统计每次打分 (总分 + 骨龄) 的平均耗时
+#include "bone_info.h"
+#include "CLI/CLI.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 模拟 scripts.js::calculateBoneAge 的做法
+struct NaiveScorer {
+    std::map<std::string, std::vector<int>> scores[2];
+
+    NaiveScorer() {
+        for (size_t s = 0; s < 2; s++) {
+            for (size_t j = 0; j < BoneInfo::kKeyJoints.size(); j++) {
+                const auto& row = BoneInfo::kRusChnScores[s][j];
+                scores[s][std::string(BoneInfo::kKeyJoints[j])] = std::vector<int>(row.begin(), row.end());
+            }
+        }
+    }
+
+    double Score(BoneInfo::Sex sex, const std::array<int, 13>& stages) const {
+        const auto& table = scores[static_cast<size_t>(sex)];
+        int total = 0;
+        for (size_t j = 0; j < stages.size(); j++) {
+            if (stages[j] < 0) {
+                continue;
+            }
+            const auto& row = table.at(std::string(BoneInfo::kKeyJoints[j]));
+            if (stages[j] < static_cast<int>(row.size())) {
+                total += row[stages[j]];
+            }
+        }
+        const auto& c = BoneInfo::kRusChnCurves[static_cast<size_t>(sex)];
+        double age = c[0] + c[1] * total;
+        for (int k = 2; k <= 10; k++) {
+            age += std::pow(total, k) * c[k];
+        }
+        return age < 0 ? 0 : age;
+    }
+};
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"rus-chn scoring benchmark"};
+    int samples = 4096;
+    int rounds = 500;
+    app.add_option("--samples", samples, "Distinct random stage combinations");
+    app.add_option("--rounds", rounds, "Passes over all samples");
+    CLI11_PARSE(app, argc, argv);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> stage_dist(-1, 14);
+    std::vector<std::array<int, 13>> inputs(samples);
+    std::vector<BoneInfo::Sex> sexes(samples);
+    for (int i = 0; i < samples; i++) {
+        for (auto& stage : inputs[i]) {
+            stage = stage_dist(rng);
+        }
+        sexes[i] = (rng() & 1) ? BoneInfo::Sex::kGirl : BoneInfo::Sex::kBoy;
+    }
+
+    // 结果累加起来输出, 防止被优化掉
+    auto run = [&](auto&& score) {
+        double checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < samples; i++) {
+                checksum += score(sexes[i], inputs[i]);
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(ns / (static_cast<double>(rounds) * samples), checksum);
+    };
+
+    auto [table_ns, table_sum] = run([](BoneInfo::Sex sex, const std::array<int, 13>& stages) {
+        return BoneInfo::RusChnBoneAge(sex, BoneInfo::RusChnTotalScore(sex, stages));
+    });
+    NaiveScorer naive;
+    auto [naive_ns, naive_sum] = run([&naive](BoneInfo::Sex sex, const std::array<int, 13>& stages) {
+        return naive.Score(sex, stages);
+    });
+
+    std::printf("{\"samples\": %d, \"rounds\": %d, \"table_ns_per_op\": %.2f, \"naive_ns_per_op\": %.2f, "
+                "\"speedup\": %.1f, \"checksum_diff\": %.6g}\n",
+                samples, rounds, table_ns, naive_ns, naive_ns / table_ns, std::fabs(table_sum - naive_sum));
+    std::fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,217 @@
+// 启动时间测试: 每轮起一个子进程, 从 fork 到 BoneAgeInferencer::Init 返回 (可以接请求) 算 time-to-ready,
+// 再送一张手骨片, 记录第一个结果的延迟
+// 依次跑: 不用模型缓存一轮, 空缓存一轮 (生成缓存), 再用缓存跑 --runs 轮; 缓存放在临时目录, 结束后删除
+// 输出一行 JSON: 每轮的 time-to-ready / Init 耗时 / 首个结果延迟, 以及缓存命中时相对不用缓存的加速比
+#include "inference/boneage_inference.h"
+#include "logging/logger.h"
+#include "CLI/CLI.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+using inference::BoneAgeInferencer;
+using json = nlohmann::ordered_json;
+
+namespace {
+
+double MillisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 子进程: Init 完成后输出 "ready <init_ms>", 第一个请求完成后输出 "first <ms> <ok>"
+int RunChild(const std::string& cache_dir, const std::string& yolo_model, const std::string& cls_model, size_t threads,
+             size_t batch_size, bool use_gpu, nn::Precision detect_precision, nn::Precision classify_precision,
+             const std::string& image_path) {
+    logging::InitConsole(logging::LogLevel::Warn);
+
+    auto start = Clock::now();
+    INFERENCER.SetModelCacheDir(cache_dir);
+    INFERENCER.Init(threads, yolo_model, cls_model, batch_size, use_gpu, detect_precision, classify_precision);
+    std::printf("ready %.3f\n", MillisecondsSince(start));
+    std::fflush(stdout);
+
+    std::ifstream file(image_path, std::ios::binary);
+    if (file) {
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool done = false;
+        bool ok = false;
+        BoneAgeInferencer::InferenceTask task;
+        task.raw_image_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        auto submit = Clock::now();
+        double first_ms = 0;
+        task.on_complete = [&](BoneAgeInferencer::InferenceResult result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            first_ms = MillisecondsSince(submit);
+            ok = result.status == BoneAgeInferencer::Status::kOk;
+            done = true;
+            done_cv.notify_one();
+        };
+        INFERENCER.PostInference(std::move(task));
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&done]() { return done; });
+        std::printf("first %.3f %d\n", first_ms, ok ? 1 : 0);
+        std::fflush(stdout);
+    }
+    INFERENCER.Shutdown();
+    return 0;
+}
+
+// 用同样的参数加上 --child 重新执行自己, 按子进程的输出填 run
+bool RunOnce(std::vector<std::string> args, const std::string& label, json& run) {
+    args.push_back("--child");
+    args.push_back(label);
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return false;
+    }
+    auto start = Clock::now();
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        ::dup2(fds[1], STDOUT_FILENO);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        ::execv("/proc/self/exe", argv.data());
+        ::_exit(127);
+    }
+    ::close(fds[1]);
+
+    run["cache"] = label;
+    FILE* out = ::fdopen(fds[0], "r");
+    char line[256];
+    while (std::fgets(line, sizeof(line), out) != nullptr) {
+        double ms = 0;
+        int ok = 0;
+        if (std::sscanf(line, "ready %lf", &ms) == 1) {
+            run["time_to_ready_ms"] = MillisecondsSince(start); // 包括进程启动和动态库加载
+            run["init_ms"] = ms;
+        } else if (std::sscanf(line, "first %lf %d", &ms, &ok) == 2) {
+            run["first_result_ms"] = ms;
+            run["first_result_ok"] = ok == 1;
+        }
+    }
+    std::fclose(out);
+
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 && run.contains("time_to_ready_ms");
+}
+
+double Median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"bone age server startup benchmark"};
+
+    const fs::path images_root = (fs::path(__FILE__).parent_path() / ".." / "tests" / "images").lexically_normal();
+    std::string image_path = (images_root / "hand" / "123.jpg").string();
+    std::string yolo_model = "models/yolo11m_detect.onnx";
+    std::string cls_model = "models/bone_maturity_predict.onnx";
+    size_t threads = 2;
+    size_t batch_size = 1;
+    bool use_gpu = false;
+    std::string detect_precision = "fp32";
+    std::string classify_precision = "fp32";
+    int runs = 3;
+    std::string tmp_dir = fs::temp_directory_path().string();
+    std::string child;
+    std::string child_cache_dir;
+
+    app.add_option("--image", image_path, "Image sent as the first request after startup (skipped if missing)");
+    app.add_option("--yolo-model", yolo_model, "Detection model");
+    app.add_option("--cls-model", cls_model, "Classification model");
+    app.add_option("--threads", threads, "Inference scheduler threads");
+    app.add_option("--batch-size", batch_size, "Max images per model batch (adds warmup shapes)");
+    app.add_option("--use-gpu", use_gpu, "Use CUDA when available (default CPU only)");
+    app.add_option("--detect-precision", detect_precision, "fp32, or int8 to load <yolo-model>_int8.onnx")
+        ->check(CLI::IsMember({"fp32", "int8"}));
+    app.add_option("--classify-precision", classify_precision, "fp32, or int8 to load <cls-model>_int8.onnx")
+        ->check(CLI::IsMember({"fp32", "int8"}));
+    app.add_option("--runs", runs, "Restarts with a warm model cache");
+    app.add_option("--tmp-dir", tmp_dir, "Where the temporary model cache is created");
+    // 子进程用的参数
+    app.add_option("--child", child)->group("");
+    app.add_option("--child-cache-dir", child_cache_dir)->group("");
+    CLI11_PARSE(app, argc, argv);
+
+    std::map<std::string, nn::Precision> precisions{
+        {"fp32", nn::Precision::kFp32},
+        {"int8", nn::Precision::kInt8},
+    };
+    if (!child.empty()) {
+        return RunChild(child == "off" ? "" : child_cache_dir, yolo_model, cls_model, threads, batch_size, use_gpu,
+                        precisions.at(detect_precision), precisions.at(classify_precision), image_path);
+    }
+
+    const fs::path cache_dir = fs::path(tmp_dir) / ("bench_startup-" + std::to_string(::getpid()));
+    std::error_code ec;
+    fs::remove_all(cache_dir, ec);
+
+    std::vector<std::string> args(argv, argv + argc);
+    args.push_back("--child-cache-dir");
+    args.push_back(cache_dir.string());
+
+    json result;
+    result["config"] = {{"yolo_model", yolo_model}, {"cls_model", cls_model}, {"threads", threads}, {"batch_size", batch_size},
+                        {"gpu", use_gpu}, {"detect_precision", detect_precision}, {"classify_precision", classify_precision}};
+    result["runs"] = json::array();
+
+    // off: 不用缓存; miss: 空缓存, 这一轮写缓存; hit: 命中缓存
+    std::vector<std::string> labels{"off", "miss"};
+    for (int i = 0; i < std::max(runs, 1); i++) {
+        labels.push_back("hit");
+    }
+    std::map<std::string, std::vector<double>> ready_ms;
+    bool failed = false;
+    for (const auto& label : labels) {
+        json run;
+        if (!RunOnce(args, label, run)) {
+            std::fprintf(stderr, "%s run failed\n", label.c_str());
+            failed = true;
+            break;
+        }
+        ready_ms[label].push_back(run["time_to_ready_ms"].get<double>());
+        result["runs"].push_back(run);
+    }
+    fs::remove_all(cache_dir, ec);
+    if (failed) {
+        return 1;
+    }
+
+    double off = Median(ready_ms["off"]);
+    double hit = Median(ready_ms["hit"]);
+    result["time_to_ready_ms"] = {{"off", off}, {"miss", Median(ready_ms["miss"])}, {"hit", hit}};
+    result["cache_speedup"] = hit > 0 ? off / hit : 0.0;
+    std::printf("%s\n", result.dump().c_str());
+    return 0;
+}
@@ -0,0 +1,112 @@
+// strand 测试: 创建大量 strand, 多个线程轮流向它们投递任务
+// shared 模式使用 Executor 的 strand (共享线程池), dedicated 模式每个 strand 一个 ThreadPool(1), 即原来的实现
+#include "context/executor.h"
+#include "context/thread_pool.h"
+#include "CLI/CLI.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 从 /proc/self/status 读取一个字段, 比如 Threads 和 VmRSS
+long ReadProcStatus(const std::string& key) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, key.size(), key) == 0 && line[key.size()] == ':') {
+            return std::stol(line.substr(key.size() + 1));
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"strand benchmark"};
+    int strands = 10000;
+    int producers = 4;
+    int tasks_per_strand = 100;
+    std::string mode = "shared";
+    app.add_option("--strands", strands, "Number of strands");
+    app.add_option("--producers", producers, "Number of posting threads");
+    app.add_option("--tasks", tasks_per_strand, "Tasks posted to each strand");
+    app.add_option("--mode", mode, "shared (strands on one pool) or dedicated (one thread per strand)")
+        ->check(CLI::IsMember({"shared", "dedicated"}));
+    CLI11_PARSE(app, argc, argv);
+
+    ctx::Executor executor;
+    std::vector<std::unique_ptr<ctx::ThreadPool>> dedicated;
+    std::vector<ctx::TaskRunnerTag> tags;
+    std::function<void(int, ctx::Task)> post;
+
+    auto create_start = std::chrono::steady_clock::now();
+    if (mode == "shared") {
+        for (int i = 0; i < strands; i++) {
+            tags.push_back(executor.AddStrandRunner(1));
+        }
+        post = [&](int index, ctx::Task task) { executor.PostTask(tags[index], std::move(task)); };
+    } else {
+        for (int i = 0; i < strands; i++) {
+            dedicated.emplace_back(std::make_unique<ctx::ThreadPool>(1));
+        }
+        post = [&](int index, ctx::Task task) { dedicated[index]->RunTask(std::move(task)); };
+    }
+    double create_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - create_start).count();
+    long threads = ReadProcStatus("Threads");
+    long rss_kb = ReadProcStatus("VmRSS");
+
+    // 每个 strand 记录上一次执行的序号, 顺便检查顺序
+    std::vector<int> last_seen(strands, -1);
+    std::atomic<bool> out_of_order{false};
+    const uint64_t total = static_cast<uint64_t>(strands) * tasks_per_strand;
+    std::atomic<uint64_t> executed{0};
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads_vec;
+    for (int p = 0; p < producers; p++) {
+        threads_vec.emplace_back([&, p]() {
+            // 每个 strand 只由一个生产者投递, 这样序号是全局有序的
+            for (int seq = 0; seq < tasks_per_strand; seq++) {
+                for (int s = p; s < strands; s += producers) {
+                    post(s, [&, s, seq]() {
+                        if (last_seen[s] != seq - 1) {
+                            out_of_order = true;
+                        }
+                        last_seen[s] = seq;
+                        if (executed.fetch_add(1, std::memory_order_relaxed) + 1 == total) {
+                            std::lock_guard<std::mutex> lock(done_mutex);
+                            done_cv.notify_one();
+                        }
+                    });
+                }
+            }
+        });
+    }
+    for (auto& t : threads_vec) {
+        t.join();
+    }
+    {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait(lock, [&]() { return executed.load() == total; });
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("{\"mode\": \"%s\", \"strands\": %d, \"create_ms\": %.1f, \"threads\": %ld, \"rss_kb\": %ld, "
+                "\"tasks\": %llu, \"seconds\": %.3f, \"tasks_per_sec\": %.0f, \"in_order\": %s}\n",
+                mode.c_str(), strands, create_ms, threads, rss_kb, static_cast<unsigned long long>(total),
+                seconds, total / seconds, out_of_order ? "false" : "true");
+    std::fflush(stdout);
+    return 0;
+}
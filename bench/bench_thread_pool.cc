@@ -0,0 +1,232 @@
+// 线程池吞吐和延迟测试: 对比工作窃取的 ctx::ThreadPool 和原来单队列单锁的实现
+// 场景: tiny (几乎为空的任务), medium (几微秒的计算), nested (任务内部再派生子任务)
+#include "context/thread_pool.h"
+#include "CLI/CLI.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 原来的实现: 一个 std::queue + 一把锁 + 一个条件变量, 每个任务 std::bind 一次
+class LegacyThreadPool {
+public:
+    explicit LegacyThreadPool(uint32_t thread_counts) {
+        for (uint32_t i = 0; i < thread_counts; i++) {
+            workers_.emplace_back([this]() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        cv_.wait(lock, [this]() { return !tasks_.empty() || closed_; });
+                        if (closed_) {
+                            break;
+                        }
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~LegacyThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) {
+            t.join();
+        }
+    }
+
+    template <typename F, typename... Args>
+    void RunTask(F&& f, Args&&... args) {
+        std::function<void()> task = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool closed_{false};
+};
+
+using Clock = std::chrono::steady_clock;
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// 大约 work_ns 纳秒的纯计算
+uint64_t Spin(int64_t work_ns) {
+    uint64_t x = 0;
+    int64_t end = NowNs() + work_ns;
+    while (NowNs() < end) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return x;
+}
+
+struct Result {
+    double seconds;
+    std::vector<int64_t> latencies; // 提交到开始执行的时间
+};
+
+// producers 个外部线程各提交 tasks 个任务
+template <typename Pool>
+Result RunFlat(Pool& pool, int producers, int tasks, int64_t work_ns) {
+    const int total = producers * tasks;
+    Result result;
+    result.latencies.resize(total);
+    std::atomic<int> remaining{total};
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::atomic<uint64_t> sink{0};
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < tasks; i++) {
+                int slot = p * tasks + i;
+                int64_t submit_ns = NowNs();
+                pool.RunTask([&, slot, submit_ns]() {
+                    result.latencies[slot] = NowNs() - submit_ns;
+                    if (work_ns > 0) {
+                        sink.fetch_add(Spin(work_ns), std::memory_order_relaxed);
+                    }
+                    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        std::lock_guard<std::mutex> lock(done_mutex);
+                        done_cv.notify_one();
+                    }
+                });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait(lock, [&]() { return remaining.load() == 0; });
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+// 每个根任务在线程池内部派生 fanout 个子任务, 工作窃取的优势主要体现在这里
+template <typename Pool>
+Result RunNested(Pool& pool, int roots, int fanout, int64_t work_ns) {
+    const int total = roots * fanout;
+    Result result;
+    result.latencies.resize(total);
+    std::atomic<int> remaining{total};
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::atomic<uint64_t> sink{0};
+
+    auto start = Clock::now();
+    for (int r = 0; r < roots; r++) {
+        pool.RunTask([&, r]() {
+            for (int i = 0; i < fanout; i++) {
+                int slot = r * fanout + i;
+                int64_t submit_ns = NowNs();
+                pool.RunTask([&, slot, submit_ns]() {
+                    result.latencies[slot] = NowNs() - submit_ns;
+                    if (work_ns > 0) {
+                        sink.fetch_add(Spin(work_ns), std::memory_order_relaxed);
+                    }
+                    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        std::lock_guard<std::mutex> lock(done_mutex);
+                        done_cv.notify_one();
+                    }
+                });
+            }
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait(lock, [&]() { return remaining.load() == 0; });
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+void Report(const char* pool, const std::string& scenario, int threads, Result& result) {
+    auto& lat = result.latencies;
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&](double p) {
+        return lat.empty() ? 0.0 : lat[std::min(lat.size() - 1, static_cast<size_t>(p * lat.size()))] / 1000.0;
+    };
+    std::printf("{\"pool\": \"%s\", \"scenario\": \"%s\", \"threads\": %d, \"tasks\": %zu, "
+                "\"seconds\": %.3f, \"tasks_per_sec\": %.0f, \"p50_us\": %.1f, \"p99_us\": %.1f, \"p999_us\": %.1f}\n",
+                pool, scenario.c_str(), threads, lat.size(), result.seconds,
+                lat.size() / result.seconds, pct(0.5), pct(0.99), pct(0.999));
+    std::fflush(stdout);
+}
+
+template <typename Pool>
+void RunAll(const char* name, int threads, int producers, int tasks, int64_t medium_ns) {
+    {
+        Pool pool(threads);
+        auto r = RunFlat(pool, producers, tasks, 0);
+        Report(name, "tiny", threads, r);
+    }
+    {
+        Pool pool(threads);
+        auto r = RunFlat(pool, producers, tasks / 10, medium_ns);
+        Report(name, "medium", threads, r);
+    }
+    {
+        Pool pool(threads);
+        auto r = RunNested(pool, threads * 4, tasks / (threads * 4), 0);
+        Report(name, "nested_tiny", threads, r);
+    }
+    {
+        Pool pool(threads);
+        auto r = RunNested(pool, threads * 4, tasks / (threads * 40), medium_ns);
+        Report(name, "nested_medium", threads, r);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CLI::App app{"thread pool throughput / latency benchmark"};
+    int threads = 4;
+    int producers = 2;
+    int tasks = 500000;
+    int64_t medium_ns = 5000;
+    std::string pool = "both";
+    app.add_option("--threads", threads, "Worker threads in the pool");
+    app.add_option("--producers", producers, "External submitting threads");
+    app.add_option("--tasks", tasks, "Tiny tasks per producer (medium runs a tenth of this)");
+    app.add_option("--medium-ns", medium_ns, "Work per medium task in nanoseconds");
+    app.add_option("--pool", pool, "Which pool to run: legacy, stealing or both");
+    CLI11_PARSE(app, argc, argv);
+
+    if (pool == "legacy" || pool == "both") {
+        RunAll<LegacyThreadPool>("legacy", threads, producers, tasks, medium_ns);
+    }
+    if (pool == "stealing" || pool == "both") {
+        RunAll<ctx::ThreadPool>("stealing", threads, producers, tasks, medium_ns);
+    }
+    return 0;
+}
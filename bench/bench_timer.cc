@@ -0,0 +1,79 @@
+// 定时器测试: 模拟请求超时的用法, 多个线程不断添加延时任务, 大部分在到期前取消
+// 统计添加/取消的吞吐, 以及没被取消的任务实际执行时间相对预期的延迟
+#include "context/executor.h"
+#include "CLI/CLI.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    CLI::App app{"executor timer benchmark"};
+    int producers = 4;
+    int timers_per_producer = 200000;
+    int max_delay_ms = 200;
+    double cancel_ratio = 0.9;
+    app.add_option("--producers", producers, "Threads adding timers");
+    app.add_option("--timers", timers_per_producer, "Timers added by each thread");
+    app.add_option("--max-delay-ms", max_delay_ms, "Delays are uniform in [1, max-delay-ms]");
+    app.add_option("--cancel-ratio", cancel_ratio, "Fraction of timers cancelled before they fire");
+    CLI11_PARSE(app, argc, argv);
+
+    ctx::Executor executor;
+    ctx::TaskRunnerTag tag = executor.AddParallelRunner(1, 2);
+
+    std::mutex lateness_mutex;
+    std::vector<int64_t> lateness_us;
+    std::atomic<uint64_t> fired{0};
+    std::atomic<uint64_t> cancelled{0};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            std::minstd_rand rng(p + 1);
+            std::uniform_int_distribution<int> delay_dist(1, max_delay_ms);
+            std::uniform_real_distribution<double> cancel_dist(0.0, 1.0);
+            for (int i = 0; i < timers_per_producer; i++) {
+                auto delay = std::chrono::milliseconds(delay_dist(rng));
+                auto expected = std::chrono::steady_clock::now() + delay;
+                ctx::TimerId id = executor.PostDelayedTask(tag, [&, expected]() {
+                    auto late = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - expected).count();
+                    std::lock_guard<std::mutex> lock(lateness_mutex);
+                    lateness_us.push_back(late);
+                    fired.fetch_add(1, std::memory_order_relaxed);
+                }, delay);
+                if (cancel_dist(rng) < cancel_ratio && executor.CancelTimer(id)) {
+                    cancelled.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double post_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const uint64_t total = static_cast<uint64_t>(producers) * timers_per_producer;
+    while (fired.load() + cancelled.load() < total) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::sort(lateness_us.begin(), lateness_us.end());
+    auto pct = [&](double p) {
+        return lateness_us.empty() ? 0 : lateness_us[std::min(lateness_us.size() - 1, static_cast<size_t>(p * lateness_us.size()))];
+    };
+    std::printf("{\"timers\": %llu, \"cancelled\": %llu, \"fired\": %llu, \"post_s\": %.3f, \"ops_per_sec\": %.0f, "
+                "\"late_p50_us\": %lld, \"late_p99_us\": %lld, \"late_max_us\": %lld}\n",
+                static_cast<unsigned long long>(total), static_cast<unsigned long long>(cancelled.load()),
+                static_cast<unsigned long long>(fired.load()), post_s, total / post_s,
+                static_cast<long long>(pct(0.5)), static_cast<long long>(pct(0.99)),
+                static_cast<long long>(lateness_us.empty() ? 0 : lateness_us.back()));
+    std::fflush(stdout);
+    return 0;
+}
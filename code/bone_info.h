@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <array>
@@ -68,6 +70,90 @@ struct BoneInfo {
         "dipfifth"
     };
 
+    // ====== RUS-CHN 骨龄评分 ======
+    // 与前端 res/js/scripts.js 中的 SCORE 表和 calculateBoneAge 保持一致
+
+    enum class Sex {
+        kBoy = 0,
+        kGirl = 1,
+    };
+
+    // 每个关节 16 格, 第 0 格和没用到的格子都是 0
+    // 成熟度等级从 1 开始, 直接作为下标; 未检出 (-1) 或越界的等级落到恒为 0 的最后一格
+    static constexpr size_t kRusChnStages = 16;
+    using RusChnScoreTable = std::array<std::array<int16_t, kRusChnStages>, 13>;
+
+    // 下标顺序同 kKeyJoints
+    static constexpr std::array<RusChnScoreTable, 2> kRusChnScores = {{
+        {{ // boy
+            {0, 8, 11, 15, 18, 31, 46, 76, 118, 135, 171, 188, 197, 201, 209},
+            {0, 25, 30, 35, 43, 61, 80, 116, 157, 168, 180, 187, 194},
+            {0, 4, 5, 8, 16, 22, 26, 34, 39, 45, 52, 66},
+            {0, 3, 4, 5, 8, 13, 19, 30, 38, 44, 51},
+            {0, 3, 4, 6, 9, 14, 19, 31, 41, 46, 50},
+            {0, 4, 5, 7, 11, 17, 23, 29, 36, 44, 52, 59, 66},
+            {0, 3, 4, 5, 8, 14, 19, 23, 28, 34, 40, 45, 50},
+            {0, 3, 4, 6, 10, 16, 19, 24, 28, 33, 40, 44, 50},
+            {0, 3, 4, 5, 9, 14, 18, 23, 28, 35, 42, 45, 50},
+            {0, 3, 4, 6, 11, 17, 21, 26, 31, 36, 40, 43, 49},
+            {0, 4, 5, 6, 9, 19, 28, 36, 43, 46, 51, 67},
+            {0, 3, 4, 5, 9, 15, 23, 29, 33, 37, 40, 49},
+            {0, 3, 4, 6, 11, 17, 23, 29, 32, 36, 40, 49},
+        }},
+        {{ // girl
+            {0, 10, 15, 22, 25, 40, 59, 91, 125, 138, 178, 192, 199, 203, 210},
+            {0, 27, 31, 36, 50, 73, 95, 120, 157, 168, 176, 182, 189},
+            {0, 5, 7, 10, 16, 23, 28, 34, 41, 47, 53, 66},
+            {0, 3, 5, 6, 9, 14, 21, 32, 40, 47, 51},
+            {0, 4, 5, 7, 10, 15, 22, 33, 43, 47, 51},
+            {0, 6, 7, 8, 11, 17, 26, 32, 38, 45, 53, 60, 67},
+            {0, 3, 5, 7, 9, 15, 20, 25, 29, 35, 41, 46, 51},
+            {0, 4, 5, 7, 11, 18, 21, 25, 29, 34, 40, 45, 50},
+            {0, 4, 5, 7, 10, 16, 21, 25, 29, 35, 43, 46, 51},
+            {0, 3, 5, 7, 12, 19, 23, 27, 32, 35, 39, 43, 49},
+            {0, 5, 6, 8, 10, 20, 31, 38, 44, 45, 52, 67},
+            {0, 3, 5, 7, 10, 16, 24, 30, 33, 36, 39, 49},
+            {0, 5, 6, 7, 11, 18, 25, 29, 33, 35, 39, 49},
+        }},
+    }};
+
+    // 总分到骨龄 (岁) 的 10 次多项式, 系数从常数项开始
+    static constexpr std::array<std::array<double, 11>, 2> kRusChnCurves = {{
+        {{ // boy
+            2.01790023656577, -0.0931820870747269, 0.00334709095418796, -3.32988302362153E-05,
+            1.75712910819776E-07, -5.59998691223273E-10, 1.1296711294933E-12, -1.45218037113138e-15,
+            1.15333377080353e-18, -5.15887481551927e-22, 9.94098428102335e-26,
+        }},
+        {{ // girl
+            5.81191794824917, -0.271546561737745, 0.00526301486340724, -4.37797717401925E-05,
+            2.0858722025667E-07, -6.21879866563429E-10, 1.19909931745368E-12, -1.49462900826936E-15,
+            1.162435538672E-18, -5.12713017846218E-22, 9.78989966891478E-26,
+        }},
+    }};
+
+    // stages 下标同 kKeyJoints, 没有检出的关节填 -1
+    static constexpr int RusChnTotalScore(Sex sex, const std::array<int, 13>& stages) {
+        const auto& table = kRusChnScores[static_cast<size_t>(sex)];
+        int total = 0;
+        for (size_t j = 0; j < stages.size(); j++) {
+            // 负数转成 unsigned 后很大, 和越界一样被压到最后一格
+            size_t index = std::min<size_t>(static_cast<unsigned>(stages[j]), kRusChnStages - 1);
+            total += table[j][index];
+        }
+        return total;
+    }
+
+    // Horner 求值, 结果小于 0 时取 0
+    static constexpr double RusChnBoneAge(Sex sex, int total_score) {
+        const auto& c = kRusChnCurves[static_cast<size_t>(sex)];
+        const double x = total_score;
+        double age = c[10];
+        for (size_t i = 10; i-- > 0;) {
+            age = age * x + c[i];
+        }
+        return std::max(age, 0.0);
+    }
+
     static constexpr std::string_view DetectGetNameById(int id) {
         for (const auto& item : kDetectBones) {
             if (item.id == id) {
@@ -5,6 +5,8 @@
 #include "net/inetaddress.h"
 
 #include <iostream>
+#include <csignal>
+#include <thread>
 
 #include <spdlog/spdlog.h>
 #include <spdlog/async.h>
@@ -13,6 +15,7 @@
 #include "logging/logger.h"
 #include "CLI/CLI.hpp" 
 #include "config.h"
+#include "tracing/tracer.h"
 
 #include <fmt/format.h>
 
@@ -26,11 +29,48 @@ int main(int argc, char** argv) {
     app.add_option("--port", config.port, "Port the server listens on");
     app.add_option("--io-threads", config.num_io_threads, "Number of IO threads");
     app.add_option("--infer-threads", config.num_infer_threads, "Number of infer threads");
+    app.add_option("--infer-batch-size", config.infer_batch_size, "Max images per detector batch");
+    std::map<std::string, inference::BoneAgeInferencer::DecodeMode> decode_mode_map {
+        {"full", inference::BoneAgeInferencer::DecodeMode::kFull},
+        {"reduced2", inference::BoneAgeInferencer::DecodeMode::kReduced2},
+        {"reduced4", inference::BoneAgeInferencer::DecodeMode::kReduced4}
+    };
+    app.add_option("--use-gpu", config.use_gpu, "Run models with CUDA when available");
+    app.add_option("--decode-mode", config.decode_mode, "Decode images at full size or reduced by 2 / 4")
+        ->transform(CLI::CheckedTransformer(decode_mode_map, CLI::ignore_case));
+    std::map<std::string, nn::Precision> precision_map {
+        {"fp32", nn::Precision::kFp32},
+        {"int8", nn::Precision::kInt8}
+    };
+    app.add_option("--detect-precision", config.detect_precision, "Detection model precision, int8 loads <yolo-model>_int8.onnx")
+        ->transform(CLI::CheckedTransformer(precision_map, CLI::ignore_case));
+    app.add_option("--classify-precision", config.classify_precision, "Classification model precision, int8 loads <cls-model>_int8.onnx")
+        ->transform(CLI::CheckedTransformer(precision_map, CLI::ignore_case));
+
+    std::map<std::string, net::LoopSelectPolicy> loop_policy_map {
+        {"round-robin", net::LoopSelectPolicy::kRoundRobin},
+        {"least-connections", net::LoopSelectPolicy::kLeastConnections},
+        {"least-pending-bytes", net::LoopSelectPolicy::kLeastPendingBytes},
+        {"power-of-two", net::LoopSelectPolicy::kPowerOfTwoChoices}
+    };
+    app.add_option("--loop-policy", config.loop_select_policy, "How new connections pick an IO thread")
+        ->transform(CLI::CheckedTransformer(loop_policy_map, CLI::ignore_case));
+
+    std::map<std::string, net::LoopAffinity> affinity_map {
+        {"none", net::LoopAffinity::kNone},
+        {"core", net::LoopAffinity::kCore},
+        {"numa", net::LoopAffinity::kNumaNode}
+    };
+    app.add_option("--io-affinity", config.io_affinity, "Pin IO threads to a CPU core or NUMA node")
+        ->transform(CLI::CheckedTransformer(affinity_map, CLI::ignore_case));
+    app.add_option("--max-connections", config.max_connections, "Stop accepting above this many connections (0 = unlimited)");
+    app.add_option("--max-connections-per-loop", config.max_connections_per_loop, "Connection limit for each IO thread (0 = unlimited)");
 
     app.add_option("--static-dir", config.static_root_path, "Path to static files directory");
     
     app.add_option("--yolo-model", config.yolo_model_path, "Path to YOLO detection model");
     app.add_option("--cls-model", config.cls_model_path, "Path to classification model");
+    app.add_option("--model-cache-dir", config.model_cache_dir, "Cache onnxruntime-optimized models here for faster restarts (empty = off)");
 
     app.add_option("--log-path", config.log_path, "Base path for log files");
     
@@ -45,6 +85,20 @@ int main(int argc, char** argv) {
     };
     app.add_option("--log-level", config.log_level, "Set log level (trace, debug, info, ...)")
         ->transform(CLI::CheckedTransformer(log_level_map, CLI::ignore_case));
+    app.add_option("--log-async", config.log_async.enabled, "Write log files on a background thread");
+    app.add_option("--log-queue-size", config.log_async.queue_size, "Max pending messages for async logging");
+    std::map<std::string, logging::OverflowPolicy> overflow_map {
+        {"block", logging::OverflowPolicy::Block},
+        {"overrun-oldest", logging::OverflowPolicy::OverrunOldest},
+        {"discard-new", logging::OverflowPolicy::DiscardNew}
+    };
+    app.add_option("--log-overflow", config.log_async.overflow_policy, "What async logging does when the queue is full")
+        ->transform(CLI::CheckedTransformer(overflow_map, CLI::ignore_case));
+    auto* access_log_every = app.add_option("--access-log-every", config.access_log_interval,
+                                            "Log one request out of N (0 = off; default 100, or 1 with --access-log-dir)");
+    app.add_option("--access-log-dir", config.access_log_dir, "Write binary access records to per-thread ring files in this directory");
+    app.add_option("--access-log-ring-records", config.access_log_ring_records, "Records kept per IO thread in binary access log mode");
+    app.add_option("--trace-dir", config.trace_dir, "Directory for trace files dumped on SIGUSR2");
 
     app.set_config("-c,--config", "config.toml", "Read an toml file", true);
 
@@ -62,7 +116,30 @@ int main(int argc, char** argv) {
         default: log_level_str = "unknown";
     }
 
-    logging::Init(config.log_path, config.log_level);
+#ifdef BONEAGE_TRACING
+    // 在创建其他线程 (包括日志线程) 之前屏蔽 SIGUSR2, 新线程继承屏蔽字, 信号只会被下面的线程 sigwait 到
+    // 导出在普通线程里进行, 不受信号处理函数的限制
+    sigset_t trace_signals;
+    sigemptyset(&trace_signals);
+    sigaddset(&trace_signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &trace_signals, nullptr);
+    std::thread([trace_signals, trace_dir = config.trace_dir]() {
+        while (true) {
+            int signal = 0;
+            if (sigwait(&trace_signals, &signal) != 0) {
+                continue;
+            }
+            std::string path = tracing::Tracer::GetInstance().DumpToFile(trace_dir);
+            if (path.empty()) {
+                LOG_ERROR("Failed to write trace file to {}", trace_dir);
+            } else {
+                LOG_INFO("Trace written to {}", path);
+            }
+        }
+    }).detach();
+#endif
+
+    logging::Init(config.log_path, config.log_level, config.log_async);
     LOG_INFO("Server configuration loaded successfully.\n"
          "IP: {}, Port: {}, IO Threads: {}, Infer Threads: {}\n"
          "Static Dir: {}\n"
@@ -78,18 +155,38 @@ int main(int argc, char** argv) {
          config.log_path,
          log_level_str);
 
-    INFERENCER.Init(config.num_infer_threads, config.yolo_model_path, config.cls_model_path);
+    INFERENCER.SetDecodeMode(config.decode_mode);
+    INFERENCER.SetModelCacheDir(config.model_cache_dir);
+    INFERENCER.Init(config.num_infer_threads, config.yolo_model_path, config.cls_model_path, config.infer_batch_size, config.use_gpu,
+                    config.detect_precision, config.classify_precision);
     LOG_INFO("Inference engine initialized successfully.");
 
     net::InetAddress listen_addr(config.server_ip, config.port);
     http::HttpApplication http_app(std::move(listen_addr), config.static_root_path, "bone_age");
 
     http_app.SetThreadNum(config.num_io_threads);
+    http_app.SetLoopSelectPolicy(config.loop_select_policy);
+    http_app.SetLoopAffinity(config.io_affinity);
+    http_app.SetMaxConnections(config.max_connections);
+    http_app.SetMaxConnectionsPerLoop(config.max_connections_per_loop);
+    uint32_t access_log_interval = config.access_log_interval;
+    if (!config.access_log_dir.empty()) {
+        if (http_app.EnableBinaryAccessLog(config.access_log_dir, config.access_log_ring_records)) {
+            // 二进制记录只是往 mmap 的环里写 64 字节, 没有指定采样间隔时每个请求都记
+            if (access_log_every->count() == 0) {
+                access_log_interval = 1;
+            }
+        } else {
+            LOG_WARN("Binary access log unavailable, falling back to text access log.");
+        }
+    }
+    http_app.SetAccessLogInterval(access_log_interval);
 
     LOG_INFO("Server listening...");
     http_app.Start();
 
     INFERENCER.Shutdown();
+    logging::Shutdown();
 
     return 0;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "inference/boneage_inference.h"
 #include "logging/logger.h"
+#include "net/eventloopthreadpool.h"
 #include <string>
 #include <vector>
 
@@ -9,12 +11,28 @@ struct Config {
     int port;
     int num_io_threads;
     int num_infer_threads;
+    size_t infer_batch_size = 1;         // 一次送进模型的最多图片数
+    bool use_gpu = true;                 // 没有 CUDA 时自动退回 CPU
+    inference::BoneAgeInferencer::DecodeMode decode_mode = inference::BoneAgeInferencer::DecodeMode::kFull;
+    nn::Precision detect_precision = nn::Precision::kFp32;    // int8 时加载 *_int8.onnx, 固定用 CPU
+    nn::Precision classify_precision = nn::Precision::kFp32;
+    net::LoopSelectPolicy loop_select_policy = net::LoopSelectPolicy::kRoundRobin;
+    net::LoopAffinity io_affinity = net::LoopAffinity::kNone;
+    size_t max_connections = 0;          // 0 表示不限制
+    size_t max_connections_per_loop = 0;
 
     std::string static_root_path;
 
     std::string yolo_model_path;
     std::string cls_model_path;
+    std::string model_cache_dir;         // 空表示不缓存优化后的模型
 
     std::string log_path;
     logging::LogLevel log_level;
+    logging::AsyncOptions log_async{true};  // 默认异步写日志, 不阻塞 IO 线程
+    uint32_t access_log_interval = 100;     // 每多少个请求写一行访问日志, 0 关闭; 二进制模式下默认每个请求都记
+    std::string access_log_dir;             // 非空时访问日志写成二进制记录, 用 accesslog_decode 查看
+    size_t access_log_ring_records = 1 << 18; // 二进制模式下每个 IO 线程保留的记录数
+
+    std::string trace_dir = ".";         // 收到 SIGUSR2 时追踪文件写到这里 (需要 ENABLE_TRACING 编译)
 };
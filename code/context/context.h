@@ -49,3 +49,8 @@ class Context {
   EXECUTOR->PostRepeatedTask(tag, task, delay, repeat_counts)
 
 #define CANCEL_REPEATED_TASK(id) EXECUTOR->CancelRepeatedTask(id)
+
+#define POST_DELAYED_TASK(tag, task, delay) \
+  EXECUTOR->PostDelayedTask(tag, task, delay)
+
+#define CANCEL_TIMER(id) EXECUTOR->CancelTimer(id)
@@ -1,5 +1,7 @@
 #include "executor.h"
 
+#include <algorithm>
+
 namespace ctx {
 
 void Executor::ExecutorTimer::Start() {
@@ -13,93 +15,86 @@ void Executor::ExecutorTimer::Stop() {
   if (is_closed_.exchange(true)) {
     return;
   }
-  tasks_cv_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(wheel_mutex_);
+    wheel_cv_.notify_all();
+  }
   threadpool_.Stop();
-  tasks_ = std::priority_queue<TaskInfo, std::vector<TaskInfo>,
-                               std::greater<TaskInfo>>();
+  std::lock_guard<std::mutex> lock(wheel_mutex_);
+  wheel_.Clear();
+}
+
+uint64_t Executor::ExecutorTimer::NowTick_() const {
+  return (std::chrono::steady_clock::now() - start_time_) / kTick;
 }
 
-// 循环取出任务队列的顶部元素，执行任务或等待
+uint64_t Executor::ExecutorTimer::ExpireTick_(const std::chrono::microseconds& delay) const {
+  auto elapsed = std::chrono::steady_clock::now() - start_time_ + delay;
+  // 向上取整, 保证不会提前执行
+  return (elapsed + kTick - std::chrono::nanoseconds(1)) / kTick;
+}
+
+// 推进时间轮, 到期的任务批量取出, 在锁外执行
 void Executor::ExecutorTimer::Run_() {
-  while (true) {
-    TaskInfo task_info;
-    {
-      std::unique_lock<std::mutex> lock(tasks_mutex_);
-      tasks_cv_.wait(lock,
-                     [this]() { return !tasks_.empty() || is_closed_.load(); });
-      if (is_closed_.load()) {
-        break;
-      }
-      TimePointType next_exec_time = tasks_.top().exec_time_point;
-
-      // 判断取出的任务是否到了执行的时间点
-      if (next_exec_time > std::chrono::high_resolution_clock::now()) {
-        // 没到，等待到时间点 或者 被 唤醒（加入新任务）
-        tasks_cv_.wait_until(lock, next_exec_time);
-        // 因为可能加入新任务，重新循环来做判断
-        continue;
-      } else {
-        task_info = std::move(tasks_.top());
-        tasks_.pop();
+  std::vector<Task> expired;
+  std::unique_lock<std::mutex> lock(wheel_mutex_);
+  while (!is_closed_.load()) {
+    wheel_.Advance(NowTick_(), &expired);
+    if (!expired.empty()) {
+      lock.unlock();
+      for (auto& task : expired) {
+        task();
       }
+      expired.clear();
+      lock.lock();
+      continue;
     }
-    task_info.task();
-  }
-}
 
-void Executor::ExecutorTimer::PostDelayedTask(
-    Task task, const std::chrono::microseconds& delay) {
-  PostTask_(std::move(task), delay, 0);
+    wakeup_tick_ = wheel_.NextExpiry();
+    if (wakeup_tick_ == UINT64_MAX) {
+      wheel_cv_.wait(lock);
+    } else {
+      wheel_cv_.wait_until(lock, start_time_ + wakeup_tick_ * kTick);
+    }
+  }
 }
 
-RepeatedTaskId Executor::ExecutorTimer::PostRepeatedTask(
-    Task task, const std::chrono::microseconds& delay, uint64_t repeat_counts) {
-  RepeatedTaskId id = GetNextRepeatedId();
-  {
-    std::lock_guard<std::mutex> lock(repeated_task_mutex_);
-    repeated_task_id_set_.insert(id);
+void Executor::ExecutorTimer::NotifyIfEarlier_(uint64_t expire_tick) {
+  if (expire_tick < wakeup_tick_) {
+    wakeup_tick_ = expire_tick;
+    wheel_cv_.notify_one();
   }
+}
 
-  // 首次提交
-  Task first_task = std::bind(&Executor::ExecutorTimer::PostRepeatedTask_, this, std::move(task), delay, id, repeat_counts);
-  PostTask_(std::move(first_task), delay, id);
-
+TimerId Executor::ExecutorTimer::PostDelayedTask(
+    Task task, const std::chrono::microseconds& delay) {
+  uint64_t expire_tick = ExpireTick_(delay);
+  std::lock_guard<std::mutex> lock(wheel_mutex_);
+  TimerId id = wheel_.Add(expire_tick, std::move(task));
+  NotifyIfEarlier_(expire_tick);
   return id;
 }
 
-// 添加一个taskinfo到任务队列
-void Executor::ExecutorTimer::PostTask_(Task task,
-                                        const std::chrono::microseconds& delay,
-                                        RepeatedTaskId id) {
-  std::chrono::time_point<std::chrono::high_resolution_clock> exec_time_point =
-      std::chrono::high_resolution_clock::now() + delay;
-  {
-    std::lock_guard<std::mutex> lock(tasks_mutex_);
-    tasks_.push({std::move(task), id, exec_time_point});
+TimerId Executor::ExecutorTimer::PostRepeatedTask(
+    Task task, const std::chrono::microseconds& delay, uint64_t repeat_counts) {
+  uint64_t expire_tick = ExpireTick_(delay);
+  uint64_t interval = (delay + kTick - std::chrono::microseconds(1)) / kTick;
+  std::lock_guard<std::mutex> lock(wheel_mutex_);
+  TimerId id = wheel_.AddRepeated(expire_tick, interval, repeat_counts, std::move(task));
+  if (id != 0) {
+    NotifyIfEarlier_(expire_tick);
   }
-  tasks_cv_.notify_one();
+  return id;
 }
 
-// 递归 执行task并提交自己到任务队列
-void Executor::ExecutorTimer::PostRepeatedTask_(Task task, const std::chrono::microseconds& delay, RepeatedTaskId id, uint64_t repeat_counts) {
-  {
-    std::lock_guard<std::mutex> lock(repeated_task_mutex_);
-    if (repeated_task_id_set_.find(id) == repeated_task_id_set_.end() ||
-        repeat_counts == 0) {
-      return;
-    }
-  }
-  task();
-  repeat_counts--;
-  if (repeat_counts > 0) {
-    Task next_task = std::bind(&Executor::ExecutorTimer::PostRepeatedTask_, this, std::move(task), delay, id, repeat_counts);
-    PostTask_(std::move(next_task), delay, id);
-  }
+bool Executor::ExecutorTimer::CancelTimer(TimerId id) {
+  std::lock_guard<std::mutex> lock(wheel_mutex_);
+  return wheel_.Cancel(id);
 }
 
-void Executor::ExecutorTimer::CancelRepeatedTask(RepeatedTaskId id) {
-  std::lock_guard<std::mutex> lock(repeated_task_mutex_);
-  repeated_task_id_set_.erase(id);
+size_t Executor::ExecutorTimer::PendingTimers() {
+  std::lock_guard<std::mutex> lock(wheel_mutex_);
+  return wheel_.Size();
 }
 
 TaskRunnerTag Executor::ExecutorContext::AddStrandRunner(TaskRunnerTag tag) {
@@ -108,8 +103,9 @@ TaskRunnerTag Executor::ExecutorContext::AddStrandRunner(TaskRunnerTag tag) {
   while (task_runner_map_.find(tag) != task_runner_map_.end()) {
     tag = GetNextRunnerTag();
   }
-  task_runner_map_.emplace(std::piecewise_construct, std::forward_as_tuple(tag),
-                           std::forward_as_tuple(1));
+  auto it = task_runner_map_.emplace(std::piecewise_construct, std::forward_as_tuple(tag),
+                                    std::forward_as_tuple(GetStrandPool_())).first;
+  PublishRunner_(tag, &it->second);
   return tag;
 }
 
@@ -118,13 +114,45 @@ TaskRunnerTag Executor::ExecutorContext::AddParallelRunner(TaskRunnerTag tag, in
   while (task_runner_map_.find(tag) != task_runner_map_.end()) {
     tag = GetNextRunnerTag();
   }
-  task_runner_map_.emplace(std::piecewise_construct, std::forward_as_tuple(tag),
-                           std::forward_as_tuple(thread_count));
+  auto it = task_runner_map_.emplace(std::piecewise_construct, std::forward_as_tuple(tag),
+                                    std::forward_as_tuple(thread_count)).first;
+  PublishRunner_(tag, &it->second);
   return tag;
 }
 
+ThreadPool* Executor::ExecutorContext::GetStrandPool_() {
+  if (!strand_pool_) {
+    // strand 里的任务可能会阻塞 (比如 SQL 查询), 线程数至少为 4
+    uint32_t thread_count = std::max(4u, std::thread::hardware_concurrency());
+    strand_pool_ = std::make_unique<ThreadPool>(thread_count);
+  }
+  return strand_pool_.get();
+}
+
+void Executor::ExecutorContext::PublishRunner_(TaskRunnerTag tag, TaskRunner* runner) {
+  size_t segment_index = tag >> kSegmentBits;
+  if (segment_index >= kNumSegments) {
+    return;  // 只能从 map 里查
+  }
+  RunnerSegment* segment = runner_segments_[segment_index].load(std::memory_order_relaxed);
+  if (segment == nullptr) {
+    segment = new RunnerSegment();
+    runner_segments_[segment_index].store(segment, std::memory_order_release);
+  }
+  segment->runners[tag & (kSegmentSize - 1)].store(runner, std::memory_order_release);
+}
+
+// tag 在查找表范围内时无锁
 Executor::ExecutorContext::TaskRunner* Executor::ExecutorContext::GetTaskRunner(
     TaskRunnerTag tag) {
+  size_t segment_index = tag >> kSegmentBits;
+  if (segment_index < kNumSegments) {
+    RunnerSegment* segment = runner_segments_[segment_index].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+      return nullptr;
+    }
+    return segment->runners[tag & (kSegmentSize - 1)].load(std::memory_order_acquire);
+  }
   std::lock_guard<std::mutex> lock(task_runner_mutex_);
   auto it = task_runner_map_.find(tag);
   if (it == task_runner_map_.end()) {
@@ -133,10 +161,22 @@ Executor::ExecutorContext::TaskRunner* Executor::ExecutorContext::GetTaskRunner(
   return &it->second;
 }
 
-void Executor::PostTask(TaskRunnerTag tag, Task task) {
+Executor::ExecutorContext::~ExecutorContext() {
+  for (auto& segment : runner_segments_) {
+    delete segment.load(std::memory_order_relaxed);
+  }
+}
+
+bool Executor::PostTask(TaskRunnerTag tag, Task task) {
   Executor::ExecutorContext::TaskRunner* runner_ptr =
       executor_context_.GetTaskRunner(tag);
+  // 查找表不加锁, 投递到还没注册的 tag 是调用方的错误, 不能悄悄丢掉
+  assert(runner_ptr != nullptr && "PostTask to an unregistered runner tag");
+  if (runner_ptr == nullptr) {
+    return false;
+  }
   runner_ptr->RunTask(std::move(task));
+  return true;
 }
 
 TaskRunnerTag Executor::AddStrandRunner(TaskRunnerTag tag) {
@@ -1,43 +1,37 @@
 #pragma once
+#include <array>
 #include <atomic>
+#include <cassert>
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <future>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
-#include <unordered_set>
+#include <vector>
 
+#include "strand.h"
+#include "task.h"
 #include "thread_pool.h"
+#include "timing_wheel.h"
 
 namespace ctx {
 
-using Task = std::function<void()>;
-using RepeatedTaskId = uint64_t;
+using RepeatedTaskId = TimerId;
 using TaskRunnerTag = uint64_t;
 
 class Executor {
  private:
-  // 管理定时事件
+  // 管理定时事件, 底层是分层时间轮, 时钟为 steady_clock, 精度 1ms
   class ExecutorTimer {
-   private:
-    using TimePointType =
-        std::chrono::time_point<std::chrono::high_resolution_clock>;
-
-    struct TaskInfo {
-      Task task;
-      RepeatedTaskId repeated_id;
-      TimePointType exec_time_point;
-
-      bool operator>(const TaskInfo& rhs) const {
-        return exec_time_point > rhs.exec_time_point;
-      }
-    };
-
    public:
-    ExecutorTimer() : threadpool_(1) {}
+    static constexpr std::chrono::microseconds kTick{1000};
+
+    ExecutorTimer()
+        : start_time_(std::chrono::steady_clock::now()), threadpool_(1) {}
 
     ~ExecutorTimer() { Stop(); }
 
@@ -45,42 +39,43 @@ class Executor {
 
     void Stop();
 
-    void PostDelayedTask(Task task, const std::chrono::microseconds& delay);
+    TimerId PostDelayedTask(Task task, const std::chrono::microseconds& delay);
+
+    TimerId PostRepeatedTask(Task task, const std::chrono::microseconds& delay,
+                             uint64_t repeat_counts);
 
-    RepeatedTaskId PostRepeatedTask(Task task,
-                                    const std::chrono::microseconds& delay,
-                                    uint64_t repeat_counts);
+    // 取消后任务立即释放; 已经到期正在执行的任务不受影响
+    bool CancelTimer(TimerId id);
 
-    void CancelRepeatedTask(RepeatedTaskId id);
+    size_t PendingTimers();
 
    private:
     void Run_();
 
-    void PostTask_(Task task, const std::chrono::microseconds& delay,
-                   RepeatedTaskId id);
-
-    void PostRepeatedTask_(Task task, const std::chrono::microseconds& delay, RepeatedTaskId id, uint64_t repeat_counts);
-    RepeatedTaskId GetNextRepeatedId() { return repeated_task_id_++; }
+    uint64_t NowTick_() const;
+    // 不早于 now + delay 的第一个 tick
+    uint64_t ExpireTick_(const std::chrono::microseconds& delay) const;
+    // 新定时器比定时线程等待的时间点更早时才唤醒它, 持有 wheel_mutex_ 时调用
+    void NotifyIfEarlier_(uint64_t expire_tick);
 
    private:
-    std::priority_queue<TaskInfo, std::vector<TaskInfo>, std::greater<TaskInfo>>
-        tasks_;
-    std::mutex tasks_mutex_;
-    std::condition_variable tasks_cv_;
+    const std::chrono::steady_clock::time_point start_time_;
+
+    TimingWheel wheel_;
+    std::mutex wheel_mutex_;
+    std::condition_variable wheel_cv_;
+    uint64_t wakeup_tick_ = UINT64_MAX;  // 定时线程下一次醒来的 tick, 受 wheel_mutex_ 保护
 
     std::atomic<bool> is_closed_{true};
 
     ThreadPool threadpool_;
-    std::atomic<RepeatedTaskId> repeated_task_id_{1};
-    std::unordered_set<RepeatedTaskId> repeated_task_id_set_;
-    std::mutex repeated_task_mutex_;
   };
 
-  // 管理所有strand
+  // 管理所有 runner (strand 和并行线程池)
   class ExecutorContext {
    public:
     ExecutorContext() = default;
-    ~ExecutorContext() = default;
+    ~ExecutorContext();
 
     ExecutorContext(const ExecutorContext& other) = delete;
     ExecutorContext& operator=(const ExecutorContext& other) = delete;
@@ -90,19 +85,55 @@ class Executor {
     TaskRunnerTag AddParallelRunner(TaskRunnerTag tag, int thread_count);
 
    private:
-    using TaskRunner = ThreadPool;
-    using TaskRunnerPtr = std::unique_ptr<TaskRunner>;
+    // 并行 runner 独占一个线程池; strand runner 只是一个串行队列, 运行在共享的 strand_pool_ 上
+    class TaskRunner {
+     public:
+      explicit TaskRunner(int thread_count)
+          : pool_(std::make_unique<ThreadPool>(thread_count)) {}
+      explicit TaskRunner(ThreadPool* strand_pool)
+          : strand_(std::make_unique<Strand>(strand_pool)) {}
+
+      void RunTask(Task task) {
+        if (strand_) {
+          strand_->Post(std::move(task));
+        } else {
+          pool_->RunTask(std::move(task));
+        }
+      }
+
+     private:
+      std::unique_ptr<ThreadPool> pool_;
+      std::unique_ptr<Strand> strand_;
+    };
     friend class Executor;
 
+    // tag -> runner 的无锁查找表: 两级数组, 按 tag 直接下标访问
+    // 每个槽位注册时原子地写入一次, 之后只读; 段只增不删, 析构时统一释放
+    static constexpr size_t kSegmentBits = 10;
+    static constexpr size_t kSegmentSize = size_t(1) << kSegmentBits;
+    static constexpr size_t kNumSegments = 1024;  // 覆盖 tag < 1M, 更大的 tag 退回加锁查 map
+    struct RunnerSegment {
+      std::atomic<TaskRunner*> runners[kSegmentSize];
+    };
+
    private:
     TaskRunner* GetTaskRunner(TaskRunnerTag tag);
 
     TaskRunnerTag GetNextRunnerTag() { return task_runner_tag_++; }
 
+    // 持有 task_runner_mutex_ 时调用
+    void PublishRunner_(TaskRunnerTag tag, TaskRunner* runner);
+    ThreadPool* GetStrandPool_();
+
    private:
     TaskRunnerTag task_runner_tag_ = 1; // tag从1开始
     std::map<TaskRunnerTag, TaskRunner> task_runner_map_;
     std::mutex task_runner_mutex_;
+    // 所有 strand 共享的线程池, 第一次添加 strand 时创建
+    // 放在 task_runner_map_ 之后, 析构时先停掉线程, 再销毁 strand
+    std::unique_ptr<ThreadPool> strand_pool_;
+
+    std::array<std::atomic<RunnerSegment*>, kNumSegments> runner_segments_{};
   };
 
  public:
@@ -116,15 +147,19 @@ class Executor {
 
   TaskRunnerTag AddParallelRunner(TaskRunnerTag tag, int thread_count);
 
-  void PostTask(TaskRunnerTag tag, Task task);
+  // tag 必须是已经添加过的 runner, 否则 debug 下断言失败, release 下丢弃任务并返回 false
+  bool PostTask(TaskRunnerTag tag, Task task);
 
+  // 返回的 TimerId 可以用 CancelTimer 取消, 比如请求完成后取消它的超时
   template <typename R, typename P>
-  void PostDelayedTask(TaskRunnerTag tag, Task task,
-                       const std::chrono::duration<R, P>& delay) {
-    Task func = std::bind(&Executor::PostTask, this, tag, std::move(task));
+  TimerId PostDelayedTask(TaskRunnerTag tag, Task task,
+                          const std::chrono::duration<R, P>& delay) {
+    Task func = [this, tag, task = std::move(task)]() mutable {
+      PostTask(tag, std::move(task));
+    };
 
     executor_timer_.Start();
-    executor_timer_.PostDelayedTask(
+    return executor_timer_.PostDelayedTask(
         std::move(func),
         std::chrono::duration_cast<std::chrono::microseconds>(delay));
   }
@@ -133,7 +168,11 @@ class Executor {
   RepeatedTaskId PostRepeatedTask(TaskRunnerTag tag, Task task,
                                   const std::chrono::duration<R, P>& delay,
                                   uint64_t repeat_counts) {
-    Task func = std::bind(&Executor::PostTask, this, tag, std::move(task));
+    // 每次触发都要投递一份, Task 不能复制, 所以共享同一个可调用对象
+    auto shared_task = std::make_shared<Task>(std::move(task));
+    Task func = [this, tag, shared_task]() {
+      PostTask(tag, [shared_task]() { (*shared_task)(); });
+    };
 
     executor_timer_.Start();
     return executor_timer_.PostRepeatedTask(
@@ -143,15 +182,25 @@ class Executor {
   }
 
   void CancelRepeatedTask(RepeatedTaskId id) {
-    executor_timer_.CancelRepeatedTask(id);
+    executor_timer_.CancelTimer(id);
   }
 
+  bool CancelTimer(TimerId id) { return executor_timer_.CancelTimer(id); }
+
   template <typename F, typename... Args>
   auto PostRetTask(TaskRunnerTag tag, F&& f, Args&&... args)
       -> std::future<std::invoke_result_t<F, Args...>> {
     using return_type = std::invoke_result_t<F, Args...>;
     ExecutorContext::TaskRunner* runner = executor_context_.GetTaskRunner(tag);
-    return runner->RunRetTask(std::forward<F>(f), std::forward<Args>(args)...);
+    assert(runner != nullptr && "PostRetTask to an unregistered runner tag");
+    if (runner == nullptr) {
+      return std::future<return_type>();  // 调用方可以用 valid() 判断
+    }
+    std::packaged_task<return_type()> task_pkg(
+        BindArgs(std::forward<F>(f), std::forward<Args>(args)...));
+    auto result = task_pkg.get_future();
+    runner->RunTask(Task(std::move(task_pkg)));
+    return result;
   }
 
  private:
@@ -0,0 +1,41 @@
+#include "strand.h"
+
+namespace ctx {
+
+void Strand::Post(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  if (!scheduled_.exchange(true)) {
+    pool_->RunTask([this]() { Run_(); });
+  }
+}
+
+void Strand::Run_() {
+  for (int i = 0; i < kMaxTasksPerRun; i++) {
+    Task task;
+    {
+      std::lock_guard<std::mutex> lock(tasks_mutex_);
+      if (tasks_.empty()) {
+        break;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+
+  scheduled_.store(false);
+  // 清除标记之后再检查一次: 期间投递的任务看到的是 true, 不会自己提交
+  bool has_more;
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    has_more = !tasks_.empty();
+  }
+  if (has_more && !scheduled_.exchange(true)) {
+    pool_->RunTask([this]() { Run_(); });
+  }
+}
+
+}  // namespace ctx
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <type_traits>
+
+#include "task.h"
+#include "thread_pool.h"
+
+namespace ctx {
+
+// 运行在共享线程池上的串行任务队列
+// 只有队列里有任务时才向线程池提交一次执行, 空闲时不占用任何线程;
+// 同一时刻最多在一个线程上运行, 任务按投递顺序执行
+// 线程池必须先于 strand 停止, 否则可能有正在执行的 Run_ 访问已销毁的 strand
+class Strand {
+ public:
+  explicit Strand(ThreadPool* pool) : pool_(pool) {}
+
+  Strand(const Strand&) = delete;
+  Strand& operator=(const Strand&) = delete;
+
+  void Post(Task task);
+
+  template <typename F, typename... Args>
+  auto PostRetTask(F&& f, Args&&... args)
+      -> std::future<std::invoke_result_t<F, Args...>> {
+    using return_type = std::invoke_result_t<F, Args...>;
+    std::packaged_task<return_type()> task_pkg(
+        BindArgs(std::forward<F>(f), std::forward<Args>(args)...));
+    auto result = task_pkg.get_future();
+    Post(Task(std::move(task_pkg)));
+    return result;
+  }
+
+ private:
+  void Run_();
+
+  // 一次最多连续执行的任务数, 执行完让出线程, 避免一个繁忙的 strand 占住工作线程
+  static constexpr int kMaxTasksPerRun = 64;
+
+  ThreadPool* pool_;
+  std::mutex tasks_mutex_;
+  std::deque<Task> tasks_;
+  std::atomic<bool> scheduled_{false};  // 是否已经提交到线程池或正在执行
+};
+
+}  // namespace ctx
@@ -0,0 +1,137 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ctx {
+
+// 只能移动的 void() 可调用对象, 代替 std::function<void()>
+// 不超过 kInlineSize 字节且移动不抛异常的可调用对象直接放在内部, 不申请堆内存;
+// 更大的才放到堆上. 可以存放 packaged_task 这类只能移动的对象
+class Task {
+ public:
+  static constexpr size_t kInlineSize = 56;  // 加上 ops_ 指针正好 64 字节
+
+  Task() noexcept = default;
+  Task(std::nullptr_t) noexcept {}
+
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<F>, Task> &&
+                std::is_invocable_v<std::decay_t<F>&>>>
+  Task(F&& f) {
+    using Fn = std::decay_t<F>;
+    if constexpr (kFitsInline<Fn>) {
+      ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+      ops_ = &kInlineOps<Fn>;
+    } else {
+      ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+      ops_ = &kHeapOps<Fn>;
+    }
+  }
+
+  Task(Task&& other) noexcept { MoveFrom_(other); }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset_();
+      MoveFrom_(other);
+    }
+    return *this;
+  }
+
+  Task& operator=(std::nullptr_t) noexcept {
+    Reset_();
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() { Reset_(); }
+
+  void operator()() { ops_->invoke(storage_); }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+  // 是否存放在内部缓冲区, 主要给测试用
+  bool IsInline() const noexcept { return ops_ != nullptr && ops_->is_inline; }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    void (*move)(void* dst, void* src) noexcept;  // 移动后 src 已析构
+    void (*destroy)(void* storage) noexcept;
+    bool is_inline;
+  };
+
+  template <typename Fn>
+  static constexpr bool kFitsInline =
+      sizeof(Fn) <= kInlineSize &&
+      alignof(Fn) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<Fn>;
+
+  template <typename Fn>
+  static Fn* InlinePtr_(void* storage) {
+    return std::launder(static_cast<Fn*>(storage));
+  }
+
+  template <typename Fn>
+  static Fn*& HeapPtr_(void* storage) {
+    return *std::launder(static_cast<Fn**>(storage));
+  }
+
+  template <typename Fn>
+  static constexpr Ops kInlineOps = {
+      [](void* s) { (*InlinePtr_<Fn>(s))(); },
+      [](void* dst, void* src) noexcept {
+        Fn* from = InlinePtr_<Fn>(src);
+        ::new (dst) Fn(std::move(*from));
+        from->~Fn();
+      },
+      [](void* s) noexcept { InlinePtr_<Fn>(s)->~Fn(); },
+      true};
+
+  template <typename Fn>
+  static constexpr Ops kHeapOps = {
+      [](void* s) { (*HeapPtr_<Fn>(s))(); },
+      [](void* dst, void* src) noexcept {
+        ::new (dst) Fn*(HeapPtr_<Fn>(src));
+      },
+      [](void* s) noexcept { delete HeapPtr_<Fn>(s); },
+      false};
+
+  void MoveFrom_(Task& other) noexcept {
+    if (other.ops_ != nullptr) {
+      other.ops_->move(storage_, other.storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void Reset_() noexcept {
+    if (ops_ != nullptr) {
+      ops_->destroy(storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+  const Ops* ops_ = nullptr;
+};
+
+// 代替 std::bind 把参数绑定到 f 上, 参数以左值传给 f, 和 bind 的语义一致
+template <typename F, typename... Args>
+auto BindArgs(F&& f, Args&&... args) {
+  if constexpr (sizeof...(Args) == 0) {
+    return std::forward<F>(f);
+  } else {
+    return [f = std::forward<F>(f),
+            args = std::make_tuple(std::forward<Args>(args)...)]() mutable
+           -> decltype(auto) { return std::apply(f, args); };
+  }
+}
+
+}  // namespace ctx
@@ -2,11 +2,25 @@
 
 namespace ctx {
 
+thread_local ThreadPool* ThreadPool::current_pool_ = nullptr;
+thread_local uint32_t ThreadPool::current_index_ = 0;
+
+ThreadPool::~ThreadPool() {
+  Stop();
+  // Stop 之后仍可能有并发的 RunTask 放进了注入队列
+  DrainTasks_();
+}
+
 void ThreadPool::Start() {
   if (is_closed_.exchange(false)) {
     uint32_t thread_counts = thread_counts_.load();
+    workers_.clear();
     for (uint32_t i = 0; i < thread_counts; i++) {
-      AddThread_();
+      workers_.emplace_back(std::make_unique<Worker>());
+    }
+    // 队列全部建好之后再启动线程, 窃取时会遍历 workers_
+    for (uint32_t i = 0; i < thread_counts; i++) {
+      workers_[i]->thread = std::thread([this, i]() { WorkerLoop_(i); });
     }
   }
 }
@@ -15,31 +29,152 @@ void ThreadPool::Stop() {
   if (is_closed_.exchange(true)) {
     return;
   }
-  tasks_cv_.notify_all();
-  workers_.clear();
-}
-
-void ThreadPool::AddThread_() {
-  // 线程所执行的函数
-  auto func = [this]() {
-    while (true) {
-      Task task;
-      {
-        std::unique_lock<std::mutex> lock(tasks_mutex_);
-        tasks_cv_.wait(
-            lock, [this]() { return !tasks_.empty() || is_closed_.load(); });
-        if (is_closed_.load()) {
-          break;
-        }
-        task = std::move(tasks_.front());
-        tasks_.pop();
-      }
+  {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cv_.notify_all();
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+  DrainTasks_();
+}
+
+void ThreadPool::Submit_(Task task) {
+  if (current_pool_ == this && workers_.size() > 1) {
+    workers_[current_index_]->deque.Push(new Task(std::move(task)));
+  } else {
+    std::lock_guard<std::mutex> lock(injected_mutex_);
+    injected_.push_back(std::move(task));
+    injected_size_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // 和 Park_ 中的 sleeping_ 自增配对, 保证不会漏掉唤醒
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed) > 0) {
+    WakeOne_();
+  }
+}
+
+void ThreadPool::WorkerLoop_(uint32_t index) {
+  current_pool_ = this;
+  current_index_ = index;
+
+  uint64_t tick = 0;
+  int idle_rounds = 0;
+  Task task;
+  while (!is_closed_.load(std::memory_order_acquire)) {
+    if (FindTask_(index, tick, task)) {
       task();
+      task = nullptr;
+      tick++;
+      idle_rounds = 0;
+      continue;
+    }
+    if (++idle_rounds < kSpinRounds) {
+      std::this_thread::yield();
+      continue;
+    }
+    Park_();
+    idle_rounds = 0;
+  }
+
+  current_pool_ = nullptr;
+}
+
+bool ThreadPool::FindTask_(uint32_t index, uint64_t tick, Task& task) {
+  if (tick % kInjectCheckInterval == kInjectCheckInterval - 1 &&
+      PopInjected_(task)) {
+    return true;
+  }
+  Task* local = workers_[index]->deque.Pop();
+  if (local == nullptr) {
+    if (PopInjected_(task)) {
+      return true;
     }
-  };
+    local = Steal_(index);
+  }
+  if (local == nullptr) {
+    return false;
+  }
+  task = std::move(*local);
+  delete local;
+  return true;
+}
 
-  ThreadInfoPtr thread_ptr = std::make_shared<ThreadInfo>();
-  thread_ptr->ptr = std::make_shared<std::thread>(func);
-  workers_.emplace_back(std::move(thread_ptr));
+bool ThreadPool::PopInjected_(Task& task) {
+  if (injected_size_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(injected_mutex_);
+  if (injected_.empty()) {
+    return false;
+  }
+  task = std::move(injected_.front());
+  injected_.pop_front();
+  injected_size_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+Task* ThreadPool::Steal_(uint32_t index) {
+  size_t count = workers_.size();
+  for (size_t i = 1; i < count; i++) {
+    Worker& victim = *workers_[(index + i) % count];
+    if (victim.deque.Empty()) {
+      continue;
+    }
+    Task* task = victim.deque.Steal();
+    if (task != nullptr) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+bool ThreadPool::HasWork_() const {
+  if (injected_size_.load(std::memory_order_relaxed) > 0) {
+    return true;
+  }
+  for (const auto& worker : workers_) {
+    if (!worker->deque.Empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::Park_() {
+  std::unique_lock<std::mutex> lock(park_mutex_);
+  sleeping_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (HasWork_() || is_closed_.load()) {
+    sleeping_.fetch_sub(1, std::memory_order_relaxed);
+    return;
+  }
+  park_cv_.wait(lock,
+                [this]() { return wake_signals_ > 0 || is_closed_.load(); });
+  if (wake_signals_ > 0) {
+    wake_signals_--;
+  }
+  sleeping_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::WakeOne_() {
+  std::lock_guard<std::mutex> lock(park_mutex_);
+  if (wake_signals_ < sleeping_.load(std::memory_order_relaxed)) {
+    wake_signals_++;
+    park_cv_.notify_one();
+  }
+}
+
+void ThreadPool::DrainTasks_() {
+  for (auto& worker : workers_) {
+    while (Task* task = worker->deque.Pop()) {
+      delete task;
+    }
+  }
+  std::lock_guard<std::mutex> lock(injected_mutex_);
+  injected_.clear();
+  injected_size_.store(0, std::memory_order_relaxed);
 }
 }  // namespace ctx
\ No newline at end of file
@@ -1,16 +1,23 @@
 #pragma once
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <functional>
+#include <deque>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
+#include "task.h"
+#include "work_stealing_deque.h"
+
 namespace ctx {
 
+// 工作窃取线程池
+// 每个工作线程有自己的 Chase-Lev 队列, 工作线程内部提交的任务放进自己的队列;
+// 外部线程提交的任务放进全局注入队列. 空闲线程先自旋窃取, 一段时间没有任务再休眠
+// 只有一个线程时所有任务都走注入队列, 保证严格的 FIFO 顺序 (strand 依赖这一点)
 class ThreadPool {
  public:
   explicit ThreadPool(uint32_t thread_counts)
@@ -18,7 +25,7 @@ class ThreadPool {
     Start();
   }
 
-  ~ThreadPool() { Stop(); }
+  ~ThreadPool();
 
   ThreadPool(const ThreadPool&) = delete;
   ThreadPool& operator=(const ThreadPool&) = delete;
@@ -32,12 +39,7 @@ class ThreadPool {
     if (is_closed_.load()) {
       return;
     }
-    Task task = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-    {
-      std::lock_guard<std::mutex> lock(tasks_mutex_);
-      tasks_.emplace(std::move(task));
-    }
-    tasks_cv_.notify_one();
+    Submit_(Task(BindArgs(std::forward<F>(f), std::forward<Args>(args)...)));
   }
 
   template <typename F, typename... Args>
@@ -47,45 +49,58 @@ class ThreadPool {
       return std::future<std::invoke_result_t<F, Args...>>();
     }
     using return_type = std::invoke_result_t<F, Args...>;
-    auto task_pkg = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-    auto result = task_pkg->get_future();
-    Task task = [task_pkg]() { (*task_pkg)(); };
-    {
-      std::lock_guard<std::mutex> lock(tasks_mutex_);
-      tasks_.emplace(std::move(task));
-    }
-    tasks_cv_.notify_one();
+    std::packaged_task<return_type()> task_pkg(
+        BindArgs(std::forward<F>(f), std::forward<Args>(args)...));
+    auto result = task_pkg.get_future();
+    Submit_(Task(std::move(task_pkg)));
     return result;
   }
 
- private:
-  void AddThread_();
+  uint32_t GetThreadCounts() const { return thread_counts_.load(); }
 
  private:
-  using ThreadPtr = std::shared_ptr<std::thread>;
-  struct ThreadInfo {
-    ThreadInfo() = default;
-    ~ThreadInfo() {
-      if (ptr && ptr->joinable()) {
-        ptr->join();
-      }
-    }
-
-    ThreadPtr ptr;
+  struct Worker {
+    std::thread thread;
+    WorkStealingDeque<Task*> deque;
   };
 
-  using ThreadInfoPtr = std::shared_ptr<ThreadInfo>;
-  using Task = std::function<void()>;
+  void Submit_(Task task);
+  void WorkerLoop_(uint32_t index);
+
+  // 找到任务返回 true, 任务通过 task 带出
+  bool FindTask_(uint32_t index, uint64_t tick, Task& task);
+  bool PopInjected_(Task& task);
+  Task* Steal_(uint32_t index);
+  bool HasWork_() const;
+
+  void Park_();
+  void WakeOne_();
+
+  // 线程全部退出后调用, 释放没来得及执行的任务
+  void DrainTasks_();
 
  private:
-  std::vector<ThreadInfoPtr> workers_;
-  std::queue<Task> tasks_;
+  // 自旋多少轮找不到任务后休眠
+  static constexpr int kSpinRounds = 64;
+  // 每执行这么多个本地任务检查一次注入队列, 防止外部任务饿死
+  static constexpr uint64_t kInjectCheckInterval = 61;
 
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_cv_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::deque<Task> injected_;  // 外部提交的任务按值存放, 不再单独申请节点
+  std::mutex injected_mutex_;
+  std::atomic<size_t> injected_size_{0};
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+  std::atomic<uint32_t> sleeping_{0};
+  uint32_t wake_signals_{0};  // 受 park_mutex_ 保护
 
   std::atomic<uint32_t> thread_counts_;
   std::atomic<bool> is_closed_;
+
+  // 当前线程所属的线程池和下标, 用来判断是否是工作线程内部提交
+  static thread_local ThreadPool* current_pool_;
+  static thread_local uint32_t current_index_;
 };
 }  // namespace ctx
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "timing_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ctx {
+
+TimingWheel::TimingWheel(uint64_t start_tick) : current_tick_(start_tick) {
+  heads_.fill(kNil);
+}
+
+TimerId TimingWheel::Add(uint64_t expire_tick, Task task) {
+  int32_t index = AllocNode_();
+  Node& node = nodes_[index];
+  node.task = std::move(task);
+  node.expire_tick = std::max(expire_tick, current_tick_ + 1);
+  Insert_(index);
+  return (static_cast<TimerId>(node.generation) << 32) | static_cast<uint32_t>(index);
+}
+
+TimerId TimingWheel::AddRepeated(uint64_t expire_tick, uint64_t interval,
+                                 uint64_t counts, Task task) {
+  if (counts == 0) {
+    return 0;
+  }
+  int32_t index = AllocNode_();
+  Node& node = nodes_[index];
+  node.repeated_task = std::make_shared<Task>(std::move(task));
+  node.expire_tick = std::max(expire_tick, current_tick_ + 1);
+  node.interval = std::max<uint64_t>(interval, 1);
+  node.remaining = counts;
+  Insert_(index);
+  return (static_cast<TimerId>(node.generation) << 32) | static_cast<uint32_t>(index);
+}
+
+bool TimingWheel::Cancel(TimerId id) {
+  uint32_t index = IndexOf_(id);
+  if (index >= nodes_.size()) {
+    return false;
+  }
+  Node& node = nodes_[index];
+  if (node.generation != GenerationOf_(id) || node.slot == kNil) {
+    return false;
+  }
+  Unlink_(static_cast<int32_t>(index));
+  FreeNode_(static_cast<int32_t>(index));
+  return true;
+}
+
+void TimingWheel::Advance(uint64_t now_tick, std::vector<Task>* expired) {
+  if (size_ == 0) {
+    current_tick_ = std::max(current_tick_, now_tick);
+    return;
+  }
+  while (current_tick_ < now_tick) {
+    uint64_t t = ++current_tick_;
+    size_t slot0 = t & (kLevel0Size - 1);
+    if (slot0 == 0) {
+      // 第 0 层转完一圈, 把上层对应槽里的定时器降级, 先处理高层
+      size_t slot1 = (t >> kLevel0Bits) & (kLevelSize - 1);
+      size_t slot2 = (t >> (kLevel0Bits + kLevelBits)) & (kLevelSize - 1);
+      size_t slot3 = (t >> (kLevel0Bits + 2 * kLevelBits)) & (kLevelSize - 1);
+      if (slot1 == 0) {
+        if (slot2 == 0) {
+          Cascade_(3, slot3);
+        }
+        Cascade_(2, slot2);
+      }
+      Cascade_(1, slot1);
+    }
+    Expire_(slot0, expired);
+    if (size_ == 0) {
+      current_tick_ = now_tick;
+      break;
+    }
+  }
+}
+
+uint64_t TimingWheel::NextExpiry() const {
+  if (size_ == 0) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  // 上层的定时器最早在第 0 层转完这一圈时降级
+  uint64_t boundary = ((current_tick_ >> kLevel0Bits) + 1) << kLevel0Bits;
+  for (uint64_t t = current_tick_ + 1; t < boundary; t++) {
+    if (heads_[t & (kLevel0Size - 1)] != kNil) {
+      return t;
+    }
+  }
+  return boundary;
+}
+
+void TimingWheel::Clear() {
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    if (nodes_[i].slot != kNil) {
+      FreeNode_(static_cast<int32_t>(i));
+    }
+  }
+  heads_.fill(kNil);
+}
+
+int32_t TimingWheel::AllocNode_() {
+  int32_t index;
+  if (!free_nodes_.empty()) {
+    index = free_nodes_.back();
+    free_nodes_.pop_back();
+  } else {
+    index = static_cast<int32_t>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  size_++;
+  return index;
+}
+
+void TimingWheel::FreeNode_(int32_t index) {
+  Node& node = nodes_[index];
+  node.task = nullptr;
+  node.repeated_task.reset();
+  node.prev = kNil;
+  node.next = kNil;
+  node.slot = kNil;
+  // 代数变化后旧的 TimerId 失效, 跳过 0 保证 TimerId 不为 0
+  if (++node.generation == 0) {
+    node.generation = 1;
+  }
+  free_nodes_.push_back(index);
+  size_--;
+}
+
+void TimingWheel::Insert_(int32_t index) {
+  Node& node = nodes_[index];
+  uint64_t expire = node.expire_tick;
+  uint64_t diff = expire - current_tick_;
+  int32_t slot;
+  if (diff < kLevel0Size) {
+    slot = SlotIndex_(0, expire & (kLevel0Size - 1));
+  } else {
+    if (diff >= kMaxSpan) {
+      // 超出时间轮范围, 先放在最高层最远的槽, 降级时重新计算
+      expire = current_tick_ + kMaxSpan - 1;
+      diff = kMaxSpan - 1;
+    }
+    int level = 1;
+    int shift = kLevel0Bits;
+    while (diff >= (uint64_t(1) << (shift + kLevelBits))) {
+      level++;
+      shift += kLevelBits;
+    }
+    slot = SlotIndex_(level, (expire >> shift) & (kLevelSize - 1));
+  }
+
+  node.slot = slot;
+  node.prev = kNil;
+  node.next = heads_[slot];
+  if (node.next != kNil) {
+    nodes_[node.next].prev = index;
+  }
+  heads_[slot] = index;
+}
+
+void TimingWheel::Unlink_(int32_t index) {
+  Node& node = nodes_[index];
+  if (node.prev != kNil) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    heads_[node.slot] = node.next;
+  }
+  if (node.next != kNil) {
+    nodes_[node.next].prev = node.prev;
+  }
+  node.prev = kNil;
+  node.next = kNil;
+}
+
+void TimingWheel::Cascade_(int level, size_t slot) {
+  int32_t slot_index = SlotIndex_(level, slot);
+  int32_t index = heads_[slot_index];
+  heads_[slot_index] = kNil;
+  while (index != kNil) {
+    int32_t next = nodes_[index].next;
+    Insert_(index);
+    index = next;
+  }
+}
+
+void TimingWheel::Expire_(size_t slot, std::vector<Task>* expired) {
+  int32_t slot_index = SlotIndex_(0, slot);
+  int32_t index = heads_[slot_index];
+  heads_[slot_index] = kNil;
+  while (index != kNil) {
+    Node& node = nodes_[index];
+    int32_t next = node.next;
+    node.prev = kNil;
+    node.next = kNil;
+    if (node.repeated_task) {
+      expired->emplace_back([task = node.repeated_task]() { (*task)(); });
+      if (--node.remaining > 0) {
+        node.expire_tick = std::max(node.expire_tick + node.interval, current_tick_ + 1);
+        Insert_(index);
+      } else {
+        FreeNode_(index);
+      }
+    } else {
+      expired->push_back(std::move(node.task));
+      FreeNode_(index);
+    }
+    index = next;
+  }
+}
+
+}  // namespace ctx
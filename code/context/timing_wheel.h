@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "task.h"
+
+namespace ctx {
+
+using TimerId = uint64_t;  // 0 表示无效
+
+// 分层哈希时间轮, 时间以 tick 为单位, 由调用者决定 tick 的长度
+// 第 0 层 256 个槽, 每个槽 1 tick; 往上 3 层各 64 个槽, 每层的槽宽是下一层的整圈,
+// 共覆盖 2^26 个 tick, 更远的定时器先放在最高层, 降级时再重新计算
+// 插入和取消都是 O(1); 定时器节点放在数组里, TimerId 是下标加复用代数, 取消后立即释放任务
+// 不是线程安全的, 由 ExecutorTimer 加锁使用
+class TimingWheel {
+ public:
+  explicit TimingWheel(uint64_t start_tick = 0);
+
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  // 在 expire_tick 执行一次, expire_tick 不晚于当前 tick 时在下一个 tick 执行
+  TimerId Add(uint64_t expire_tick, Task task);
+
+  // 第一次在 expire_tick 执行, 之后每隔 interval 个 tick 执行一次, 共执行 counts 次
+  // counts 为 0 时不会执行, 返回 0
+  TimerId AddRepeated(uint64_t expire_tick, uint64_t interval, uint64_t counts,
+                      Task task);
+
+  // 定时器已经执行完或者已取消返回 false
+  bool Cancel(TimerId id);
+
+  // 推进到 now_tick, 期间到期的任务按到期顺序追加到 expired
+  void Advance(uint64_t now_tick, std::vector<Task>* expired);
+
+  // 下一个可能有定时器到期的 tick (可能提前, 不会推后), 没有定时器返回 UINT64_MAX
+  uint64_t NextExpiry() const;
+
+  uint64_t CurrentTick() const { return current_tick_; }
+  size_t Size() const { return size_; }
+
+  // 释放所有定时器
+  void Clear();
+
+ private:
+  static constexpr int kLevel0Bits = 8;
+  static constexpr int kLevelBits = 6;
+  static constexpr int kLevels = 4;
+  static constexpr size_t kLevel0Size = size_t(1) << kLevel0Bits;
+  static constexpr size_t kLevelSize = size_t(1) << kLevelBits;
+  static constexpr uint64_t kMaxSpan =
+      uint64_t(1) << (kLevel0Bits + (kLevels - 1) * kLevelBits);
+  static constexpr int32_t kNil = -1;
+
+  struct Node {
+    Task task;
+    std::shared_ptr<Task> repeated_task;  // 重复任务每次执行时共享同一个对象
+    uint64_t expire_tick = 0;
+    uint64_t interval = 0;
+    uint64_t remaining = 0;
+    int32_t prev = kNil;
+    int32_t next = kNil;
+    uint32_t generation = 1;
+    int32_t slot = kNil;  // 所在槽的全局下标, kNil 表示空闲
+  };
+
+  int32_t AllocNode_();
+  void FreeNode_(int32_t index);
+  void Insert_(int32_t index);
+  void Unlink_(int32_t index);
+  void Cascade_(int level, size_t slot);
+  void Expire_(size_t slot, std::vector<Task>* expired);
+
+  static int32_t SlotIndex_(int level, size_t slot) {
+    return level == 0 ? static_cast<int32_t>(slot)
+                      : static_cast<int32_t>(kLevel0Size +
+                                             (level - 1) * kLevelSize + slot);
+  }
+  static uint32_t IndexOf_(TimerId id) {
+    return static_cast<uint32_t>(id & 0xffffffff);
+  }
+  static uint32_t GenerationOf_(TimerId id) {
+    return static_cast<uint32_t>(id >> 32);
+  }
+
+  uint64_t current_tick_;
+  size_t size_ = 0;
+  std::vector<Node> nodes_;
+  std::vector<int32_t> free_nodes_;
+  // 所有层的槽头放在一个数组里: [0, 256) 是第 0 层, 之后每 64 个一层
+  std::array<int32_t, kLevel0Size + (kLevels - 1) * kLevelSize> heads_;
+};
+
+}  // namespace ctx
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ctx {
+
+// Chase-Lev 工作窃取双端队列 (按 Le et al. 2013 的弱内存序版本实现)
+// 只有所属线程可以 Push/Pop (从 bottom 端, LIFO), 其他线程通过 Steal 从 top 端取 (FIFO)
+// T 需要是指针这类可以放进 std::atomic 的类型, 空值用 nullptr 表示
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(int64_t capacity = 256)
+      : array_(new Array(capacity)) {}
+
+  ~WorkStealingDeque() { delete array_.load(std::memory_order_relaxed); }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // 只能在所属线程调用
+  void Push(T item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      // 旧数组可能还在被窃取者读取, 留到析构时再释放
+      retired_.emplace_back(a);
+      a = a->Grow(b, t);
+      array_.store(a, std::memory_order_release);
+    }
+    a->Put(b, item);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  // 只能在所属线程调用, 队列为空返回 nullptr
+  T Pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T item = a->Get(b);
+    if (t == b) {
+      // 只剩最后一个元素, 和窃取者竞争
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // 任意线程调用, 队列为空或竞争失败返回 nullptr
+  T Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    Array* a = array_.load(std::memory_order_acquire);
+    T item = a->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // 近似值, 只用于判断是否值得去窃取
+  bool Empty() const {
+    return bottom_.load(std::memory_order_relaxed) <=
+           top_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Array {
+    explicit Array(int64_t cap)
+        : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+    T Get(int64_t i) const {
+      return slots[i & mask].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, T item) {
+      slots[i & mask].store(item, std::memory_order_relaxed);
+    }
+    Array* Grow(int64_t b, int64_t t) const {
+      Array* a = new Array(capacity * 2);
+      for (int64_t i = t; i < b; i++) {
+        a->Put(i, Get(i));
+      }
+      return a;
+    }
+
+    const int64_t capacity;  // 必须是 2 的幂
+    const int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  alignas(64) std::atomic<Array*> array_;
+  std::vector<std::unique_ptr<Array>> retired_;
+};
+
+}  // namespace ctx
@@ -0,0 +1,175 @@
+#include "accesslog.h"
+#include "logging/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace http {
+
+namespace {
+uint32_t ToMicros(uint64_t ns) {
+    return static_cast<uint32_t>(std::min<uint64_t>(ns / 1000, std::numeric_limits<uint32_t>::max()));
+}
+}
+
+std::atomic<uint64_t> AccessLog::next_instance_id_{1};
+thread_local AccessLog::Ring* AccessLog::tls_ring_ = nullptr;
+thread_local uint64_t AccessLog::tls_owner_id_ = 0;
+
+AccessMethod ToAccessMethod(std::string_view method) {
+    if (method == "GET") return AccessMethod::kGet;
+    if (method == "POST") return AccessMethod::kPost;
+    if (method == "PUT") return AccessMethod::kPut;
+    if (method == "DELETE") return AccessMethod::kDelete;
+    if (method == "HEAD") return AccessMethod::kHead;
+    if (method == "OPTIONS") return AccessMethod::kOptions;
+    return AccessMethod::kOther;
+}
+
+std::string_view AccessMethodName(AccessMethod method) {
+    switch (method) {
+        case AccessMethod::kGet: return "GET";
+        case AccessMethod::kPost: return "POST";
+        case AccessMethod::kPut: return "PUT";
+        case AccessMethod::kDelete: return "DELETE";
+        case AccessMethod::kHead: return "HEAD";
+        case AccessMethod::kOptions: return "OPTIONS";
+        default: return "OTHER";
+    }
+}
+
+AccessLog::~AccessLog() {
+    for (auto& ring : rings_) {
+        munmap(ring->header, ring->mapped_size);
+        close(ring->fd);
+    }
+}
+
+void AccessLog::RegisterPath(std::string path) {
+    if (path_ids_.count(path) > 0 || paths_.size() >= std::numeric_limits<uint16_t>::max()) {
+        return;
+    }
+    paths_.push_back(std::move(path));
+    path_ids_.emplace(paths_.back(), static_cast<uint16_t>(paths_.size()));
+}
+
+bool AccessLog::OpenBinary(const std::string& dir, size_t ring_records) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::ofstream file(std::filesystem::path(dir) / "paths.tsv", std::ios::trunc);
+    for (size_t i = 0; i < paths_.size(); i++) {
+        file << (i + 1) << '\t' << paths_[i] << '\n';
+    }
+    if (!file) {
+        LOG_ERROR("Failed to write access log path table in {}", dir);
+        return false;
+    }
+    dir_ = dir;
+    ring_records_ = std::max<size_t>(ring_records, 1);
+    binary_ = true;
+    return true;
+}
+
+void AccessLog::Write(const AccessEntry& entry) {
+    if (binary_) {
+        WriteBinary_(entry);
+    } else {
+        WriteText_(entry);
+    }
+}
+
+void AccessLog::WriteText_(const AccessEntry& entry) {
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - entry.start).count();
+    LOG_INFO("access {} {} {} {}B {}us request={} conn={}",
+             entry.method, entry.path, entry.status, entry.bytes, total_us, entry.request_id, entry.conn_id);
+}
+
+void AccessLog::WriteBinary_(const AccessEntry& entry) {
+    Ring* ring = tls_owner_id_ == instance_id_ ? tls_ring_ : CreateLocalRing_();
+    if (ring == nullptr) {
+        return;
+    }
+    auto steady_now = std::chrono::steady_clock::now();
+    timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+
+    uint64_t head = ring->header->head;
+    AccessRecord& record = ring->records[head % ring_records_];
+    record.timestamp_ns = static_cast<uint64_t>(wall.tv_sec) * 1000000000ull + wall.tv_nsec;
+    record.request_id = entry.request_id;
+    record.conn_id = entry.conn_id;
+    record.bytes = entry.bytes;
+    record.total_us = ToMicros(std::chrono::duration_cast<std::chrono::nanoseconds>(steady_now - entry.start).count());
+    record.parse_us = ToMicros(entry.parse_ns);
+    record.route_us = ToMicros(entry.route_ns);
+    record.queue_us = ToMicros(entry.queue_ns);
+    record.inference_us = ToMicros(entry.inference_ns);
+    record.status = static_cast<uint16_t>(entry.status);
+    record.path_id = PathId_(entry.path);
+    record.method = static_cast<uint8_t>(ToAccessMethod(entry.method));
+    std::memset(record.reserved, 0, sizeof(record.reserved));
+    // 解码工具读到的 head 之前的记录都是完整的 (同一台机器上的页缓存, 不需要 msync)
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->header->head = head + 1;
+}
+
+AccessLog::Ring* AccessLog::CreateLocalRing_() {
+    tls_owner_id_ = instance_id_;
+    tls_ring_ = nullptr;
+
+    int tid = static_cast<int>(::syscall(SYS_gettid));
+    std::string path = (std::filesystem::path(dir_) / fmt::format("access-{}-{}.bin", ::getpid(), tid)).string();
+    size_t mapped_size = sizeof(AccessFileHeader) + ring_records_ * sizeof(AccessRecord);
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create access log {}: {}", path, std::strerror(errno));
+        return nullptr;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(mapped_size)) != 0) {
+        LOG_ERROR("Failed to size access log {}: {}", path, std::strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+    void* addr = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("Failed to map access log {}: {}", path, std::strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto ring = std::make_unique<Ring>();
+    ring->fd = fd;
+    ring->mapped_size = mapped_size;
+    ring->header = static_cast<AccessFileHeader*>(addr);
+    ring->records = reinterpret_cast<AccessRecord*>(static_cast<char*>(addr) + sizeof(AccessFileHeader));
+    // ftruncate 出来的文件全是 0, 只需要填头部
+    std::memcpy(ring->header->magic, AccessFileHeader::kMagic, sizeof(AccessFileHeader::kMagic));
+    ring->header->version = AccessFileHeader::kVersion;
+    ring->header->record_size = sizeof(AccessRecord);
+    ring->header->capacity = ring_records_;
+    ring->header->head = 0;
+    ring->header->pid = ::getpid();
+    ring->header->tid = tid;
+
+    tls_ring_ = ring.get();
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(std::move(ring));
+    LOG_INFO("Access log ring {} ({} records)", path, ring_records_);
+    return tls_ring_;
+}
+
+uint16_t AccessLog::PathId_(std::string_view path) const {
+    auto it = path_ids_.find(path);
+    return it == path_ids_.end() ? 0 : it->second;
+}
+
+} // namespace http
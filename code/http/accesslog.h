@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace http {
+
+// 一个已完成请求的访问记录
+struct AccessEntry {
+    uint64_t request_id;
+    uint64_t conn_id;
+    std::string_view method;
+    std::string_view path;
+    int status;
+    uint64_t bytes;          // 响应的字节数, 含状态行和头部
+    std::chrono::steady_clock::time_point start; // 开始解析请求的时间
+    uint64_t parse_ns;
+    uint64_t route_ns;       // 路由和处理函数的同步部分
+    uint64_t queue_ns{0};    // 推理请求在调度队列里的等待时间
+    uint64_t inference_ns{0};
+};
+
+// ====== 二进制访问日志的文件格式, 写入端和离线解码工具共用 ======
+
+// 每个写日志的线程一个文件 access-<pid>-<tid>.bin: 文件头后面是 capacity 条定长记录组成的环
+// 第 i 条记录 (从 0 数) 在 i % capacity 号槽位, head 是写过的总条数
+// 另有 paths.tsv 保存路径编号, 每行 "<id>\t<path>", 0 号是没有注册的路径
+struct AccessFileHeader {
+    static constexpr char kMagic[8] = {'B', 'A', 'A', 'C', 'C', 'L', 'O', 'G'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint64_t head;     // 写完一条记录后才增加
+    int32_t pid;
+    int32_t tid;
+    uint8_t reserved[24];
+};
+static_assert(sizeof(AccessFileHeader) == 64, "AccessFileHeader must stay 64 bytes");
+
+enum class AccessMethod : uint8_t { kOther, kGet, kPost, kPut, kDelete, kHead, kOptions };
+
+struct AccessRecord {
+    uint64_t timestamp_ns;   // 发出响应的时间, CLOCK_REALTIME
+    uint64_t request_id;
+    uint64_t conn_id;
+    uint64_t bytes;
+    uint32_t total_us;       // 从开始解析到发出响应
+    uint32_t parse_us;
+    uint32_t route_us;
+    uint32_t queue_us;
+    uint32_t inference_us;
+    uint16_t status;
+    uint16_t path_id;
+    uint8_t method;          // AccessMethod
+    uint8_t reserved[7];
+};
+static_assert(sizeof(AccessRecord) == 64, "AccessRecord must stay 64 bytes");
+
+AccessMethod ToAccessMethod(std::string_view method);
+std::string_view AccessMethodName(AccessMethod method);
+
+// 采样访问日志: 每 N 个完成的请求记一条
+// 文本模式写一行 LOG_INFO; 二进制模式把定长记录追加到本线程的 mmap 环形文件, 请求路径上没有任何格式化
+class AccessLog {
+public:
+    static constexpr size_t kDefaultRingRecords = 1 << 18; // 每个线程 16MB
+
+    AccessLog() : instance_id_(next_instance_id_.fetch_add(1, std::memory_order_relaxed)) {}
+    ~AccessLog();
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    // 0 表示关闭
+    void SetSampleInterval(uint32_t interval) { interval_.store(interval, std::memory_order_relaxed); }
+
+    // 请求完成时调用, 决定这个请求是否记录; 异步响应的请求在发出响应时再调用 Write
+    bool ShouldSample() {
+        uint32_t interval = interval_.load(std::memory_order_relaxed);
+        return interval != 0 && counter_.fetch_add(1, std::memory_order_relaxed) % interval == 0;
+    }
+
+    // 二进制记录里用编号代替路径, 必须在 OpenBinary 之前注册完
+    void RegisterPath(std::string path);
+
+    // 切换到二进制模式, 写出路径表; 每个线程的环形文件在第一次 Write 时创建
+    bool OpenBinary(const std::string& dir, size_t ring_records = kDefaultRingRecords);
+
+    void Write(const AccessEntry& entry);
+
+private:
+    struct Ring {
+        int fd{-1};
+        AccessFileHeader* header{nullptr};
+        AccessRecord* records{nullptr};
+        size_t mapped_size{0};
+    };
+
+    void WriteText_(const AccessEntry& entry);
+    void WriteBinary_(const AccessEntry& entry);
+    Ring* CreateLocalRing_();
+    uint16_t PathId_(std::string_view path) const;
+
+private:
+    std::atomic<uint32_t> interval_{0};
+    std::atomic<uint64_t> counter_{0};
+    const uint64_t instance_id_; // 线程缓存用它而不是地址判断属于哪个实例, 地址可能被新实例复用
+
+    std::deque<std::string> paths_; // 1 号开始, deque 保证 path_ids_ 里的 string_view 不失效
+    std::unordered_map<std::string_view, uint16_t> path_ids_;
+
+    bool binary_{false};
+    std::string dir_;
+    size_t ring_records_{kDefaultRingRecords};
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    static std::atomic<uint64_t> next_instance_id_;
+    static thread_local Ring* tls_ring_;
+    static thread_local uint64_t tls_owner_id_;
+};
+
+} // namespace http
@@ -0,0 +1,105 @@
+#include "bodyparser.h"
+#include <array>
+#include <cstdint>
+
+namespace http {
+
+std::optional<std::string> GetMultipartBoundary(std::string_view content_type) {
+  if (content_type.rfind("multipart/form-data", 0) != 0) {
+    return std::nullopt;
+  }
+  constexpr std::string_view kBoundaryKey = "boundary=";
+  auto pos = content_type.find(kBoundaryKey);
+  if (pos == std::string_view::npos) {
+    return std::nullopt;
+  }
+  std::string_view boundary = content_type.substr(pos + kBoundaryKey.size());
+  boundary = boundary.substr(0, boundary.find(';'));
+  if (boundary.size() >= 2 && boundary.front() == '"' && boundary.back() == '"') {
+    boundary = boundary.substr(1, boundary.size() - 2);
+  }
+  if (boundary.empty()) {
+    return std::nullopt;
+  }
+  return std::string(boundary);
+}
+
+bool ParseMultipart(std::string_view body, std::string_view boundary,
+                    std::vector<MultipartPart> *parts) {
+  const std::string delimiter = "--" + std::string(boundary);
+  constexpr std::string_view kHeadersEnd = "\r\n\r\n";
+
+  auto pos = body.find(delimiter);
+  if (pos == std::string_view::npos) {
+    return false;
+  }
+  while (true) {
+    pos += delimiter.size();
+    // "--boundary--" 表示结束
+    if (body.substr(pos, 2) == "--") {
+      return true;
+    }
+    auto headers_end = body.find(kHeadersEnd, pos);
+    if (headers_end == std::string_view::npos) {
+      return false;
+    }
+    size_t data_start = headers_end + kHeadersEnd.size();
+    // 下一个分隔符前面有一个 CRLF, 不属于数据
+    auto next = body.find("\r\n" + delimiter, data_start);
+    if (next == std::string_view::npos) {
+      return false;
+    }
+    size_t headers_start = pos;
+    if (body.substr(headers_start, 2) == "\r\n") {
+      headers_start += 2;
+    }
+    MultipartPart part;
+    part.headers = body.substr(headers_start, headers_end - headers_start);
+    part.data = body.substr(data_start, next - data_start);
+    parts->push_back(part);
+    pos = next + 2;
+  }
+}
+
+namespace {
+constexpr std::array<int8_t, 256> MakeBase64Table() {
+  std::array<int8_t, 256> table{};
+  for (auto &v : table) {
+    v = -1;
+  }
+  constexpr std::string_view kAlphabet =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (size_t i = 0; i < kAlphabet.size(); i++) {
+    table[static_cast<unsigned char>(kAlphabet[i])] = static_cast<int8_t>(i);
+  }
+  return table;
+}
+constexpr auto kBase64Table = MakeBase64Table();
+} // namespace
+
+bool DecodeBase64(std::string_view input, std::vector<unsigned char> *output) {
+  while (!input.empty() && input.back() == '=') {
+    input.remove_suffix(1);
+  }
+  if (input.size() % 4 == 1) {
+    return false;
+  }
+  output->reserve(output->size() + input.size() * 3 / 4);
+  uint32_t acc = 0;
+  int bits = 0;
+  for (char c : input) {
+    int8_t v = kBase64Table[static_cast<unsigned char>(c)];
+    if (v < 0) {
+      return false;
+    }
+    acc = (acc << 6) | static_cast<uint32_t>(v);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      output->push_back(static_cast<unsigned char>((acc >> bits) & 0xFF));
+    }
+  }
+  return true;
+}
+
+} // namespace http
@@ -0,0 +1,25 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+// multipart/form-data 中的一个 part, 都是指向原始 body 的视图
+struct MultipartPart {
+  std::string_view headers; // part 头部, 不含结尾的空行
+  std::string_view data;
+};
+
+// 从 Content-Type 中取出 boundary, 不是 multipart/form-data 或缺少 boundary 时返回 nullopt
+std::optional<std::string> GetMultipartBoundary(std::string_view content_type);
+
+// 把 body 切分成 part, 格式错误返回 false
+bool ParseMultipart(std::string_view body, std::string_view boundary,
+                    std::vector<MultipartPart> *parts);
+
+// 标准 base64 (允许缺省填充), 遇到非法字符返回 false
+bool DecodeBase64(std::string_view input, std::vector<unsigned char> *output);
+
+} // namespace http
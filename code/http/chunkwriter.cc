@@ -0,0 +1,55 @@
+#include "chunkwriter.h"
+
+namespace http {
+
+ChunkWriter::ChunkWriter(net::TcpConnection::Ptr conn, HttpResponse &response,
+                         size_t flush_threshold)
+    : conn_(std::move(conn)), pending_(0), flush_threshold_(flush_threshold) {
+  response.SetChunked(true);
+  net::Buffer header;
+  response.AppendToBuffer(header);
+  conn_->Send(header);
+}
+
+void ChunkWriter::Write(std::string_view data) {
+  if (finished_ || data.empty()) {
+    return;
+  }
+  bytes_written_ += data.size();
+  if (flush_threshold_ == 0) {
+    net::Buffer chunk;
+    HttpResponse::AppendChunk(chunk, data);
+    conn_->Send(chunk);
+    return;
+  }
+  pending_.Append(data);
+  if (pending_.ReadableBytes() >= flush_threshold_) {
+    Flush();
+  }
+}
+
+void ChunkWriter::Flush() {
+  if (finished_ || pending_.ReadableBytes() == 0) {
+    return;
+  }
+  net::Buffer chunk;
+  HttpResponse::AppendChunk(chunk, std::string_view(pending_.Peek(), pending_.ReadableBytes()));
+  pending_.RetrieveAll();
+  conn_->Send(chunk);
+}
+
+void ChunkWriter::Finish() {
+  if (finished_) {
+    return;
+  }
+  net::Buffer chunk;
+  if (pending_.ReadableBytes() > 0) {
+    HttpResponse::AppendChunk(chunk, std::string_view(pending_.Peek(), pending_.ReadableBytes()));
+    pending_.RetrieveAll();
+  }
+  HttpResponse::AppendLastChunk(chunk);
+  conn_->Send(chunk);
+  finished_ = true;
+}
+
+} // namespace http
@@ -0,0 +1,42 @@
+#pragma once
+#include "httpresponse.h"
+#include "net/buffer.h"
+#include "net/tcpconnection.h"
+#include <string_view>
+
+namespace http {
+
+// 以 Transfer-Encoding: chunked 流式发送响应, 处理函数可以边算边发, 不用先把整个 body 拼出来
+// Write 的数据先攒起来, 超过 flush_threshold 字节才作为一个块发出 (0 表示每次 Write 都发)
+// 不是线程安全的, 同一时间只能在一个线程里使用; TcpConnection::Send 本身可以跨线程
+class ChunkWriter {
+public:
+  static constexpr size_t kDefaultFlushThreshold = 0;
+
+  // 立即发送 response 的状态行和头部, response 的 body 被忽略
+  ChunkWriter(net::TcpConnection::Ptr conn, HttpResponse &response,
+              size_t flush_threshold = kDefaultFlushThreshold);
+  // 析构时不会自动 Finish: 没有结束块, 客户端才能知道响应被截断了
+  ~ChunkWriter() = default;
+
+  ChunkWriter(const ChunkWriter &) = delete;
+  ChunkWriter &operator=(const ChunkWriter &) = delete;
+
+  void Write(std::string_view data);
+  // 把攒着的数据作为一个块发出去
+  void Flush();
+  // 发出剩余数据和结束块, 之后的 Write 被忽略
+  void Finish();
+
+  bool IsFinished() const { return finished_; }
+  size_t BytesWritten() const { return bytes_written_; }
+
+private:
+  net::TcpConnection::Ptr conn_;
+  net::Buffer pending_;
+  size_t flush_threshold_;
+  size_t bytes_written_{0};
+  bool finished_{false};
+};
+
+} // namespace http
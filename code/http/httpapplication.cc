@@ -1,15 +1,24 @@
 #include "context/context.h"
+#include "http/bodyparser.h"
+#include "http/chunkwriter.h"
 #include "http/httpcontext.h"
 #include "http/httprequest.h"
 #include "httpapplication.h"
 #include "logging/logger.h"
+#include "metrics/stages.h"
+#include "tracing/tracer.h"
 #include "inference/boneage_inference.h"
 #include "net/eventloop.h"
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <ctime>
 #include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
 
 namespace http {
 
@@ -37,6 +46,192 @@ std::string GetMimeType(const std::string& path) {
     auto it = mime_map.find(ext);
     return (it != mime_map.end()) ? it->second : "application/octet-stream";
 }
+
+// 先看 header, 再看 query 参数
+const std::string* FindHint(const HttpRequest& request, const std::string& header, const std::string& param) {
+    const auto& headers = request.GetHeaders();
+    auto it = headers.find(header);
+    if (it != headers.end()) {
+        return &it->second;
+    }
+    const auto& params = request.GetQueryParams();
+    it = params.find(param);
+    return it != params.end() ? &it->second : nullptr;
+}
+
+// 优先级: X-Priority 或 ?priority=, 取值 interactive / normal / bulk
+// 截止时间: X-Deadline-Ms 或 ?deadline_ms=, 从收到请求开始算的毫秒数, 最多 24 小时
+// 性别: X-Sex 或 ?sex=, 取值 boy / girl, 提供时结果里附带 RUS-CHN 骨龄
+bool ParseInferenceOptions(const HttpRequest& request, inference::BoneAgeInferencer::InferenceTask& task) {
+    if (const std::string* sex = FindHint(request, "x-sex", "sex")) {
+        if (*sex == "boy") {
+            task.sex = BoneInfo::Sex::kBoy;
+        } else if (*sex == "girl") {
+            task.sex = BoneInfo::Sex::kGirl;
+        } else {
+            return false;
+        }
+    }
+    if (const std::string* priority = FindHint(request, "x-priority", "priority")) {
+        if (*priority == "interactive") {
+            task.priority = inference::Priority::kInteractive;
+        } else if (*priority == "normal") {
+            task.priority = inference::Priority::kNormal;
+        } else if (*priority == "bulk") {
+            task.priority = inference::Priority::kBulk;
+        } else {
+            return false;
+        }
+    }
+    if (const std::string* deadline = FindHint(request, "x-deadline-ms", "deadline_ms")) {
+        char* end = nullptr;
+        long long ms = std::strtoll(deadline->c_str(), &end, 10);
+        if (deadline->empty() || *end != '\0' || !inference::DeadlineFromNow(ms, &task.deadline)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Accept 里选 q 值最高的结果格式, 相同时取靠前的; 都不支持时仍然回 JSON
+inference::ResultFormat NegotiateResultFormat(const HttpRequest& request) {
+    const auto& headers = request.GetHeaders();
+    auto it = headers.find("accept");
+    if (it == headers.end()) {
+        return inference::ResultFormat::kJson;
+    }
+    auto format = inference::ResultFormat::kJson;
+    double best_q = 0;
+    std::string_view accept = it->second;
+    while (!accept.empty()) {
+        size_t comma = accept.find(',');
+        std::string_view item = accept.substr(0, comma);
+        accept = comma == std::string_view::npos ? std::string_view() : accept.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view type = item.substr(0, semicolon);
+        double q = 1;
+        if (semicolon != std::string_view::npos) {
+            size_t q_pos = item.find("q=", semicolon);
+            if (q_pos != std::string_view::npos) {
+                q = std::strtod(std::string(item.substr(q_pos + 2)).c_str(), nullptr);
+            }
+        }
+        while (!type.empty() && type.front() == ' ') {
+            type.remove_prefix(1);
+        }
+        while (!type.empty() && type.back() == ' ') {
+            type.remove_suffix(1);
+        }
+
+        inference::ResultFormat candidate;
+        if (type == "application/msgpack" || type == "application/x-msgpack") {
+            candidate = inference::ResultFormat::kMsgPack;
+        } else if (type == "application/cbor") {
+            candidate = inference::ResultFormat::kCbor;
+        } else if (type == "application/json" || type == "application/*" || type == "*/*") {
+            candidate = inference::ResultFormat::kJson;
+        } else {
+            continue;
+        }
+        if (q > best_q) {
+            best_q = q;
+            format = candidate;
+        }
+    }
+    return format;
+}
+
+const char* ResultContentType(inference::ResultFormat format) {
+    switch (format) {
+        case inference::ResultFormat::kMsgPack:
+            return "application/msgpack";
+        case inference::ResultFormat::kCbor:
+            return "application/cbor";
+        default:
+            return "application/json";
+    }
+}
+
+// 批量接口的流类型: NDJSON, 或者一个接一个的 MessagePack / CBOR 对象 (CBOR 按 RFC 8742 是 cbor-seq)
+const char* BatchContentType(inference::ResultFormat format) {
+    switch (format) {
+        case inference::ResultFormat::kMsgPack:
+            return "application/msgpack";
+        case inference::ResultFormat::kCbor:
+            return "application/cbor-seq";
+        default:
+            return "application/x-ndjson";
+    }
+}
+
+// 批量结果的一项: 一行 NDJSON, 或者一个 {index, result | error} 的二进制 map
+std::string FormatBatchLine(size_t index, inference::BoneAgeInferencer::InferenceResult& result,
+                            inference::ResultFormat format) {
+    using Status = inference::BoneAgeInferencer::Status;
+    const char* error = nullptr;
+    if (result.status == Status::kDeadlineExceeded) {
+        error = "deadline exceeded";
+    } else if (result.status == Status::kDecodeFailed) {
+        error = "decode failed";
+    }
+    if (format == inference::ResultFormat::kJson) {
+        if (error) {
+            return fmt::format("{{\"index\": {}, \"error\": \"{}\"}}\n", index, error);
+        }
+        return fmt::format("{{\"index\": {}, \"result\": {}}}\n", index, result.result_str);
+    }
+    inference::BinaryResultWriter writer(format);
+    writer.WriteMapHeader(2);
+    writer.WriteString("index");
+    writer.WriteInt(index);
+    if (error) {
+        writer.WriteString("error");
+        writer.WriteString(error);
+    } else {
+        writer.WriteString("result");
+        writer.WriteEncoded(result.result_str);
+    }
+    return writer.ToString();
+}
+
+uint64_t NanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 异步响应的请求在处理函数里先记下已知的部分, 状态码、字节数和推理耗时在发出响应时补上
+AccessEntry DeferredAccessEntry(const HttpContext& context, const net::TcpConnection::Ptr& conn, std::string_view path) {
+    return AccessEntry{context.request_id, conn->GetId(), "POST", path, 0, 0,
+                       context.start_time, context.parse_ns, NanosSince(context.route_start)};
+}
+
+// 序列化响应并发送, 耗时记为 send 阶段
+void SendResponse(const net::TcpConnection::Ptr& conn, HttpResponse& response) {
+    static auto& send_histogram = metrics::HttpStage("send");
+    metrics::ScopedTimer timer(send_histogram);
+    net::Buffer buf;
+    response.AppendToBuffer(buf);
+    conn->Send(buf);
+}
+
+void SendJson(HttpContext& context, const net::TcpConnection::Ptr& conn, int code, std::string body) {
+    context.response.SetStatusCode(code);
+    context.response.SetBody(std::move(body));
+    context.response.SetContentType("application/json");
+    SendResponse(conn, context.response);
+}
+
+// /predict/batch 一个请求的所有回调共享的状态
+struct BatchState {
+    std::unique_ptr<ChunkWriter> writer; // 入队成功后才创建, 同时发出响应头
+    size_t remaining{0};                 // 还没回来的图片数
+};
+
+// 推理队列满或正在关闭, 让客户端稍后重试
+void SendBusy(HttpContext& context, const net::TcpConnection::Ptr& conn) {
+    context.response.SetHeader("Retry-After", "1");
+    SendJson(context, conn, 503, "{\"error\": \"Inference queue is full, retry later.\"}");
+}
 } // namespace
 
 using namespace net;
@@ -74,6 +269,56 @@ HttpApplication::HttpApplication(InetAddress listen_addr, std::string static_roo
         }
     });
 
+    router_.AddRoute("POST", "/predict/batch", {
+        [this](auto& context, auto& conn, auto& next) {
+            this->ParseBatchBody_(context, conn, next);
+        },
+        [this](auto& context, auto& conn, auto& next) {
+            this->BatchPredictHandler_(context, conn, next);
+        }
+    });
+
+    router_.AddRoute("GET", "/stats/loops", {
+        [this](auto& context, auto& conn, auto& next) {
+            this->LoopStatsHandler_(context, conn, next);
+        }
+    });
+
+    router_.AddRoute("GET", "/stats/accept", {
+        [this](auto& context, auto& conn, auto& next) {
+            this->AcceptStatsHandler_(context, conn, next);
+        }
+    });
+
+    router_.AddRoute("GET", "/stats/inference", {
+        [this](auto& context, auto& conn, auto& next) {
+            this->InferenceStatsHandler_(context, conn, next);
+        }
+    });
+
+    router_.AddRoute("GET", "/metrics", {
+        [this](auto& context, auto& conn, auto& next) {
+            this->MetricsHandler_(context, conn, next);
+        }
+    });
+
+#ifdef BONEAGE_TRACING
+    router_.AddRoute("GET", "/admin/trace", {
+        [this](auto& context, auto& conn, auto& next) {
+            this->TraceHandler_(context, conn, next);
+        }
+    });
+#endif
+
+    METRICS.SetGauge("net_loop_connections", "Open connections on each IO loop.", [this]() {
+        std::vector<metrics::Registry::Sample> samples;
+        auto stats = server_.GetLoopStats();
+        for (size_t i = 0; i < stats.size(); i++) {
+            samples.push_back({{{"loop", std::to_string(i)}}, static_cast<double>(stats[i].connections)});
+        }
+        return samples;
+    });
+
     for (const auto& [web_path, content] : static_file_cache_) {
         router_.AddRoute("GET", web_path, {
             [this](auto& context, auto& conn, auto& next) {
@@ -84,6 +329,13 @@ HttpApplication::HttpApplication(InetAddress listen_addr, std::string static_roo
     }
 }
 
+bool HttpApplication::EnableBinaryAccessLog(const std::string& dir, size_t ring_records) {
+    for (auto& path : router_.GetPaths()) {
+        access_log_.RegisterPath(std::move(path));
+    }
+    return access_log_.OpenBinary(dir, ring_records);
+}
+
 void HttpApplication::Start() {
     server_.Start();
 }
@@ -91,25 +343,64 @@ void HttpApplication::Start() {
 void HttpApplication::OnConnection_(const net::TcpConnection::Ptr& conn) {
     if (conn->IsConnected()) {
         conn->SetContext(HttpContext());
-        LOG_INFO("client {} connected", conn->GetName());
+        LOG_DEBUG("client {} ({}) connected", conn->GetId(), conn->GetPeerAddress().ToIpPort());
     } else {
-        LOG_INFO("client {} quit", conn->GetName());
+        LOG_DEBUG("client {} quit", conn->GetId());
     }
 }
 
 void HttpApplication::OnMessage_(const TcpConnection::Ptr& conn, Buffer& buf) {
     HttpContext* context = std::any_cast<HttpContext>(conn->GetMutableContext());
 
+    static auto& parse_histogram = metrics::HttpStage("parse");
+    static auto& route_histogram = metrics::HttpStage("route");
+    static std::atomic<uint64_t> next_request_id{1};
+
+    // 上一个请求的响应还没发完, 后面的请求留到 CompleteDeferred_ 里处理, 保证流水线请求的响应按顺序
+    if (context->response_pending) {
+        return;
+    }
+
     while (buf.ReadableBytes() > 0) {
-        HttpRequest::HttpCode result = context->request.Parse(buf);
+        if (context->request_id == 0) {
+            context->request_id = next_request_id.fetch_add(1, std::memory_order_relaxed);
+            context->start_time = std::chrono::steady_clock::now();
+        }
+        auto parse_start = std::chrono::steady_clock::now();
+        HttpRequest::HttpCode result;
+        {
+            TRACE_SPAN("http", "parse", context->request_id);
+            result = context->request.Parse(buf);
+        }
+        // 一个请求可能分几次到达, 解析时间累加到请求完整为止
+        context->parse_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - parse_start).count();
 
         if (result == HttpRequest::HttpCode::kGetRequest) {
-            LOG_INFO(context->request.GetPath());
+            parse_histogram.Record(context->parse_ns);
+            LOG_DEBUG("{} {}", context->request.GetMethod(), context->request.GetPath());
+            context->access_sampled = access_log_.ShouldSample();
             context->response.SetKeepAlive(context->request.IsKeepAlive());
             // LOG_INFO("Is keep-alive: {}", context->response.IsKeepAlive());
             // LOG_INFO("HTTP version: {}", context->request.GetVersion());
-            router_.Route(*context, conn);
+            context->route_start = std::chrono::steady_clock::now();
+            {
+                TRACE_SPAN("http", "route", context->request_id);
+                router_.Route(*context, conn);
+            }
+            uint64_t route_ns = NanosSince(context->route_start);
+            route_histogram.Record(route_ns);
+            if (context->access_sampled && !context->deferred) {
+                access_log_.Write({context->request_id, conn->GetId(), context->request.GetMethod(),
+                                   context->request.GetPath(), context->response.GetStatusCode(),
+                                   context->response.GetSerializedSize(), context->start_time, context->parse_ns, route_ns});
+            }
 
+            if (context->deferred) {
+                // 响应由推理回调发送, 关连接 (Connection: close) 也要等它发完
+                context->response_pending = true;
+                conn->StopReading();
+                break;
+            }
             if (context->response.IsKeepAlive()) {
                 context->Reset();
             } else {
@@ -126,86 +417,312 @@ void HttpApplication::OnMessage_(const TcpConnection::Ptr& conn, Buffer& buf) {
     }
 }
 
+void HttpApplication::CompleteDeferred_(const TcpConnection::Ptr& conn) {
+    HttpContext* context = std::any_cast<HttpContext>(conn->GetMutableContext());
+    if (context == nullptr || !context->response_pending) {
+        return;
+    }
+    if (!context->response.IsKeepAlive()) {
+        conn->Shutdown();
+        return;
+    }
+    context->Reset();
+    conn->StartReading();
+    if (conn->GetInputBuffer().ReadableBytes() > 0) {
+        OnMessage_(conn, conn->GetInputBuffer());
+    }
+}
+
 void HttpApplication::ParseMultipartForm_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
     const auto& headers = context.request.GetHeaders();
     auto it = headers.find("content-type");
 
     if (it != headers.end() && it->second.rfind("multipart/form-data", 0) == 0) {
-        std::string boundary_key = "boundary=";
-        auto boundary_pos = it->second.find(boundary_key);
-        if (boundary_pos == std::string::npos) {
+        auto boundary = GetMultipartBoundary(it->second);
+        if (!boundary) {
             LOG_ERROR("Malformed multipart: boundary not found");
             next();
             return;
         }
-        std::string boundary = "--" + it->second.substr(boundary_pos + boundary_key.length());
-
-        const std::string& body = context.request.GetBody();
-        std::string_view body_view(body);
-
-        auto start_pos = body_view.find(boundary);
-        if (start_pos == std::string_view::npos) {
+        std::vector<MultipartPart> parts;
+        if (!ParseMultipart(context.request.GetBody(), *boundary, &parts) || parts.empty()) {
             LOG_ERROR("Malformed multipart: malformed body");
             next();
             return;
         }
 
-        std::string_view headers_end_marker = "\r\n\r\n";
-        auto headers_end_pos = body_view.find(headers_end_marker, start_pos);
-        if (headers_end_pos == std::string_view::npos) {
-            LOG_ERROR("Malformed multipart: part header not found");
-            next();
-            return;
+        if (!context.form) {
+            context.form.emplace();
         }
+        context.form->image_data = std::vector<unsigned char>(parts[0].data.begin(), parts[0].data.end());
+    }
+    next();
+}
 
-        size_t image_data_start = headers_end_pos + headers_end_marker.length();
+// multipart 的每个 part 是一张图; 或者 application/x-ndjson, 每行 {"image": "<base64>"}
+void HttpApplication::ParseBatchBody_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    const auto& headers = context.request.GetHeaders();
+    auto it = headers.find("content-type");
+    if (it == headers.end()) {
+        next();
+        return;
+    }
+    const std::string& body = context.request.GetBody();
+    std::vector<std::vector<unsigned char>> images;
 
-        auto end_pos = body_view.find(boundary, image_data_start);
-        if (end_pos == std::string_view::npos) {
-            LOG_ERROR("Malformed multipart: closing boundary not found");
+    if (auto boundary = GetMultipartBoundary(it->second)) {
+        std::vector<MultipartPart> parts;
+        if (!ParseMultipart(body, *boundary, &parts)) {
+            LOG_ERROR("Malformed multipart: malformed body");
             next();
             return;
         }
-        size_t image_data_end = end_pos - 2;
+        images.reserve(parts.size());
+        for (const auto& part : parts) {
+            images.emplace_back(part.data.begin(), part.data.end());
+        }
+    } else if (it->second.rfind("application/x-ndjson", 0) == 0) {
+        std::string_view rest(body);
+        while (!rest.empty()) {
+            size_t line_end = rest.find('\n');
+            std::string_view line = rest.substr(0, line_end);
+            rest = (line_end == std::string_view::npos) ? std::string_view() : rest.substr(line_end + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.empty()) {
+                continue;
+            }
+            auto object = nlohmann::json::parse(line, nullptr, false);
+            if (object.is_discarded() || !object.is_object() || !object.contains("image") || !object["image"].is_string()) {
+                LOG_ERROR("Malformed ndjson line in batch body");
+                next();
+                return;
+            }
+            std::vector<unsigned char> image;
+            if (!DecodeBase64(object["image"].get_ref<const std::string&>(), &image)) {
+                LOG_ERROR("Malformed base64 image in batch body");
+                next();
+                return;
+            }
+            images.push_back(std::move(image));
+        }
+    }
 
+    if (!images.empty()) {
         if (!context.form) {
             context.form.emplace();
         }
-        context.form->image_data = std::vector<unsigned char>(body_view.substr(image_data_start, image_data_end - image_data_start).begin(),
-                                                              body_view.substr(image_data_start, image_data_end - image_data_start).end());
+        context.form->images = std::move(images);
     }
     next();
 }
 
 void HttpApplication::PredictHandler_(http::HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
     if (!context.form || !context.form->image_data) {
-        context.response.SetStatusCode(400);
-        context.response.SetBody("{\"error\": \"Image not found.\"}");
-        context.response.SetContentType("application/json");
-        net::Buffer buf;
-        context.response.AppendToBuffer(buf);
-        conn->Send(buf);
+        SendJson(context, conn, 400, "{\"error\": \"Image not found.\"}");
         return;
     }
     
     bool keep_alive = context.request.IsKeepAlive();
     
     inference::BoneAgeInferencer::InferenceTask task;
+    if (!ParseInferenceOptions(context.request, task)) {
+        SendJson(context, conn, 400, "{\"error\": \"Invalid priority, deadline or sex.\"}");
+        return;
+    }
+    task.format = NegotiateResultFormat(context.request);
+    task.request_id = context.request_id;
     task.raw_image_data = std::move(*context.form->image_data);
-    task.on_complete = [keep_alive, conn](inference::BoneAgeInferencer::InferenceResult result) {
-        conn->GetLoop()->RunInLoop([keep_alive, conn = std::move(conn), result = std::move(result)]() {
+    std::optional<AccessEntry> access;
+    if (context.access_sampled) {
+        access = DeferredAccessEntry(context, conn, "/predict");
+    }
+    task.on_complete = [this, keep_alive, conn, format = task.format, request_id = task.request_id,
+                        access_log = &access_log_, access](inference::BoneAgeInferencer::InferenceResult result) {
+        TRACE_ASYNC_BEGIN("http", "callback", request_id);
+        conn->GetLoop()->RunInLoop([this, keep_alive, conn = std::move(conn), format, request_id, access_log, access, result = std::move(result)]() mutable {
+            TRACE_ASYNC_END("http", "callback", request_id);
+            TRACE_SPAN("http", "respond", request_id);
             if (conn->IsConnected()) {
                 http::HttpResponse response;
-                response.SetStatusCode(200);
-                response.SetBody(std::move(result.result_str));
-                response.SetContentType("application/json");
-                net::Buffer buf;
-                response.AppendToBuffer(buf);
-                conn->Send(buf);
+                response.SetKeepAlive(keep_alive);
+                // 错误信息始终是 JSON
+                if (result.status == inference::BoneAgeInferencer::Status::kDeadlineExceeded) {
+                    response.SetStatusCode(504);
+                    response.SetBody("{\"error\": \"Deadline exceeded before inference started.\"}");
+                    response.SetContentType("application/json");
+                } else if (result.status == inference::BoneAgeInferencer::Status::kDecodeFailed) {
+                    response.SetStatusCode(400);
+                    response.SetBody("{\"error\": \"Cannot decode image.\"}");
+                    response.SetContentType("application/json");
+                } else {
+                    response.SetStatusCode(200);
+                    response.SetBody(std::move(result.result_str));
+                    response.SetContentType(ResultContentType(format));
+                }
+                SendResponse(conn, response);
+                if (access) {
+                    access->status = response.GetStatusCode();
+                    access->bytes = response.GetSerializedSize();
+                    access->queue_ns = result.queue_ns;
+                    access->inference_ns = result.run_ns;
+                    access_log->Write(*access);
+                }
+                CompleteDeferred_(conn);
             }
         });
     };
-    INFERENCER.PostInference(std::move(task));
+    // 不能在 IO 线程里等队列空出位置; 入队失败时回调不会被调用, 直接在这里回 503
+    if (!INFERENCER.TryPostInference(std::move(task))) {
+        SendBusy(context, conn);
+        return;
+    }
+    context.deferred = true;
+}
+
+// 所有图片作为一组送进调度器, 先回 200 + chunked 响应头, 每张图完成后发一行 NDJSON (或一个二进制对象), 全部完成后发结束块
+void HttpApplication::BatchPredictHandler_(http::HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    if (!context.form || context.form->images.empty()) {
+        SendJson(context, conn, 400, "{\"error\": \"No images found.\"}");
+        return;
+    }
+    auto& images = context.form->images;
+    static_assert(kMaxImagesPerBatch <= inference::BoneAgeInferencer::kMaxRequestQueueSize,
+                  "a batch must fit into the inference queue");
+    if (images.size() > kMaxImagesPerBatch) {
+        SendJson(context, conn, 400, fmt::format("{{\"error\": \"Too many images, at most {} per request.\"}}", kMaxImagesPerBatch));
+        return;
+    }
+
+    inference::BoneAgeInferencer::InferenceTask hints;
+    if (!ParseInferenceOptions(context.request, hints)) {
+        SendJson(context, conn, 400, "{\"error\": \"Invalid priority, deadline or sex.\"}");
+        return;
+    }
+
+    hints.format = NegotiateResultFormat(context.request);
+
+    // 只在 conn 所属的 loop 线程里访问; 回调经 RunInLoop 回到这个线程, 一定在本函数返回之后执行
+    auto batch = std::make_shared<BatchState>();
+    batch->remaining = images.size();
+    // 整个请求一条记录, 排队和推理时间取各张图里最长的
+    std::shared_ptr<AccessEntry> access;
+    if (context.access_sampled) {
+        access = std::make_shared<AccessEntry>(DeferredAccessEntry(context, conn, "/predict/batch"));
+    }
+    std::vector<inference::BoneAgeInferencer::InferenceTask> tasks(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        auto& task = tasks[i];
+        task.sex = hints.sex;
+        task.priority = hints.priority;
+        task.deadline = hints.deadline;
+        task.format = hints.format;
+        task.request_id = context.request_id; // 同一个请求的所有图片共用
+        task.raw_image_data = std::move(images[i]);
+        task.on_complete = [this, conn, batch, i, format = hints.format, request_id = task.request_id,
+                            access_log = &access_log_, access](inference::BoneAgeInferencer::InferenceResult result) {
+            TRACE_ASYNC_BEGIN("http", "callback", request_id);
+            conn->GetLoop()->RunInLoop([this, conn, batch, i, format, request_id, access_log, access, result = std::move(result)]() mutable {
+                TRACE_ASYNC_END("http", "callback", request_id);
+                TRACE_SPAN("http", "respond", request_id);
+                if (!conn->IsConnected()) {
+                    return;
+                }
+                batch->writer->Write(FormatBatchLine(i, result, format));
+                if (access) {
+                    access->queue_ns = std::max(access->queue_ns, result.queue_ns);
+                    access->inference_ns = std::max(access->inference_ns, result.run_ns);
+                }
+                if (--batch->remaining == 0) {
+                    batch->writer->Finish();
+                    if (access) {
+                        access->bytes += batch->writer->BytesWritten();
+                        access_log->Write(*access);
+                    }
+                    CompleteDeferred_(conn);
+                }
+            });
+        };
+    }
+    // 整组一起入队, 不在 IO 线程里等队列空出位置; 失败时还没发过响应头, 可以直接回 503
+    if (!INFERENCER.TryPostInferenceGroup(std::move(tasks))) {
+        SendBusy(context, conn);
+        return;
+    }
+
+    context.response.SetStatusCode(200);
+    context.response.SetContentType(BatchContentType(hints.format));
+    // 每张图的结果单独成块, 客户端能马上看到
+    batch->writer = std::make_unique<ChunkWriter>(conn, context.response);
+    if (access) {
+        access->status = 200;
+        access->bytes = context.response.GetSerializedSize(); // 响应头, 之后加上 body
+    }
+    context.deferred = true;
+}
+
+// 每个 IO 线程的连接数、积压字节和繁忙时间
+void HttpApplication::LoopStatsHandler_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    std::string body = "{\"loops\": [";
+    auto stats = server_.GetLoopStats();
+    for (size_t i = 0; i < stats.size(); i++) {
+        if (i > 0) {
+            body += ", ";
+        }
+        body += fmt::format("{{\"index\": {}, \"connections\": {}, \"pending_bytes\": {}, \"busy_ms\": {}, \"iterations\": {}}}",
+                            i, stats[i].connections, stats[i].pending_bytes, stats[i].busy_ns / 1000000, stats[i].iterations);
+    }
+    body += "]}";
+
+    context.response.SetStatusCode(200);
+    context.response.SetContentType("application/json");
+    context.response.SetBody(std::move(body));
+    SendResponse(conn, context.response);
+}
+
+void HttpApplication::AcceptStatsHandler_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    auto stats = server_.GetAcceptStats();
+    std::string body = fmt::format("{{\"accepting\": {}, \"accepted\": {}, \"rounds\": {}, \"paused\": {}, \"fd_exhausted\": {}, \"accepts_per_sec\": {:.1f}}}",
+                                   stats.accepting, stats.accepted, stats.rounds, stats.paused, stats.fd_exhausted, stats.accepts_per_sec);
+
+    context.response.SetStatusCode(200);
+    context.response.SetContentType("application/json");
+    context.response.SetBody(std::move(body));
+    SendResponse(conn, context.response);
+}
+
+// 每个优先级的排队情况: 积压数、已调度数、过期数、平均/最大排队时间
+void HttpApplication::InferenceStatsHandler_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    static const char* const kClassNames[] = {"interactive", "normal", "bulk"};
+    std::string body = "{\"classes\": [";
+    for (size_t i = 0; i < inference::kNumPriorities; i++) {
+        auto stats = INFERENCER.GetQueueStats(static_cast<inference::Priority>(i));
+        double avg_wait_ms = stats.scheduled > 0 ? stats.total_wait_ns / 1e6 / stats.scheduled : 0.0;
+        if (i > 0) {
+            body += ", ";
+        }
+        body += fmt::format("{{\"priority\": \"{}\", \"pending\": {}, \"scheduled\": {}, \"expired\": {}, \"avg_wait_ms\": {:.2f}, \"max_wait_ms\": {:.2f}}}",
+                            kClassNames[i], stats.pending, stats.scheduled, stats.expired, avg_wait_ms, stats.max_wait_ns / 1e6);
+    }
+    body += "]}";
+    SendJson(context, conn, 200, std::move(body));
+}
+
+// Prometheus 文本格式的全部指标
+void HttpApplication::MetricsHandler_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    context.response.SetStatusCode(200);
+    context.response.SetContentType("text/plain; version=0.0.4; charset=utf-8");
+    context.response.SetBody(METRICS.Render());
+    SendResponse(conn, context.response);
+}
+
+// 各线程最近的追踪事件, Chrome trace JSON, 保存后用 chrome://tracing 或 ui.perfetto.dev 打开
+void HttpApplication::TraceHandler_(HttpContext& context, const net::TcpConnection::Ptr& conn, const Next& next) {
+    context.response.SetStatusCode(200);
+    context.response.SetContentType("application/json");
+    context.response.SetBody(tracing::Tracer::GetInstance().DumpChromeJson());
+    SendResponse(conn, context.response);
 }
 
 void HttpApplication::CacheStaticFile_(const std::string& file_path) {
@@ -260,9 +777,7 @@ void HttpApplication::StaticFileHandler_(HttpContext& context, const net::TcpCon
         context.response.SetContentType("text/plain; charset=utf-8");
         context.response.SetBody("404 Not Found: The requested resource '" + path + "' does not exist.");
         
-        net::Buffer buf;
-        context.response.AppendToBuffer(buf);
-        conn->Send(buf);
+        SendResponse(conn, context.response);
         return;
     }
 
@@ -294,18 +809,14 @@ void HttpApplication::StaticFileHandler_(HttpContext& context, const net::TcpCon
         context.response.SetContentType(GetMimeType(path));
         context.response.SetBody(cache_it->second);
         
-        net::Buffer buf;
-        context.response.AppendToBuffer(buf);
-        conn->Send(buf);
+        SendResponse(conn, context.response);
     } else {
         context.response.SetStatusCode(500);
         context.response.SetStatusMessage("Internal Server Error");
         context.response.SetContentType("text/plain; charset=utf-8");
         context.response.SetBody("500 Internal Server Error: Failed to load file.");
         
-        net::Buffer buf;
-        context.response.AppendToBuffer(buf);
-        conn->Send(buf);
+        SendResponse(conn, context.response);
     }
 }
 
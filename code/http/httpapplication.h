@@ -2,6 +2,7 @@
 
 #include "context/context.h"
 #include "context/executor.h"
+#include "accesslog.h"
 #include "httpcontext.h"
 #include "net/tcpconnection.h"
 #include "net/tcpserver.h"
@@ -17,17 +18,55 @@ public:
                   std::string name, const int workers_num = 4);
 
   void SetThreadNum(int num_threads) { server_.SetThreadNum(num_threads); }
+  void SetLoopSelectPolicy(net::LoopSelectPolicy policy) {
+    server_.SetLoopSelectPolicy(policy);
+  }
+  void SetLoopAffinity(net::LoopAffinity affinity) {
+    server_.SetLoopAffinity(affinity);
+  }
+  void SetMaxConnections(size_t max_connections) {
+    server_.SetMaxConnections(max_connections);
+  }
+  void SetMaxConnectionsPerLoop(size_t max_connections) {
+    server_.SetMaxConnectionsPerLoop(max_connections);
+  }
+  // 每 interval 个请求写一行访问日志, 0 关闭
+  void SetAccessLogInterval(uint32_t interval) {
+    access_log_.SetSampleInterval(interval);
+  }
+  // 访问日志改为写到 dir 下每个 IO 线程一个的二进制环形文件, 用 accesslog_decode 解码
+  // 在 Start 之前调用
+  bool EnableBinaryAccessLog(const std::string &dir, size_t ring_records);
   void Start();
 
 private:
   void OnConnection_(const net::TcpConnection::Ptr &conn);
   void OnMessage_(const net::TcpConnection::Ptr &conn, net::Buffer &buf);
+  // deferred 响应的最后一个字节交给连接之后在 IO 线程调用: 关闭连接, 或者恢复读并处理缓冲区里的请求
+  void CompleteDeferred_(const net::TcpConnection::Ptr &conn);
 
   void ParseMultipartForm_(HttpContext &context,
                            const net::TcpConnection::Ptr &conn,
                            const Next &next);
+  void ParseBatchBody_(HttpContext &context,
+                       const net::TcpConnection::Ptr &conn, const Next &next);
   void PredictHandler_(HttpContext &context,
                        const net::TcpConnection::Ptr &conn, const Next &next);
+  void BatchPredictHandler_(HttpContext &context,
+                            const net::TcpConnection::Ptr &conn,
+                            const Next &next);
+  void LoopStatsHandler_(HttpContext &context,
+                         const net::TcpConnection::Ptr &conn, const Next &next);
+  void AcceptStatsHandler_(HttpContext &context,
+                           const net::TcpConnection::Ptr &conn,
+                           const Next &next);
+  void InferenceStatsHandler_(HttpContext &context,
+                              const net::TcpConnection::Ptr &conn,
+                              const Next &next);
+  void MetricsHandler_(HttpContext &context,
+                       const net::TcpConnection::Ptr &conn, const Next &next);
+  void TraceHandler_(HttpContext &context, const net::TcpConnection::Ptr &conn,
+                     const Next &next);
   void StaticFileHandler_(HttpContext &context,
                           const net::TcpConnection::Ptr &conn,
                           const Next &next);
@@ -35,8 +74,12 @@ private:
   void CacheStaticFile_(const std::string &file_path);
   void CacheStaticFiles_(const std::string &path);
 
+  // 一组图片整体放进推理队列, 不能超过队列容量 (BoneAgeInferencer::kMaxRequestQueueSize)
+  static constexpr size_t kMaxImagesPerBatch = 256;
+
   net::TcpServer server_;
   Router router_;
+  AccessLog access_log_;
 
   ctx::TaskRunnerTag task_runner_;
 
@@ -2,13 +2,17 @@
 
 #include "httprequest.h"
 #include "httpresponse.h"
+#include <chrono>
+#include <cstdint>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace http {
 
 struct ParsedForm {
   std::optional<std::vector<unsigned char>> image_data;
+  std::vector<std::vector<unsigned char>> images; // /predict/batch 的所有图片
   std::optional<std::string> username;
   std::optional<std::string> password;
 };
@@ -21,11 +25,26 @@ struct HttpContext {
   std::optional<ParsedForm> form;
   std::optional<std::string> authenticated_user;
 
+  uint64_t parse_ns{0}; // 这个请求累计的解析耗时
+  uint64_t request_id{0}; // 进程内唯一, 开始解析一个新请求时分配, 0 表示还没有
+  std::chrono::steady_clock::time_point start_time; // 分配 request_id 的时间
+  std::chrono::steady_clock::time_point route_start; // 解析完成, 开始路由的时间
+
+  bool access_sampled{false}; // 这个请求要写访问日志
+  bool deferred{false}; // 处理函数之后才发响应 (推理请求), 访问日志由它自己写
+  // deferred 响应还没发完: 连接暂停读, 后面流水线发来的请求先不解析, 发完后再关连接或继续处理
+  bool response_pending{false};
+
   void Reset() {
     request.Reset();
     response.Reset();
     form.reset();
     authenticated_user.reset();
+    parse_ns = 0;
+    request_id = 0;
+    access_sampled = false;
+    deferred = false;
+    response_pending = false;
   }
 };
 
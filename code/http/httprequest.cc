@@ -2,6 +2,8 @@
 #include "logging/logger.h"
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cstdlib>
 
 namespace http {
 
@@ -10,12 +12,21 @@ using namespace net;
 void HttpRequest::Reset() {
   method_ = {};
   path_ = {};
+  query_ = {};
+  query_params_.clear();
   version_ = {};
   headers_.clear();
-  body_.clear();
+  // 大报文 (如上传的图片) 处理完后释放内存, 避免长连接一直占着
+  if (body_.capacity() > Buffer::kMaxIdleSize) {
+    std::string().swap(body_);
+  } else {
+    body_.clear();
+  }
   is_keep_alive_ = false;
+  is_chunked_ = false;
   state_ = ParseState::kRequestLine;
   content_len_ = 0;
+  chunk_remaining_ = 0;
 }
 
 std::optional<std::string_view> HttpRequest::ReadLineFromBuffer_(Buffer &buff) {
@@ -25,26 +36,32 @@ std::optional<std::string_view> HttpRequest::ReadLineFromBuffer_(Buffer &buff) {
   if (line_end == buff.BeginWriteConst()) {
     return std::nullopt;
   }
-  std::string_view line(buff.Peek(),
-                        line_end - buff.Peek()); // line 不包含 crlf
-  buff.Retrieve(line.size() + 2);
-  return line;
+  return std::string_view(buff.Peek(), line_end - buff.Peek());
 }
 
 HttpRequest::HttpCode HttpRequest::Parse(Buffer &buff) {
   while (state_ != ParseState::kFinish) {
+    // 只取属于本请求的字节, 后面流水线过来的请求留在 buff 里
     if (state_ == ParseState::kBody) {
-      if (buff.ReadableBytes() == 0 && body_.size() < content_len_) {
+      size_t bytes_to_read =
+          std::min(buff.ReadableBytes(), content_len_ - body_.size());
+      body_.append(buff.Peek(), bytes_to_read);
+      buff.Retrieve(bytes_to_read);
+      if (body_.size() < content_len_) {
         return HttpCode::kNoRequest;
       }
-      if (body_.size() == content_len_) {
-        state_ = ParseState::kFinish;
-        break;
-      }
-      size_t bytes_to_read = buff.ReadableBytes();
+      state_ = ParseState::kFinish;
+      break;
+    }
+    if (state_ == ParseState::kChunkData) {
+      size_t bytes_to_read = std::min(buff.ReadableBytes(), chunk_remaining_);
       body_.append(buff.Peek(), bytes_to_read);
       buff.Retrieve(bytes_to_read);
-
+      chunk_remaining_ -= bytes_to_read;
+      if (chunk_remaining_ > 0) {
+        return HttpCode::kNoRequest;
+      }
+      state_ = ParseState::kChunkDataEnd;
       continue;
     }
 
@@ -52,25 +69,11 @@ HttpRequest::HttpCode HttpRequest::Parse(Buffer &buff) {
     if (!line) {
       return HttpCode::kNoRequest; // 数据不足, 接着进行下一次读取
     }
-
-    switch (state_) {
-    case ParseState::kRequestLine:
-      if (!ParseRequestLine_(*line)) {
-        return HttpCode::kBadRequest;
-      }
-      state_ = ParseState::kHeaders;
-      break;
-    case ParseState::kHeaders:
-      if (line->empty()) { // 空行, headers结束
-        state_ = (content_len_ > 0) ? ParseState::kBody : ParseState::kFinish;
-      } else if (!ParseHeader_(*line)) {
-        return HttpCode::kBadRequest;
-      }
-      break;
-    default:
-      state_ = ParseState::kFinish;
-      break;
+    if (!ParseLine_(*line)) {
+      return HttpCode::kBadRequest;
     }
+    // Retrieve 可能释放 buff 的内存, 必须在用完 line 之后
+    buff.Retrieve(line->size() + 2);
   }
 
   auto it = headers_.find("connection");
@@ -87,6 +90,78 @@ HttpRequest::HttpCode HttpRequest::Parse(Buffer &buff) {
   return HttpCode::kGetRequest;
 }
 
+bool HttpRequest::ParseLine_(std::string_view line) {
+  switch (state_) {
+  case ParseState::kRequestLine:
+    if (!ParseRequestLine_(line)) {
+      return false;
+    }
+    state_ = ParseState::kHeaders;
+    break;
+  case ParseState::kHeaders:
+    if (line.empty()) { // 空行, headers结束
+      if (is_chunked_) {
+        state_ = ParseState::kChunkSize;
+      } else {
+        state_ = (content_len_ > 0) ? ParseState::kBody : ParseState::kFinish;
+      }
+    } else if (!ParseHeader_(line)) {
+      return false;
+    }
+    break;
+  case ParseState::kChunkSize:
+    if (!ParseChunkSize_(line)) {
+      return false;
+    }
+    state_ = (chunk_remaining_ == 0) ? ParseState::kChunkTrailer
+                                     : ParseState::kChunkData;
+    break;
+  case ParseState::kChunkDataEnd:
+    if (!line.empty()) {
+      return false;
+    }
+    state_ = ParseState::kChunkSize;
+    break;
+  case ParseState::kChunkTrailer:
+    // trailer 里的头部不使用, 读到空行结束
+    if (line.empty()) {
+      state_ = ParseState::kFinish;
+    }
+    break;
+  default:
+    state_ = ParseState::kFinish;
+    break;
+  }
+  return true;
+}
+
+// 十六进制的块大小, 后面可能跟着 ";ext=..." 扩展, 忽略
+bool HttpRequest::ParseChunkSize_(std::string_view line) {
+  line = line.substr(0, line.find(';'));
+  while (!line.empty() && (line.back() == ' ' || line.back() == '\t')) {
+    line.remove_suffix(1);
+  }
+  if (line.empty() || line.size() > 15) { // 防止溢出
+    return false;
+  }
+  size_t size = 0;
+  for (char c : line) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      digit = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      digit = c - 'A' + 10;
+    } else {
+      return false;
+    }
+    size = size * 16 + digit;
+  }
+  chunk_remaining_ = size;
+  return true;
+}
+
 bool HttpRequest::ParseRequestLine_(std::string_view line) {
   size_t method_end = line.find(' ');
   if (method_end == std::string_view::npos) {
@@ -98,7 +173,14 @@ bool HttpRequest::ParseRequestLine_(std::string_view line) {
   if (path_end == std::string_view::npos) {
     return false;
   }
-  path_ = line.substr(method_end + 1, path_end - (method_end + 1));
+  std::string_view target = line.substr(method_end + 1, path_end - (method_end + 1));
+  size_t query_pos = target.find('?');
+  if (query_pos != std::string_view::npos) {
+    query_ = target.substr(query_pos + 1);
+    ParseQuery_(query_);
+    target = target.substr(0, query_pos);
+  }
+  path_ = target;
   version_ = line.substr(path_end + 1);
 
   return !method_.empty() && !path_.empty() &&
@@ -126,9 +208,44 @@ bool HttpRequest::ParseHeader_(std::string_view line) {
   headers_[key] = std::string(value_sv);
 
   if (key == "content-length") {
-    content_len_ = std::stoul(std::string(value_sv));
+    std::string value(value_sv);
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long len = std::strtoull(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno == ERANGE) {
+      return false;
+    }
+    content_len_ = len;
+  } else if (key == "transfer-encoding") {
+    // chunked 必须是最后一个编码, 这里不支持其他压缩编码
+    std::string value(value_sv);
+    std::transform(value.begin(), value.end(), value.begin(), tolower);
+    if (value != "chunked") {
+      return false;
+    }
+    is_chunked_ = true;
   }
   return true;
 }
 
+// a=1&b=2, 不做百分号解码, 参数都是简单的 ascii 值
+void HttpRequest::ParseQuery_(std::string_view query) {
+  while (!query.empty()) {
+    size_t amp = query.find('&');
+    std::string_view pair = query.substr(0, amp);
+    if (!pair.empty()) {
+      size_t eq = pair.find('=');
+      std::string key(pair.substr(0, eq));
+      std::string value = (eq == std::string_view::npos)
+                              ? std::string()
+                              : std::string(pair.substr(eq + 1));
+      query_params_[std::move(key)] = std::move(value);
+    }
+    if (amp == std::string_view::npos) {
+      break;
+    }
+    query.remove_prefix(amp + 1);
+  }
+}
+
 } // namespace http
\ No newline at end of file
@@ -25,39 +25,55 @@ public:
   HttpCode Parse(net::Buffer &buff);
 
   const std::string &GetMethod() const { return method_; }
-  const std::string &GetPath() const { return path_; }
+  const std::string &GetPath() const { return path_; } // 不含 query
+  const std::string &GetQuery() const { return query_; }
+  const std::unordered_map<std::string, std::string> &GetQueryParams() const {
+    return query_params_;
+  }
   const std::string &GetVersion() const { return version_; }
   const std::string &GetBody() const { return body_; }
   const std::unordered_map<std::string, std::string> &GetHeaders() const {
     return headers_;
   }
   bool IsKeepAlive() const { return is_keep_alive_; }
+  bool IsChunked() const { return is_chunked_; }
 
 private:
   enum class ParseState {
     kRequestLine,
     kHeaders,
     kBody,
+    kChunkSize,    // 块大小行
+    kChunkData,    // 块数据
+    kChunkDataEnd, // 块数据后面的 CRLF
+    kChunkTrailer, // 最后一个块之后的 trailer, 以空行结束
     kFinish,
   };
 
+  // 返回的行不包含 CRLF, 也还没有从 buff 中取走, 用完之后再 Retrieve
   std::optional<std::string_view> ReadLineFromBuffer_(net::Buffer &buff);
 
   bool ParseRequestLine_(std::string_view line);
   bool ParseHeader_(std::string_view line);
-  void ParseBody_(net::Buffer &buff);
+  void ParseQuery_(std::string_view query);
+  bool ParseChunkSize_(std::string_view line);
+  bool ParseLine_(std::string_view line);
 
 private:
   std::string method_;
   std::string path_;
+  std::string query_;
+  std::unordered_map<std::string, std::string> query_params_;
   std::string version_;
   std::unordered_map<std::string, std::string> headers_;
   std::string body_;
 
   bool is_keep_alive_;
+  bool is_chunked_;
 
   ParseState state_;
   size_t content_len_;
+  size_t chunk_remaining_; // 当前块还没读到的字节数
 };
 
 } // namespace http
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "httpresponse.h"
+#include <fmt/format.h>
 #include <iostream>
 
 namespace http {
@@ -8,12 +9,14 @@ using namespace net;
 static const std::unordered_map<int, std::string> kStatusCodeToString = {
     {200, "OK"},        {400, "Bad Request"},           {403, "Forbidden"},
     {404, "Not Found"}, {500, "Internal Server Error"},
+    {504, "Gateway Timeout"},
 };
 
 void HttpResponse::Reset() {
   status_code_ = 200; // 默认成功
   status_message_.clear();
   is_keep_alive_ = false;
+  is_chunked_ = false;
   headers_.clear();
   body_.clear();
 }
@@ -37,7 +40,12 @@ void HttpResponse::SetHeader(std::string key, std::string value) {
 void HttpResponse::SetBody(std::string body) { body_ = std::move(body); }
 
 void HttpResponse::AppendToBuffer(Buffer &buffer) {
-  headers_["Content-Length"] = std::to_string(body_.size());
+  const size_t start_size = buffer.ReadableBytes();
+  if (is_chunked_) {
+    headers_["Transfer-Encoding"] = "chunked";
+  } else {
+    headers_["Content-Length"] = std::to_string(body_.size());
+  }
   if (is_keep_alive_) {
     headers_["Connection"] = "keep-alive";
   } else {
@@ -63,8 +71,22 @@ void HttpResponse::AppendToBuffer(Buffer &buffer) {
   }
 
   buffer.Append("\r\n");
-  if (!body_.empty()) {
+  if (!body_.empty() && !is_chunked_) {
     buffer.Append(body_);
   }
+  serialized_size_ = buffer.ReadableBytes() - start_size;
+}
+
+void HttpResponse::AppendChunk(Buffer &buffer, std::string_view data) {
+  if (data.empty()) { // 空块会被当成结束标记
+    return;
+  }
+  buffer.Append(fmt::format("{:x}\r\n", data.size()));
+  buffer.Append(data);
+  buffer.Append("\r\n");
+}
+
+void HttpResponse::AppendLastChunk(Buffer &buffer) {
+  buffer.Append("0\r\n\r\n");
 }
 } // namespace http
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "net/buffer.h"
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace http {
@@ -23,14 +24,26 @@ public:
 
   void SetBody(std::string body);
 
+  // 分块响应: 用 Transfer-Encoding: chunked 代替 Content-Length, 不写 body
+  // 之后由 AppendChunk 逐块追加, AppendLastChunk 结束
+  void SetChunked(bool on) { is_chunked_ = on; }
+
   void AppendToBuffer(net::Buffer &buffer);
 
+  static void AppendChunk(net::Buffer &buffer, std::string_view data);
+  static void AppendLastChunk(net::Buffer &buffer);
+
   bool IsKeepAlive() const { return is_keep_alive_; }
+  int GetStatusCode() const { return status_code_; }
+  // 上一次 AppendToBuffer 写出的字节数
+  size_t GetSerializedSize() const { return serialized_size_; }
 
 private:
   int status_code_;
   std::string status_message_;
   bool is_keep_alive_;
+  bool is_chunked_;
+  size_t serialized_size_{0};
   std::unordered_map<std::string, std::string> headers_;
   std::string body_;
 };
@@ -1,5 +1,6 @@
 #include "router.h"
 #include "logging/logger.h"
+#include <algorithm>
 
 namespace http {
 
@@ -23,6 +24,16 @@ void Router::AddRoute(std::string method, std::string path,
   routes_[key] = middlewares;
 }
 
+std::vector<std::string> Router::GetPaths() const {
+  std::vector<std::string> paths;
+  for (const auto &[key, chain] : routes_) {
+    paths.push_back(key.substr(key.find(':') + 1));
+  }
+  std::sort(paths.begin(), paths.end());
+  paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+  return paths;
+}
+
 void Router::Route(HttpContext &context, const net::TcpConnection::Ptr &conn) {
   std::string key =
       context.request.GetMethod() + ":" + context.request.GetPath();
@@ -20,6 +20,8 @@ public:
 
     void AddRoute(std::string method, std::string path, std::initializer_list<Middleware> middlewares);
     void Route(HttpContext& context, const net::TcpConnection::Ptr& conn);
+    // 所有注册过的路径 (不含方法), 去重后按字典序
+    std::vector<std::string> GetPaths() const;
 
 private:
     std::unordered_map<std::string, std::vector<Middleware>> routes_;
@@ -4,85 +4,101 @@
 #include "nn/classify.h"
 #include <algorithm>
 #include <opencv2/opencv.hpp>
-#include <tbb/task.h>
+#include <tbb/blocked_range.h>
+#include <tbb/info.h>
+#include <tbb/parallel_for.h>
 #include "logging/logger.h"
+#include "metrics/stages.h"
+#include "tracing/tracer.h"
 #include "bone_info.h"
+#include "inference/hand_detail.h"
+#include "inference/result_writer.h"
+#include <array>
+#include <chrono>
+#include <future>
+#include <optional>
 #include "onnxruntime_c_api.h"
-#include <nlohmann/json.hpp>
-#include <algorithm>
 #include "http/httpresponse.h"
 #include "net/eventloop.h"
 
-namespace nlohmann {
-    template <>
-    struct adl_serializer<cv::Rect> {
-        static void to_json(json& j, const cv::Rect& rect) {
-            j = {
-                {"x", rect.x},
-                {"y", rect.y},
-                {"width", rect.width},
-                {"height", rect.height}
-            };
-        }
-    };
-}
-
 namespace inference {
 
-using json = nlohmann::json;
-
-struct BoneDetail {
-    std::string joint;
-    cv::Rect box;
-    int category_id;
-    int maturity_stage;
-};
-
-struct HandDetail {
-    std::vector<BoneDetail> bones_detail;
-    bool is_valid;
-};
-
-// BoneDetail 的序列化
-void to_json(json& j, const BoneDetail& bone) {
-    j = {
-        {"joint", bone.joint},
-        {"box", bone.box},
-        {"category_id", bone.category_id},
-        {"maturity_stage", bone.maturity_stage}
-    };
-}
-
-// HandDetail 的序列化
-void to_json(json& j, const HandDetail& hand) {
-    j = {
-        {"is_valid", hand.is_valid},
-        {"bones_detail", hand.bones_detail}
-    };
+// 按前端 calculateBoneAge 的规则: 只统计 13 个标准关节, 检测不完整时缺的关节记 0 分
+RusChnResult ScoreRusChn(const HandDetail& hand, BoneInfo::Sex sex) {
+    std::array<int, 13> stages;
+    stages.fill(-1);
+    for (const auto& bone : hand.bones_detail) {
+        auto it = std::find(BoneInfo::kKeyJoints.begin(), BoneInfo::kKeyJoints.end(), bone.joint);
+        if (it != BoneInfo::kKeyJoints.end()) {
+            stages[it - BoneInfo::kKeyJoints.begin()] = bone.maturity_stage;
+        }
+    }
+    int total_score = BoneInfo::RusChnTotalScore(sex, stages);
+    return {sex, total_score, BoneInfo::RusChnBoneAge(sex, total_score)};
 }
 
 class BoneAgeInferencer::InferencePipeline {
 public:
     InferencePipeline(std::shared_ptr<Ort::Env> env, 
                       const std::string& detection_model_path,
-                      const std::string& classification_model_path)
-        : detector_(env, detection_model_path, true, {640, 640}, {1}),
-          classifier_(env, classification_model_path, true, {112, 112}, {12, 13, 14}) 
-    {}
+                      const std::string& classification_model_path,
+                      size_t max_batch_size,
+                      bool detect_use_gpu,
+                      bool classify_use_gpu,
+                      const std::string& model_cache_dir)
+    {
+        // 两个模型的加载和预热互不依赖, 分类模型放到另一个线程, 启动时间取两者中较长的一个
+        auto start = std::chrono::steady_clock::now();
+        auto classifier = std::async(std::launch::async, [&]() {
+            auto model = std::make_unique<nn::MaturityClassifier>(env, classification_model_path, classify_use_gpu, cv::Size(112, 112),
+                                                                  ClassifyWarmupSizes(max_batch_size), model_cache_dir);
+            LOG_INFO("classify model ready in {} ms", MillisecondsSince(start));
+            return model;
+        });
+        detector_ = std::make_unique<nn::YOLO11Detector>(env, detection_model_path, detect_use_gpu, cv::Size(640, 640),
+                                                         DetectWarmupSizes(max_batch_size), model_cache_dir);
+        LOG_INFO("detect model ready in {} ms", MillisecondsSince(start));
+        classifier_ = classifier.get();
+    }
+
+    static int64_t MillisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 按单张和满 batch 两种形状预热, 避免第一个大 batch 请求触发 cuda 的内存分配
+    static std::vector<size_t> DetectWarmupSizes(size_t max_batch_size) {
+        std::vector<size_t> sizes{1};
+        if (max_batch_size > 1) {
+            sizes.push_back(max_batch_size);
+        }
+        return sizes;
+    }
+
+    static std::vector<size_t> ClassifyWarmupSizes(size_t max_batch_size) {
+        std::vector<size_t> sizes{12, 13, 14};
+        if (max_batch_size > 1) {
+            sizes.push_back(max_batch_size * BoneInfo::kKeyJoints.size());
+        }
+        return sizes;
+    }
 
     std::vector<HandDetail> inference(const std::vector<cv::Mat>& images) {
         int batch_size = images.size();
         LOG_DEBUG("batch size: {}", batch_size);
-        std::vector<HandDetail> batch_processed;
-        batch_processed.reserve(batch_size);
-
-        // 检测, 提取
-        std::vector<std::vector<nn::DetectionResult>> detection_result = detector_.Detect(images);
-        for (int i = 0; i < batch_size; i++) {
-            LOG_DEBUG("image {} detect {} boxes", i, detection_result[i].size());
-            auto hand_detail = GetHandDetail(detection_result[i]);
-            batch_processed.emplace_back(std::move(hand_detail));
-        }
+        std::vector<HandDetail> batch_processed(batch_size);
+
+        static auto& extract_histogram = metrics::InferenceStage("extract");
+
+        // 检测, 提取. 每张图的关节提取互不依赖, 在当前 arena 里并行
+        std::vector<std::vector<nn::DetectionResult>> detection_result = detector_->Detect(images);
+        auto extract_start = std::chrono::steady_clock::now();
+        tbb::parallel_for(tbb::blocked_range<int>(0, batch_size),
+            [&](const tbb::blocked_range<int>& range) {
+                for (int i = range.begin(); i != range.end(); ++i) {
+                    LOG_DEBUG("image {} detect {} boxes", i, detection_result[i].size());
+                    batch_processed[i] = GetHandDetail(detection_result[i]);
+                }
+            });
         // 分类
         std::vector<cv::Mat> batch_joint_images;
         batch_joint_images.reserve(batch_size * BoneInfo::kKeyJoints.size());
@@ -103,7 +119,8 @@ public:
             }
         }
         
-        std::vector<nn::ClassificationResult> batch_classify_result = classifier_.Classify(batch_joint_images, batch_category_ids);
+        extract_histogram.RecordSince(extract_start);
+        std::vector<nn::ClassificationResult> batch_classify_result = classifier_->Classify(batch_joint_images, batch_category_ids);
 
         // std::vector<nn::ClassificationResult> batch_classify_result;
         // batch_classify_result.reserve(batch_joint_images.size());
@@ -292,8 +309,8 @@ public:
     }
 
 private:
-    nn::YOLO11Detector detector_;
-    nn::MaturityClassifier classifier_;
+    std::unique_ptr<nn::YOLO11Detector> detector_;
+    std::unique_ptr<nn::MaturityClassifier> classifier_;
 };
 
 BoneAgeInferencer::BoneAgeInferencer() = default;
@@ -301,16 +318,57 @@ BoneAgeInferencer::BoneAgeInferencer() = default;
 BoneAgeInferencer::~BoneAgeInferencer() = default;
 
 void BoneAgeInferencer::Init(size_t thread_count, const std::string& detection_model_path,
-                                 const std::string& classification_model_path)
+                                 const std::string& classification_model_path,
+                                 size_t max_batch_size,
+                                 bool use_gpu,
+                                 nn::Precision detect_precision,
+                                 nn::Precision classify_precision)
 {
+    auto init_start = std::chrono::steady_clock::now();
     auto env = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "BoneAgeApp");
 
+    if (use_gpu) {
+        auto providers = Ort::GetAvailableProviders();
+        if (std::find(providers.begin(), providers.end(), "CUDAExecutionProvider") == providers.end()) {
+            LOG_WARN("onnxruntime has no CUDA execution provider, running on CPU");
+            use_gpu = false;
+        }
+    }
+
+    const std::string detect_model = nn::ModelPathFor(detection_model_path, detect_precision);
+    const std::string classify_model = nn::ModelPathFor(classification_model_path, classify_precision);
+    LOG_INFO("detect model: {} ({}), classify model: {} ({})",
+             detect_model, nn::PrecisionName(detect_precision), classify_model, nn::PrecisionName(classify_precision));
+
+    // CUDA provider 上 QDQ 模型没有 int8 kernel, 反而更慢, int8 阶段固定用 CPU
+    max_batch_size_ = std::max<size_t>(max_batch_size, 1);
     inferencer_ = std::make_unique<InferencePipeline>(env, 
-                                                      detection_model_path, 
-                                                      classification_model_path);
+                                                      detect_model, 
+                                                      classify_model,
+                                                      max_batch_size_,
+                                                      use_gpu && detect_precision == nn::Precision::kFp32,
+                                                      use_gpu && classify_precision == nn::Precision::kFp32,
+                                                      model_cache_dir_);
+    LOG_INFO("models ready in {} ms", InferencePipeline::MillisecondsSince(init_start));
 
     is_closed_.store(false);
     thread_count_ = thread_count;
+
+    // 每个调度线程进入 arena 都要占一个 slot, 给它们预留好, 剩下的 slot 给 TBB worker 做 parallel_for
+    int concurrency = std::max(static_cast<int>(thread_count_), tbb::info::default_concurrency());
+    arena_.initialize(concurrency, static_cast<unsigned>(thread_count_));
+
+    METRICS.SetGauge("boneage_queue_depth", "Inference requests waiting in the scheduler, by priority.", [this]() {
+        static const char* const kClassNames[] = {"interactive", "normal", "bulk"};
+        std::vector<metrics::Registry::Sample> samples;
+        for (size_t i = 0; i < kNumPriorities; i++) {
+            samples.push_back({{{"priority", kClassNames[i]}}, static_cast<double>(GetQueueStats(static_cast<Priority>(i)).pending)});
+        }
+        return samples;
+    });
+    METRICS.SetGauge("boneage_inflight_tasks", "Inference tasks taken from the queue and not yet completed.",
+                     [this]() { return static_cast<double>(in_flight_.load(std::memory_order_relaxed)); });
+
     task_runner_ = NEW_PARALLEL_RUNNER(3, thread_count_);
     for (size_t i = 0; i < thread_count_; ++i) {
         POST_TASK(task_runner_, [this]() {
@@ -321,95 +379,222 @@ void BoneAgeInferencer::Init(size_t thread_count, const std::string& detection_m
 
 void BoneAgeInferencer::Shutdown() {
     is_closed_.store(true);
-    request_cv_.notify_all();
+    // 唤醒阻塞在 Push/PopBatch 上的线程
+    scheduler_.Close();
     
     inferencer_.reset();
 }
 
-void BoneAgeInferencer::PostInference(InferenceTask task) {
-    std::unique_lock<std::mutex> lock(requeset_mutex_);
-    request_cv_.wait(lock, [this]() { return request_queue_.size() < kMaxRequestQueueSize || is_closed_.load(); });
+bool BoneAgeInferencer::PostInference(InferenceTask task) {
     if (is_closed_.load()) {
-        return;
+        return false;
     }
-    request_queue_.emplace(std::move(task));
-    request_cv_.notify_one();
+    TRACE_SPAN("inference", "enqueue", task.request_id);
+    TRACE_ASYNC_BEGIN("inference", "queue", task.request_id);
+    return scheduler_.Push(std::move(task)); // 已经 Shutdown 时丢弃
+}
+
+bool BoneAgeInferencer::TryPostInference(InferenceTask task) {
+    if (is_closed_.load()) {
+        return false;
+    }
+    TRACE_SPAN("inference", "enqueue", task.request_id);
+    TRACE_ASYNC_BEGIN("inference", "queue", task.request_id);
+    [[maybe_unused]] const uint64_t request_id = task.request_id;
+    if (!scheduler_.TryPush(std::move(task))) {
+        TRACE_ASYNC_END("inference", "queue", request_id);
+        return false;
+    }
+    return true;
+}
+
+bool BoneAgeInferencer::TryPostInferenceGroup(std::vector<InferenceTask> tasks) {
+    if (is_closed_.load()) {
+        return false;
+    }
+    if (tasks.empty()) {
+        return true;
+    }
+    // 同一组共用 request_id
+    [[maybe_unused]] const uint64_t request_id = tasks.front().request_id;
+    const size_t count = tasks.size();
+    TRACE_SPAN("inference", "enqueue", request_id);
+    for (size_t i = 0; i < count; i++) {
+        TRACE_ASYNC_BEGIN("inference", "queue", request_id);
+    }
+    if (!scheduler_.TryPushGroup(std::move(tasks))) {
+        for (size_t i = 0; i < count; i++) {
+            TRACE_ASYNC_END("inference", "queue", request_id);
+        }
+        return false;
+    }
+    return true;
 }
 
 void BoneAgeInferencer::Run_() {
+    static auto& queue_histogram = metrics::InferenceStage("queue");
+    static auto& batch_histogram = metrics::InferenceStage("batch");
+
     while (true) {
-        std::vector<InferenceTask> batch_tasks;
-        batch_tasks.reserve(kMaxInferenceBatchSize);
-        {
-            std::unique_lock<std::mutex> lock(requeset_mutex_);
-            request_cv_.wait(lock, [this]() { return !request_queue_.empty() || is_closed_.load();});
-            if (is_closed_.load()) {
-                return;
-            }
-            size_t total_task_count = request_queue_.size();
-            size_t batch_size = 1;
-
-            if (total_task_count > thread_count_) {
-                size_t desired_batch_size = (total_task_count + thread_count_ - 1) / thread_count_;
-                if (desired_batch_size > 1) {
-                    batch_size = 1;
-                    while ((batch_size << 1) <= desired_batch_size) {
-                        batch_size <<= 1;
-                    }
+        size_t total_task_count = std::max<size_t>(scheduler_.Size(), 1);
+        size_t batch_size = 1;
+
+        if (total_task_count > thread_count_) {
+            size_t desired_batch_size = (total_task_count + thread_count_ - 1) / thread_count_;
+            if (desired_batch_size > 1) {
+                batch_size = 1;
+                while ((batch_size << 1) <= desired_batch_size) {
+                    batch_size <<= 1;
                 }
             }
-            batch_size = std::min({batch_size, (size_t)kMaxInferenceBatchSize, total_task_count});
+        }
+        batch_size = std::min({batch_size, max_batch_size_, total_task_count});
 
-            for (size_t i = 0; i < batch_size; i++) {
-                batch_tasks.emplace_back(std::move(request_queue_.front()));
-                request_queue_.pop();
-            }
-            request_cv_.notify_one();
-        }   
-        std::vector<cv::Mat> batch_images;
-        std::vector<InferenceTask> valid_tasks; // 成功解码的任务
-        batch_images.reserve(batch_tasks.size());
-        valid_tasks.reserve(batch_tasks.size());
-
-        for (auto& task : batch_tasks) {
-            // 从内存解码图像
-            cv::Mat image;
-            try {
-                image = cv::imdecode(task.raw_image_data, cv::IMREAD_COLOR);
-            } catch (...) {
-                // 捕获所有异常，确保服务器不崩溃
-                // LOG_ERROR("Task ID {} failed to decode image.", task.task_id);
-                LOG_ERROR("Failed to decode image.");
-                LOG_ERROR("image size: {}", task.raw_image_data.size());
-                InferenceResult result;
-                // result.task_id = task.task_id;
-                task.on_complete(std::move(result));
-                continue;
-            }
+        std::vector<InferenceTask> batch_tasks;
+        std::vector<InferenceTask> expired_tasks;
+        batch_tasks.reserve(batch_size);
+        if (!scheduler_.PopBatch(batch_size, &batch_tasks, &expired_tasks) || is_closed_.load()) {
+            return;
+        }
+
+        for (auto& task : expired_tasks) {
+            TRACE_ASYNC_END("inference", "queue", task.request_id);
+            InferenceResult result;
+            result.status = Status::kDeadlineExceeded;
+            task.on_complete(std::move(result));
+        }
+        if (!expired_tasks.empty()) {
+            LOG_WARN("dropped {} expired inference tasks", expired_tasks.size());
+        }
 
-            if (!image.empty()) {
-                batch_images.push_back(image);
-                valid_tasks.push_back(std::move(task));
-            } else {
-                // LOG_ERROR("Task ID {} failed to decode image.", task.task_id);
-                LOG_ERROR("Failed to decode image.");
-                LOG_ERROR("image size: {}", task.raw_image_data.size());
-                InferenceResult result;
-                // result.task_id = task.task_id;
-                task.on_complete(std::move(result));
+        if (!batch_tasks.empty()) {
+            auto batch_start = std::chrono::steady_clock::now();
+            TRACE_SPAN("inference", "batch", batch_tasks.front().request_id);
+            for (auto& task : batch_tasks) {
+                TRACE_ASYNC_END("inference", "queue", task.request_id);
+                task.dequeue_time = batch_start;
+                queue_histogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(batch_start - task.enqueue_time).count());
             }
+            in_flight_.fetch_add(batch_tasks.size(), std::memory_order_relaxed);
+            arena_.execute([&]() {
+                RunBatch_(batch_tasks);
+            });
+            in_flight_.fetch_sub(batch_tasks.size(), std::memory_order_relaxed);
+            batch_histogram.RecordSince(batch_start);
         }
+    }
+}
+
+void BoneAgeInferencer::RunBatch_(std::vector<InferenceTask>& batch_tasks) {
+    static auto& decode_histogram = metrics::InferenceStage("decode");
+    static auto& serialize_histogram = metrics::InferenceStage("serialize");
+
+    // 附上各阶段耗时后交给回调
+    auto complete = [](InferenceTask& task, InferenceResult result) {
+        result.queue_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(task.dequeue_time - task.enqueue_time).count();
+        result.run_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - task.dequeue_time).count();
+        task.on_complete(std::move(result));
+    };
 
-        std::vector<HandDetail> hands_detail = inferencer_->inference(batch_images);
-        LOG_INFO("thread id: {}, Inferred {} task", std::hash<std::thread::id>{}(std::this_thread::get_id()), batch_tasks.size());
+    int imread_flags = cv::IMREAD_COLOR;
+    int scale = 1; // 解码后的图比原图缩小的倍数
+    switch (decode_mode_.load(std::memory_order_relaxed)) {
+        case DecodeMode::kReduced2:
+            imread_flags = cv::IMREAD_REDUCED_COLOR_2;
+            scale = 2;
+            break;
+        case DecodeMode::kReduced4:
+            imread_flags = cv::IMREAD_REDUCED_COLOR_4;
+            scale = 4;
+            break;
+        default:
+            break;
+    }
+
+    // 从内存解码图像, 每张图互不相关, 并行解码
+    std::vector<cv::Mat> decoded(batch_tasks.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batch_tasks.size()),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                metrics::ScopedTimer timer(decode_histogram);
+                try {
+                    decoded[i] = cv::imdecode(batch_tasks[i].raw_image_data, imread_flags);
+                } catch (...) {
+                    // 捕获所有异常，确保服务器不崩溃, 下面当作解码失败处理
+                    decoded[i].release();
+                }
+            }
+        });
 
-        for (size_t i = 0; i < valid_tasks.size(); ++i) {
+    std::vector<cv::Mat> batch_images;
+    std::vector<InferenceTask*> valid_tasks; // 成功解码的任务
+    batch_images.reserve(batch_tasks.size());
+    valid_tasks.reserve(batch_tasks.size());
+
+    for (size_t i = 0; i < batch_tasks.size(); ++i) {
+        auto& task = batch_tasks[i];
+        if (!decoded[i].empty()) {
+            batch_images.push_back(std::move(decoded[i]));
+            valid_tasks.push_back(&task);
+        } else {
+            // LOG_ERROR("Task ID {} failed to decode image.", task.task_id);
+            LOG_ERROR("Failed to decode image.");
+            LOG_ERROR("image size: {}", task.raw_image_data.size());
             InferenceResult result;
-            // result.task_id = valid_tasks[i].task_id;
-            result.result_str = json(hands_detail[i]).dump();
-            valid_tasks[i].on_complete(std::move(result));
+            // result.task_id = task.task_id;
+            result.status = Status::kDecodeFailed;
+            complete(task, std::move(result));
         }
     }
+    if (batch_images.empty()) {
+        return;
+    }
+
+    std::vector<HandDetail> hands_detail = inferencer_->inference(batch_images);
+    LOG_INFO("thread id: {}, Inferred {} task", std::hash<std::thread::id>{}(std::this_thread::get_id()), batch_tasks.size());
+
+    // 评分和序列化也按图并行, 回调本身只是投递到 IO 线程, 顺序执行即可
+    std::vector<std::string> result_strs(valid_tasks.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, valid_tasks.size()),
+        [&](const tbb::blocked_range<size_t>& range) {
+            // 同一段内的图复用缓冲区
+            ResultWriter json_writer;
+            BinaryResultWriter msgpack_writer(ResultFormat::kMsgPack);
+            BinaryResultWriter cbor_writer(ResultFormat::kCbor);
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                metrics::ScopedTimer timer(serialize_histogram);
+                if (scale != 1) {
+                    for (auto& bone : hands_detail[i].bones_detail) {
+                        bone.box = cv::Rect(bone.box.x * scale, bone.box.y * scale, bone.box.width * scale, bone.box.height * scale);
+                    }
+                }
+                if (valid_tasks[i]->sex) {
+                    hands_detail[i].rus_chn = ScoreRusChn(hands_detail[i], *valid_tasks[i]->sex);
+                }
+                switch (valid_tasks[i]->format) {
+                    case ResultFormat::kMsgPack:
+                        msgpack_writer.Clear();
+                        msgpack_writer.Write(hands_detail[i]);
+                        result_strs[i] = msgpack_writer.ToString();
+                        break;
+                    case ResultFormat::kCbor:
+                        cbor_writer.Clear();
+                        cbor_writer.Write(hands_detail[i]);
+                        result_strs[i] = cbor_writer.ToString();
+                        break;
+                    default:
+                        json_writer.Clear();
+                        json_writer.Write(hands_detail[i]);
+                        result_strs[i] = json_writer.ToString();
+                }
+            }
+        });
+    for (size_t i = 0; i < valid_tasks.size(); ++i) {
+        InferenceResult result;
+        // result.task_id = valid_tasks[i]->task_id;
+        result.result_str = std::move(result_strs[i]);
+        complete(*valid_tasks[i], std::move(result));
+    }
 }
 
 }
\ No newline at end of file
@@ -1,32 +1,66 @@
 #pragma once
 
-#include <condition_variable>
+#include <atomic>
 #include <cstddef>
-#include <queue>
+#include <functional>
 #include "context/context.h"
-#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <tbb/task_arena.h>
+#include <optional>
+#include "bone_info.h"
+#include "inference/request_scheduler.h"
+#include "inference/result_writer.h"
+#include "nn/precision.h"
 
 namespace inference {
 
 class BoneAgeInferencer {
 public:
+    enum class Status {
+        kOk,
+        kDecodeFailed,
+        kDeadlineExceeded, // 排队时已超过客户端的截止时间, 没有做推理
+    };
+
+    // 图像解码方式: JPEG 可以在 DCT 域直接缩小解码, 大尺寸 X 光片解码快很多
+    // 检测模型的输入是 640, 缩小后的图仍然够用; 关节裁剪的分辨率也随之降低, 精度需要用评估集确认
+    // 结果里的框会换算回原图坐标
+    enum class DecodeMode {
+        kFull,     // cv::IMREAD_COLOR
+        kReduced2, // cv::IMREAD_REDUCED_COLOR_2, 长宽各 1/2
+        kReduced4, // cv::IMREAD_REDUCED_COLOR_4, 长宽各 1/4
+    };
+
     struct InferenceResult {
         // uint64_t task_id;
-        std::string result_str;
+        Status status{Status::kOk};
+        std::string result_str; // 按任务的 format 编码, 二进制格式时不是文本
+        uint64_t queue_ns{0};   // 在调度队列里等待的时间
+        uint64_t run_ns{0};     // 出队到结果就绪 (解码、推理、序列化) 的时间
     };
 
     using InferenceCallback = std::function<void(InferenceResult)>;
 
     struct InferenceTask {
         // uint64_t task_id;
+        uint64_t request_id{0}; // 来自 HttpContext, 用于把追踪事件串成一个请求
         std::vector<unsigned char> raw_image_data;
         InferenceCallback on_complete;
+
+        std::optional<BoneInfo::Sex> sex; // 提供时在结果中附带 RUS-CHN 总分和骨龄
+        ResultFormat format{ResultFormat::kJson}; // result_str 的编码
+        Priority priority{Priority::kNormal};
+        std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()}; // 默认不限时
+        std::chrono::steady_clock::time_point enqueue_time; // 由调度器填写
+        std::chrono::steady_clock::time_point dequeue_time; // 开始执行的时间
     };
 
+    using QueueStats = RequestScheduler<InferenceTask>::ClassStats;
+
 public:
     ~BoneAgeInferencer();
 
@@ -38,17 +72,42 @@ public:
         return instance;
     }
 
+    // max_batch_size: 一次送进检测/分类模型的最多图片数
+    // use_gpu: 使用 CUDA; onnxruntime 没有 CUDA provider 时自动退回 CPU
+    // *_precision: 选 int8 时加载同目录下的 *_int8.onnx (见 nn::ModelPathFor), 该阶段固定在 CPU 上跑
     void Init(size_t thread_count, const std::string& detection_model_path,
-              const std::string& classification_model_path);
+              const std::string& classification_model_path,
+              size_t max_batch_size = kDefaultMaxBatchSize,
+              bool use_gpu = true,
+              nn::Precision detect_precision = nn::Precision::kFp32,
+              nn::Precision classify_precision = nn::Precision::kFp32);
     
     void Shutdown();
 
-    void PostInference(InferenceTask task);
+    // 在 Init 之前或运行中都可以设置, 对之后取出的 batch 生效
+    void SetDecodeMode(DecodeMode mode) { decode_mode_.store(mode, std::memory_order_relaxed); }
+
+    // 在 Init 之前设置, 非空时把 onnxruntime 优化后的模型缓存到这个目录, 下次启动直接加载 (见 nn::ModelCache)
+    void SetModelCacheDir(const std::string& dir) { model_cache_dir_ = dir; }
+
+    // 队列满时阻塞, 已经 Shutdown 返回 false (不会回调)
+    bool PostInference(InferenceTask task);
+
+    // 以下两个不阻塞, 给 IO 线程用: 队列满或已经 Shutdown 返回 false, 任务被丢弃, 不会回调
+    bool TryPostInference(InferenceTask task);
+    // 多张图一起入队, 调度线程会把它们凑进同一个 batch; 放不下整组时一张也不放
+    bool TryPostInferenceGroup(std::vector<InferenceTask> tasks);
+
+    QueueStats GetQueueStats(Priority priority) const {
+        return scheduler_.GetStats(priority);
+    }
 
 private:
     BoneAgeInferencer();
 
+    // 调度线程: 阻塞取请求, 组 batch 后在 arena_ 里执行, 过期的直接回调
     void Run_();
+    void RunBatch_(std::vector<InferenceTask>& batch_tasks);
 
 private:
     class InferencePipeline;
@@ -56,13 +115,21 @@ private:
 
     ctx::TaskRunnerTag task_runner_;
     size_t thread_count_;
+    size_t max_batch_size_{kDefaultMaxBatchSize};
     std::atomic<bool> is_closed_{true};
+    std::atomic<size_t> in_flight_{0}; // 已经从队列取出、还没回调的任务数
+    std::atomic<DecodeMode> decode_mode_{DecodeMode::kFull};
+    std::string model_cache_dir_;
+
+    // 接收推理请求, 按优先级 + 截止时间排序, 满了以后生产者阻塞
+    RequestScheduler<InferenceTask> scheduler_{kMaxRequestQueueSize};
+    // batch 内逐图的解码/前处理/后处理用 parallel_for 在这个 arena 里并行, 不和其他 TBB 用户抢线程
+    tbb::task_arena arena_;
 
-    std::queue<InferenceTask> request_queue_; // 接收推理请求
-    std::mutex requeset_mutex_;
-    std::condition_variable request_cv_;
+    static constexpr size_t kDefaultMaxBatchSize = 1;
 
-    static constexpr size_t kMaxInferenceBatchSize = 1;
+public:
+    // 调度队列的容量, 一组任务不能超过它
     static constexpr size_t kMaxRequestQueueSize = 1000;
 };
 
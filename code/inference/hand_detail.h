@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <opencv2/core/types.hpp>
+#include "bone_info.h"
+
+namespace inference {
+
+struct BoneDetail {
+    std::string joint;
+    cv::Rect box;
+    int category_id;
+    int maturity_stage;
+};
+
+struct RusChnResult {
+    BoneInfo::Sex sex;
+    int total_score;
+    double bone_age;
+};
+
+// 一张手骨图的推理结果, 由 ResultWriter 序列化后返回给客户端
+struct HandDetail {
+    std::vector<BoneDetail> bones_detail;
+    bool is_valid;
+    std::optional<RusChnResult> rus_chn; // 请求里带了性别才计算
+};
+
+}
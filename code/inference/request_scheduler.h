@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace inference {
+
+// 请求优先级, 数值越小越优先
+enum class Priority {
+    kInteractive = 0, // 医生在界面上等结果
+    kNormal = 1,
+    kBulk = 2,        // 批量回标、归档导入
+};
+
+constexpr size_t kNumPriorities = 3;
+
+// 客户端给的相对截止时间上限, 超过的按请求错误处理, 同时避免 now + ms 溢出 steady_clock
+constexpr std::chrono::milliseconds kMaxDeadline = std::chrono::hours(24);
+
+// 从现在起 ms 毫秒的截止时间, ms 不在 (0, kMaxDeadline] 内返回 false
+inline bool DeadlineFromNow(long long ms, std::chrono::steady_clock::time_point* deadline) {
+    if (ms <= 0 || ms > kMaxDeadline.count()) {
+        return false;
+    }
+    *deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    return true;
+}
+
+// 按优先级分级的请求队列, 同一级别内按截止时间 EDF 排序 (没有截止时间的排最后, 相同时按到达顺序)
+// 取任务时从最高的非空级别里取一批, 一个 batch 只包含同一级别的任务
+// 已经过期的任务 (不论哪个级别) 不进 batch, 单独交给调用方回 504, 不浪费算力
+// Task 需要有成员: Priority priority; Clock::time_point deadline; Clock::time_point enqueue_time
+// 级别之间是严格优先, interactive 请求持续不断时 bulk 会一直等待
+template <typename Task>
+class RequestScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr Clock::time_point kNoDeadline = Clock::time_point::max();
+
+    struct ClassStats {
+        size_t pending{0};
+        uint64_t scheduled{0};      // 被取走执行的任务数
+        uint64_t expired{0};        // 过期丢弃的任务数
+        uint64_t total_wait_ns{0};  // 被取走的任务在队列里等待的总时间
+        uint64_t max_wait_ns{0};
+    };
+
+    explicit RequestScheduler(size_t capacity) : capacity_(capacity) {}
+
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+    void SetCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+    }
+
+    // 队列满时阻塞, 已经 Close 返回 false
+    bool Push(Task task) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_cv_.wait(lock, [this]() { return size_ < capacity_ || closed_; });
+        if (closed_) {
+            return false;
+        }
+        PushLocked_(std::move(task), Clock::now());
+        size_++;
+        not_empty_cv_.notify_one();
+        return true;
+    }
+
+    // 不阻塞, 队列满或已经 Close 返回 false, 给 IO 线程用
+    bool TryPush(Task task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || size_ >= capacity_) {
+            return false;
+        }
+        PushLocked_(std::move(task), Clock::now());
+        size_++;
+        not_empty_cv_.notify_one();
+        return true;
+    }
+
+    // 一组任务一次性入队, 拿到连续的序号, 同优先级同截止时间时在堆里相邻, 能直接凑成整 batch
+    // 不阻塞: 放不下整组或已经 Close 返回 false, 一张也不放
+    bool TryPushGroup(std::vector<Task> tasks) {
+        if (tasks.empty()) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || size_ + tasks.size() > capacity_) {
+            return false;
+        }
+        const auto now = Clock::now();
+        for (auto& task : tasks) {
+            PushLocked_(std::move(task), now);
+        }
+        size_ += tasks.size();
+        not_empty_cv_.notify_all();
+        return true;
+    }
+
+    // 阻塞直到有任务, 取出最多 max_batch 个同级别任务放进 batch, 过期的放进 expired
+    // 两者可能只有一个非空; 已经 Close 返回 false
+    bool PopBatch(size_t max_batch, std::vector<Task>* batch, std::vector<Task>* expired) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_cv_.wait(lock, [this]() { return size_ > 0 || closed_; });
+        if (closed_) {
+            return false;
+        }
+
+        const auto now = Clock::now();
+        size_t taken = 0;
+        // 所有级别的过期任务都先清掉, 低级别的过期任务不能一直占着队列容量
+        // EDF 保证过期的都在堆顶
+        for (size_t level = 0; level < kNumPriorities; level++) {
+            auto& heap = queues_[level];
+            while (!heap.empty() && heap.front().deadline <= now) {
+                expired->push_back(PopEntry_(heap));
+                stats_[level].expired++;
+                taken++;
+            }
+        }
+        for (size_t level = 0; level < kNumPriorities; level++) {
+            auto& heap = queues_[level];
+            auto& stats = stats_[level];
+            if (heap.empty()) {
+                continue;
+            }
+            while (!heap.empty() && batch->size() < max_batch) {
+                Task task = PopEntry_(heap);
+                uint64_t wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - task.enqueue_time).count();
+                stats.scheduled++;
+                stats.total_wait_ns += wait_ns;
+                stats.max_wait_ns = std::max(stats.max_wait_ns, wait_ns);
+                batch->push_back(std::move(task));
+                taken++;
+            }
+            break;
+        }
+        size_ -= taken;
+        if (taken > 0) {
+            not_full_cv_.notify_all();
+        }
+        return true;
+    }
+
+    // 唤醒所有阻塞的生产者和消费者, 之后 Push / TryPush / TryPushGroup / PopBatch 都返回 false
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_cv_.notify_all();
+        not_full_cv_.notify_all();
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    ClassStats GetStats(Priority priority) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t index = Index_(priority);
+        ClassStats stats = stats_[index];
+        stats.pending = queues_[index].size();
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        uint64_t seq;
+        Task task;
+    };
+
+    // std::push_heap 是大顶堆, 截止时间早的 "更大"
+    struct EntryLater {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.deadline != b.deadline) {
+                return a.deadline > b.deadline;
+            }
+            return a.seq > b.seq;
+        }
+    };
+
+    static size_t Index_(Priority priority) {
+        return std::min(static_cast<size_t>(priority), kNumPriorities - 1);
+    }
+
+    // 持有 mutex_ 时调用, size_ 由调用方更新
+    void PushLocked_(Task task, Clock::time_point now) {
+        task.enqueue_time = now;
+        auto& heap = queues_[Index_(task.priority)];
+        heap.push_back(Entry{task.deadline, next_seq_++, std::move(task)});
+        std::push_heap(heap.begin(), heap.end(), EntryLater{});
+    }
+
+    static Task PopEntry_(std::vector<Entry>& heap) {
+        std::pop_heap(heap.begin(), heap.end(), EntryLater{});
+        Task task = std::move(heap.back().task);
+        heap.pop_back();
+        return task;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_cv_;
+    std::condition_variable not_full_cv_;
+
+    std::array<std::vector<Entry>, kNumPriorities> queues_;
+    std::array<ClassStats, kNumPriorities> stats_;
+    size_t size_{0};
+    size_t capacity_;
+    uint64_t next_seq_{0};
+    bool closed_{false};
+};
+
+}
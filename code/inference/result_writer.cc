@@ -0,0 +1,270 @@
+#include "result_writer.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+namespace inference {
+
+void ResultWriter::Write(const HandDetail& hand) {
+    WriteRaw_("{\"bones_detail\":[");
+    for (size_t i = 0; i < hand.bones_detail.size(); i++) {
+        if (i > 0) {
+            WriteRaw_(",");
+        }
+        WriteBone_(hand.bones_detail[i]);
+    }
+    WriteRaw_(hand.is_valid ? "],\"is_valid\":true" : "],\"is_valid\":false");
+    if (hand.rus_chn) {
+        WriteRaw_(",\"rus_chn\":");
+        WriteRusChn_(*hand.rus_chn);
+    }
+    WriteRaw_("}");
+}
+
+void ResultWriter::WriteBone_(const BoneDetail& bone) {
+    WriteRaw_("{\"box\":{\"height\":");
+    WriteInt_(bone.box.height);
+    WriteRaw_(",\"width\":");
+    WriteInt_(bone.box.width);
+    WriteRaw_(",\"x\":");
+    WriteInt_(bone.box.x);
+    WriteRaw_(",\"y\":");
+    WriteInt_(bone.box.y);
+    WriteRaw_("},\"category_id\":");
+    WriteInt_(bone.category_id);
+    WriteRaw_(",\"joint\":");
+    WriteString_(bone.joint);
+    WriteRaw_(",\"maturity_stage\":");
+    WriteInt_(bone.maturity_stage);
+    WriteRaw_("}");
+}
+
+void ResultWriter::WriteRusChn_(const RusChnResult& rus_chn) {
+    WriteRaw_("{\"bone_age\":");
+    WriteDouble_(rus_chn.bone_age);
+    WriteRaw_(rus_chn.sex == BoneInfo::Sex::kBoy ? ",\"sex\":\"boy\"" : ",\"sex\":\"girl\"");
+    WriteRaw_(",\"total_score\":");
+    WriteInt_(rus_chn.total_score);
+    WriteRaw_("}");
+}
+
+void ResultWriter::WriteInt_(int value) {
+    fmt::format_int str(value);
+    buffer_.append(str.data(), str.data() + str.size());
+}
+
+void ResultWriter::WriteDouble_(double value) {
+    if (!std::isfinite(value)) {
+        WriteRaw_("null");
+        return;
+    }
+    // nlohmann 用的是 Grisu2, 不总是最短表示, 和 fmt 的输出会在末位不同; 直接调它的 to_chars 保证一致
+    // to_chars 不分配内存, 整数值会自动补 ".0"
+    std::array<char, 64> str;
+    char* end = nlohmann::detail::to_chars(str.data(), str.data() + str.size(), value);
+    buffer_.append(str.data(), end);
+}
+
+// 转义规则同 nlohmann: 引号、反斜杠和控制字符, 其余字节原样输出
+void ResultWriter::WriteString_(std::string_view str) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    WriteRaw_("\"");
+    size_t plain_begin = 0;
+    for (size_t i = 0; i < str.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        WriteRaw_(str.substr(plain_begin, i - plain_begin));
+        plain_begin = i + 1;
+        switch (c) {
+            case '"': WriteRaw_("\\\""); break;
+            case '\\': WriteRaw_("\\\\"); break;
+            case '\b': WriteRaw_("\\b"); break;
+            case '\f': WriteRaw_("\\f"); break;
+            case '\n': WriteRaw_("\\n"); break;
+            case '\r': WriteRaw_("\\r"); break;
+            case '\t': WriteRaw_("\\t"); break;
+            default: {
+                char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xf]};
+                buffer_.append(escaped, escaped + sizeof(escaped));
+            }
+        }
+    }
+    WriteRaw_(str.substr(plain_begin));
+    WriteRaw_("\"");
+}
+
+BinaryResultWriter::BinaryResultWriter(ResultFormat format) : format_(format) {}
+
+void BinaryResultWriter::Write(const HandDetail& hand) {
+    WriteMapHeader(hand.rus_chn ? 3 : 2);
+    WriteString("bones_detail");
+    WriteArrayHeader(hand.bones_detail.size());
+    for (const auto& bone : hand.bones_detail) {
+        WriteBone_(bone);
+    }
+    WriteString("is_valid");
+    WriteBool(hand.is_valid);
+    if (hand.rus_chn) {
+        WriteString("rus_chn");
+        WriteMapHeader(3);
+        WriteString("bone_age");
+        WriteDouble(hand.rus_chn->bone_age);
+        WriteString("sex");
+        WriteString(hand.rus_chn->sex == BoneInfo::Sex::kBoy ? "boy" : "girl");
+        WriteString("total_score");
+        WriteInt(hand.rus_chn->total_score);
+    }
+}
+
+void BinaryResultWriter::WriteBone_(const BoneDetail& bone) {
+    WriteMapHeader(4);
+    WriteString("box");
+    WriteArrayHeader(4);
+    WriteInt(bone.box.x);
+    WriteInt(bone.box.y);
+    WriteInt(bone.box.width);
+    WriteInt(bone.box.height);
+    WriteString("category_id");
+    WriteInt(bone.category_id);
+    WriteString("joint");
+    WriteString(bone.joint);
+    WriteString("maturity_stage");
+    WriteInt(bone.maturity_stage);
+}
+
+void BinaryResultWriter::WriteMapHeader(size_t size) {
+    if (format_ == ResultFormat::kCbor) {
+        WriteCborHead_(5, size);
+    } else if (size < 16) {
+        WriteByte_(0x80 | size);
+    } else if (size <= 0xffff) {
+        WriteByte_(0xde);
+        WriteBigEndian_(size, 2);
+    } else {
+        WriteByte_(0xdf);
+        WriteBigEndian_(size, 4);
+    }
+}
+
+void BinaryResultWriter::WriteArrayHeader(size_t size) {
+    if (format_ == ResultFormat::kCbor) {
+        WriteCborHead_(4, size);
+    } else if (size < 16) {
+        WriteByte_(0x90 | size);
+    } else if (size <= 0xffff) {
+        WriteByte_(0xdc);
+        WriteBigEndian_(size, 2);
+    } else {
+        WriteByte_(0xdd);
+        WriteBigEndian_(size, 4);
+    }
+}
+
+void BinaryResultWriter::WriteString(std::string_view str) {
+    size_t size = str.size();
+    if (format_ == ResultFormat::kCbor) {
+        WriteCborHead_(3, size);
+    } else if (size < 32) {
+        WriteByte_(0xa0 | size);
+    } else if (size <= 0xff) {
+        WriteByte_(0xd9);
+        WriteBigEndian_(size, 1);
+    } else if (size <= 0xffff) {
+        WriteByte_(0xda);
+        WriteBigEndian_(size, 2);
+    } else {
+        WriteByte_(0xdb);
+        WriteBigEndian_(size, 4);
+    }
+    WriteEncoded(str);
+}
+
+void BinaryResultWriter::WriteInt(int64_t value) {
+    if (format_ == ResultFormat::kCbor) {
+        // 负数 n 编码为主类型 1, 参数 -1 - n
+        if (value >= 0) {
+            WriteCborHead_(0, static_cast<uint64_t>(value));
+        } else {
+            WriteCborHead_(1, static_cast<uint64_t>(-1 - value));
+        }
+        return;
+    }
+    if (value >= 0) {
+        if (value < 128) {
+            WriteByte_(value); // positive fixint
+        } else if (value <= 0xff) {
+            WriteByte_(0xcc);
+            WriteBigEndian_(value, 1);
+        } else if (value <= 0xffff) {
+            WriteByte_(0xcd);
+            WriteBigEndian_(value, 2);
+        } else if (value <= 0xffffffff) {
+            WriteByte_(0xce);
+            WriteBigEndian_(value, 4);
+        } else {
+            WriteByte_(0xcf);
+            WriteBigEndian_(value, 8);
+        }
+    } else if (value >= -32) {
+        WriteByte_(static_cast<uint8_t>(value)); // negative fixint
+    } else if (value >= INT8_MIN) {
+        WriteByte_(0xd0);
+        WriteBigEndian_(static_cast<uint64_t>(value), 1);
+    } else if (value >= INT16_MIN) {
+        WriteByte_(0xd1);
+        WriteBigEndian_(static_cast<uint64_t>(value), 2);
+    } else if (value >= INT32_MIN) {
+        WriteByte_(0xd2);
+        WriteBigEndian_(static_cast<uint64_t>(value), 4);
+    } else {
+        WriteByte_(0xd3);
+        WriteBigEndian_(static_cast<uint64_t>(value), 8);
+    }
+}
+
+void BinaryResultWriter::WriteDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteByte_(format_ == ResultFormat::kCbor ? 0xfb : 0xcb);
+    WriteBigEndian_(bits, 8);
+}
+
+void BinaryResultWriter::WriteBool(bool value) {
+    if (format_ == ResultFormat::kCbor) {
+        WriteByte_(value ? 0xf5 : 0xf4);
+    } else {
+        WriteByte_(value ? 0xc3 : 0xc2);
+    }
+}
+
+void BinaryResultWriter::WriteCborHead_(uint8_t major, uint64_t value) {
+    major <<= 5;
+    if (value < 24) {
+        WriteByte_(major | value);
+    } else if (value <= 0xff) {
+        WriteByte_(major | 24);
+        WriteBigEndian_(value, 1);
+    } else if (value <= 0xffff) {
+        WriteByte_(major | 25);
+        WriteBigEndian_(value, 2);
+    } else if (value <= 0xffffffff) {
+        WriteByte_(major | 26);
+        WriteBigEndian_(value, 4);
+    } else {
+        WriteByte_(major | 27);
+        WriteBigEndian_(value, 8);
+    }
+}
+
+void BinaryResultWriter::WriteBigEndian_(uint64_t value, size_t bytes) {
+    char out[8];
+    for (size_t i = 0; i < bytes; i++) {
+        out[i] = static_cast<char>(value >> (8 * (bytes - 1 - i)));
+    }
+    buffer_.append(out, out + bytes);
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <fmt/format.h>
+#include "inference/hand_detail.h"
+
+namespace inference {
+
+// 返回给客户端的结果编码, 由请求的 Accept 协商
+enum class ResultFormat {
+    kJson,
+    kMsgPack,
+    kCbor,
+};
+
+// 把 HandDetail 直接写成 JSON, 不构造 nlohmann::json 的 DOM
+// 输出和之前 json(hand).dump() 逐字节一致: 紧凑格式, key 按字典序 (nlohmann 的 object 是 std::map),
+// 浮点数和 dump 一样用 Grisu2 输出, 非有限值写 null
+// 内部缓冲区可以复用, 一个线程持有一个, 不是线程安全的
+class ResultWriter {
+public:
+    // 追加到缓冲区末尾
+    void Write(const HandDetail& hand);
+
+    std::string_view View() const { return {buffer_.data(), buffer_.size()}; }
+    std::string ToString() const { return fmt::to_string(buffer_); }
+    size_t Size() const { return buffer_.size(); }
+
+    // 清空内容, 保留已经申请的内存
+    void Clear() { buffer_.clear(); }
+
+private:
+    void WriteBone_(const BoneDetail& bone);
+    void WriteRusChn_(const RusChnResult& rus_chn);
+    void WriteInt_(int value);
+    void WriteDouble_(double value);
+    void WriteString_(std::string_view str);
+    void WriteRaw_(std::string_view str) { buffer_.append(str.data(), str.data() + str.size()); }
+
+private:
+    fmt::memory_buffer buffer_;
+};
+
+// 把 HandDetail 写成 MessagePack 或 CBOR, 同样不构造 DOM
+// 结构和 key 同 JSON, 只是 box 写成 [x, y, width, height] 的整数数组; 整数用最短编码, 骨龄是 float64
+// 除了 Write, 也提供基本类型的写入, 方便调用方在结果外面再包一层 (比如批量接口的 index)
+class BinaryResultWriter {
+public:
+    explicit BinaryResultWriter(ResultFormat format);
+
+    void Write(const HandDetail& hand);
+
+    void WriteMapHeader(size_t size);
+    void WriteArrayHeader(size_t size);
+    void WriteString(std::string_view str);
+    void WriteInt(int64_t value);
+    void WriteDouble(double value);
+    void WriteBool(bool value);
+    // 已经编码好的同格式数据原样写入
+    void WriteEncoded(std::string_view data) { buffer_.append(data.data(), data.data() + data.size()); }
+
+    std::string_view View() const { return {buffer_.data(), buffer_.size()}; }
+    std::string ToString() const { return std::string(buffer_.data(), buffer_.size()); }
+    size_t Size() const { return buffer_.size(); }
+    void Clear() { buffer_.clear(); }
+
+private:
+    void WriteBone_(const BoneDetail& bone);
+    // CBOR 的头部: 3 位主类型 + 参数
+    void WriteCborHead_(uint8_t major, uint64_t value);
+    void WriteByte_(uint8_t byte) { buffer_.push_back(static_cast<char>(byte)); }
+    // 大端序
+    void WriteBigEndian_(uint64_t value, size_t bytes);
+
+private:
+    ResultFormat format_;
+    fmt::memory_buffer buffer_;
+};
+
+}
@@ -1,4 +1,5 @@
 #include "logging/logger.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 std::shared_ptr<spdlog::logger> g_logger;
@@ -18,8 +19,20 @@ spdlog::level::level_enum toSpdlogLevel(LogLevel level) {
     return spdlog::level::trace; // 默认
 }
 
+namespace {
+spdlog::async_overflow_policy toSpdlogPolicy(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::Block:         return spdlog::async_overflow_policy::block;
+        case OverflowPolicy::OverrunOldest: return spdlog::async_overflow_policy::overrun_oldest;
+        case OverflowPolicy::DiscardNew:    return spdlog::async_overflow_policy::discard_new;
+    }
+    return spdlog::async_overflow_policy::block;
+}
+}
+
 void Init(const std::string& log_dir, 
                  LogLevel level,
+                 const AsyncOptions& async,
                  int rotation_hour,
                  int rotation_minute) 
 {
@@ -27,7 +40,14 @@ void Init(const std::string& log_dir,
         fs::path log_path = fs::path(log_dir) / "log.log";
         auto daily_sink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(log_path, rotation_hour, rotation_minute);
         
-        g_logger = std::make_shared<spdlog::logger>("server_logger", daily_sink);
+        if (async.enabled) {
+            // 一个后台线程写文件, 保证日志顺序
+            spdlog::init_thread_pool(async.queue_size, 1);
+            g_logger = std::make_shared<spdlog::async_logger>("server_logger", daily_sink, spdlog::thread_pool(),
+                                                              toSpdlogPolicy(async.overflow_policy));
+        } else {
+            g_logger = std::make_shared<spdlog::logger>("server_logger", daily_sink);
+        }
 
         spdlog::register_logger(g_logger);
 
@@ -66,4 +86,12 @@ void InitConsole(LogLevel level) {
     }
 }
 
+void Shutdown() {
+    if (g_logger) {
+        g_logger->flush();
+    }
+    // 等异步队列写完并停掉后台线程, 之后不能再写日志
+    spdlog::shutdown();
+}
+
 }
\ No newline at end of file
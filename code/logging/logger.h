@@ -1,5 +1,18 @@
 #pragma once
 
+// 编译期日志级别, 低于它的 LOG_* 宏展开为空, 参数不会被求值; 数值和 LogLevel 一致
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_CRITICAL 5
+#define LOG_LEVEL_OFF 6
+
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL LOG_LEVEL_TRACE
+#endif
+
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/daily_file_sink.h"
 #include <filesystem>
@@ -22,10 +35,25 @@ enum class LogLevel {
     Off
 };
 
+// 异步日志队列满时的处理方式
+enum class OverflowPolicy {
+    Block,         // 调用线程等待, 不丢日志
+    OverrunOldest, // 覆盖队列里最旧的一条, 调用线程不等待
+    DiscardNew     // 丢掉新的一条, 调用线程不等待
+};
+
+struct AsyncOptions {
+    bool enabled = false;     // 关闭时在调用线程里同步写文件
+    size_t queue_size = 8192; // 队列里最多的日志条数
+    OverflowPolicy overflow_policy = OverflowPolicy::Block;
+};
+
 spdlog::level::level_enum toSpdlogLevel(LogLevel level);
 
+// 开启异步时调用线程只格式化参数并入队, 加前缀和写文件由后台线程完成; 程序退出前调用 Shutdown 把队列里的日志写完
 void Init(const std::string& log_dir, 
                  LogLevel level = LogLevel::Info,
+                 const AsyncOptions& async = {},
                  int rotation_hour = 0,
                  int rotation_minute = 0);
 
@@ -37,11 +65,37 @@ inline void SetLevel(LogLevel level) {
     }
 }
 
+void Shutdown();
+
 } // namespace logging
 
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_TRACE
 #define LOG_TRACE(...)    if(g_logger) { g_logger->trace(__VA_ARGS__); }
+#else
+#define LOG_TRACE(...)    ((void)0)
+#endif
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_DEBUG
 #define LOG_DEBUG(...)    if(g_logger) { g_logger->debug(__VA_ARGS__); }
+#else
+#define LOG_DEBUG(...)    ((void)0)
+#endif
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_INFO
 #define LOG_INFO(...)     if(g_logger) { g_logger->info(__VA_ARGS__); }
+#else
+#define LOG_INFO(...)     ((void)0)
+#endif
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_WARN
 #define LOG_WARN(...)     if(g_logger) { g_logger->warn(__VA_ARGS__); }
+#else
+#define LOG_WARN(...)     ((void)0)
+#endif
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_ERROR
 #define LOG_ERROR(...)    if(g_logger) { g_logger->error(__VA_ARGS__); }
-#define LOG_CRITICAL(...) if(g_logger) { g_logger->critical(__VA_ARGS__); }
\ No newline at end of file
+#else
+#define LOG_ERROR(...)    ((void)0)
+#endif
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_CRITICAL
+#define LOG_CRITICAL(...) if(g_logger) { g_logger->critical(__VA_ARGS__); }
+#else
+#define LOG_CRITICAL(...) ((void)0)
+#endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace metrics {
+
+std::atomic<size_t> Histogram::next_id_{0};
+thread_local Histogram::Shard** Histogram::tls_shards_ = nullptr;
+thread_local size_t Histogram::tls_shard_count_ = 0;
+
+namespace {
+// 真正持有线程缓存数组的地方, 只在慢路径访问, 线程退出时释放
+thread_local std::vector<void*> t_shard_slots;
+}
+
+Histogram::Histogram() : id_(next_id_.fetch_add(1, std::memory_order_relaxed)) {}
+
+Histogram::~Histogram() = default;
+
+Histogram::Shard* Histogram::CreateLocalShard_() {
+    auto shard = std::make_unique<Shard>();
+    Shard* raw = shard.get();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.push_back(std::move(shard));
+    }
+    if (t_shard_slots.size() <= id_) {
+        t_shard_slots.resize(std::max(id_ + 1, t_shard_slots.size() * 2), nullptr);
+    }
+    t_shard_slots[id_] = raw;
+    tls_shards_ = reinterpret_cast<Shard**>(t_shard_slots.data());
+    tls_shard_count_ = t_shard_slots.size();
+    return raw;
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const {
+    Snapshot snapshot;
+    snapshot.counts.assign(kBucketCount, 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < kBucketCount; i++) {
+            snapshot.counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count += shard->count.load(std::memory_order_relaxed);
+        snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, shard->max.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+uint64_t Histogram::BucketLowerBound(size_t index) {
+    if (index < 2 * kSubBucketCount) {
+        return index;
+    }
+    size_t shift = index / kSubBucketCount - 1;
+    uint64_t mantissa = kSubBucketCount + index % kSubBucketCount;
+    return mantissa << shift;
+}
+
+uint64_t Histogram::BucketUpperBound(size_t index) {
+    if (index + 1 >= kBucketCount) {
+        return UINT64_MAX;
+    }
+    return BucketLowerBound(index + 1);
+}
+
+uint64_t Histogram::Snapshot::CountBelow(uint64_t value) const {
+    uint64_t below = 0;
+    for (size_t i = 0; i < counts.size() && BucketUpperBound(i) <= value; i++) {
+        below += counts[i];
+    }
+    return below;
+}
+
+uint64_t Histogram::Snapshot::ValueAtQuantile(double q) const {
+    // 分片是分别读的, count 和各桶之和可能差几个, 以桶为准
+    uint64_t total = 0;
+    for (uint64_t c : counts) {
+        total += c;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i) - 1, max);
+        }
+    }
+    return max;
+}
+
+}
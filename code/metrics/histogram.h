@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace metrics {
+
+// HDR 风格的对数-线性直方图, 记录非负整数 (一般是纳秒)
+// 每个 2 的幂区间再均分成 16 个桶, 相对误差不超过 1/16; 超过 2^40 (约 18 分钟) 的值记进最后一个桶
+// 每个线程第一次记录时分到自己的分片, 之后只有本线程写, 不加锁也不用原子加; 读取时把所有分片合并
+// 线程退出后分片保留, 数据不丢
+class Histogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr size_t kSubBucketCount = size_t{1} << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBucketCount;
+
+    // 合并后的数据
+    struct Snapshot {
+        std::vector<uint64_t> counts; // 下标同 BucketIndex
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t max{0};
+
+        // 小于 value 的样本数, value 取桶边界时是精确值
+        uint64_t CountBelow(uint64_t value) const;
+        // q 分位所在桶的上界, 没有样本时返回 0
+        uint64_t ValueAtQuantile(double q) const;
+    };
+
+    Histogram();
+    ~Histogram();
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void Record(uint64_t value) {
+        Shard* shard = LocalShard_();
+        size_t index = BucketIndex(value);
+        // 只有本线程写这个分片, load + store 就够了, 读者最多看到稍旧的值
+        Increase_(shard->counts[index], 1);
+        Increase_(shard->count, 1);
+        Increase_(shard->sum, value);
+        if (value > shard->max.load(std::memory_order_relaxed)) {
+            shard->max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // 记录从 start 到现在的纳秒数
+    void RecordSince(std::chrono::steady_clock::time_point start) {
+        Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    Snapshot GetSnapshot() const;
+
+    static size_t BucketIndex(uint64_t value) {
+        if (value < 2 * kSubBucketCount) {
+            return value;
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        if (exponent > kMaxExponent) {
+            return kBucketCount - 1;
+        }
+        int shift = exponent - kSubBucketBits;
+        return (shift + 1) * kSubBucketCount + ((value >> shift) - kSubBucketCount);
+    }
+
+    // 桶的取值范围 [lower, upper)
+    static uint64_t BucketLowerBound(size_t index);
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+
+    static void Increase_(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    Shard* LocalShard_() {
+        if (id_ < tls_shard_count_ && tls_shards_[id_] != nullptr) {
+            return tls_shards_[id_];
+        }
+        return CreateLocalShard_();
+    }
+    Shard* CreateLocalShard_();
+
+private:
+    // 直方图的编号不复用, 已经销毁的直方图在各线程缓存里的指针不会再被访问
+    static std::atomic<size_t> next_id_;
+    // 本线程的分片, 按直方图编号索引; 用平凡类型, 访问时不经过 thread_local 的初始化检查
+    static thread_local Shard** tls_shards_;
+    static thread_local size_t tls_shard_count_;
+
+    const size_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+// 析构时把经过的纳秒数记进直方图
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() { histogram_.RecordSince(start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}
@@ -0,0 +1,134 @@
+#include "registry.h"
+#include <fmt/format.h>
+
+namespace metrics {
+
+namespace {
+
+void AppendLabelValue(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+}
+
+// {a="1",b="2"}, extra 是直方图额外的 le 标签
+void AppendLabels(std::string& out, const Labels& labels, const char* extra_name = nullptr, const std::string& extra_value = {}) {
+    if (labels.empty() && extra_name == nullptr) {
+        return;
+    }
+    out += '{';
+    bool first = true;
+    for (const auto& [name, value] : labels) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        out += name;
+        out += "=\"";
+        AppendLabelValue(out, value);
+        out += '"';
+    }
+    if (extra_name != nullptr) {
+        if (!first) {
+            out += ',';
+        }
+        out += extra_name;
+        out += "=\"";
+        out += extra_value;
+        out += '"';
+    }
+    out += '}';
+}
+
+}
+
+const std::vector<uint64_t>& Registry::BucketBounds() {
+    static const std::vector<uint64_t> bounds = []() {
+        std::vector<uint64_t> bounds;
+        for (int exponent = 10; exponent <= 36; exponent++) {
+            bounds.push_back(uint64_t{1} << exponent);
+            bounds.push_back(uint64_t{3} << (exponent - 1));
+        }
+        return bounds;
+    }();
+    return bounds;
+}
+
+Histogram& Registry::GetHistogram(const std::string& name, const std::string& help, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family& family = families_[name];
+    if (family.help.empty()) {
+        family.help = help;
+    }
+    for (auto& series : family.histograms) {
+        if (series.labels == labels) {
+            return *series.histogram;
+        }
+    }
+    family.histograms.push_back({labels, std::make_unique<Histogram>()});
+    return *family.histograms.back().histogram;
+}
+
+void Registry::SetGauge(const std::string& name, const std::string& help, GaugeCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family& family = families_[name];
+    family.help = help;
+    family.gauge = std::move(callback);
+}
+
+void Registry::SetGauge(const std::string& name, const std::string& help, std::function<double()> callback) {
+    SetGauge(name, help, GaugeCallback([callback = std::move(callback)]() {
+        return std::vector<Sample>{{{}, callback()}};
+    }));
+}
+
+std::string Registry::Render() const {
+    std::string out;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, family] : families_) {
+        out += fmt::format("# HELP {} {}\n", name, family.help);
+        if (family.gauge) {
+            out += fmt::format("# TYPE {} gauge\n", name);
+            for (const auto& sample : family.gauge()) {
+                out += name;
+                AppendLabels(out, sample.labels);
+                out += fmt::format(" {}\n", sample.value);
+            }
+            continue;
+        }
+        out += fmt::format("# TYPE {} histogram\n", name);
+        for (const auto& series : family.histograms) {
+            Histogram::Snapshot snapshot = series.histogram->GetSnapshot();
+            uint64_t total = 0;
+            for (uint64_t c : snapshot.counts) {
+                total += c;
+            }
+            for (uint64_t bound : BucketBounds()) {
+                out += name;
+                out += "_bucket";
+                AppendLabels(out, series.labels, "le", fmt::format("{}", bound / 1e9));
+                out += fmt::format(" {}\n", snapshot.CountBelow(bound));
+            }
+            out += name;
+            out += "_bucket";
+            AppendLabels(out, series.labels, "le", "+Inf");
+            out += fmt::format(" {}\n", total);
+            out += name;
+            out += "_sum";
+            AppendLabels(out, series.labels);
+            out += fmt::format(" {}\n", snapshot.sum / 1e9);
+            out += name;
+            out += "_count";
+            AppendLabels(out, series.labels);
+            out += fmt::format(" {}\n", total);
+        }
+    }
+    return out;
+}
+
+}
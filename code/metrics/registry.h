@@ -0,0 +1,67 @@
+#pragma once
+
+#include "histogram.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// 进程内所有指标, 按 Prometheus 文本格式 (0.0.4) 输出
+// 直方图由注册表持有, 同名同标签返回同一个, 引用在进程内一直有效, 适合存在函数内的 static 里
+// gauge 是回调, 抓取时在调用 Render 的线程里持锁执行, 回调自己保证线程安全, 不能再访问注册表
+class Registry {
+public:
+    struct Sample {
+        Labels labels;
+        double value;
+    };
+    using GaugeCallback = std::function<std::vector<Sample>()>;
+
+    static Registry& GetInstance() {
+        static Registry instance;
+        return instance;
+    }
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    // 直方图的单位是纳秒, 输出时换算成秒
+    Histogram& GetHistogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    // 一个 family 的所有样本由一个回调给出, 适合数量会变的 (比如每个 IO 线程一个); 重复注册时替换
+    void SetGauge(const std::string& name, const std::string& help, GaugeCallback callback);
+    void SetGauge(const std::string& name, const std::string& help, std::function<double()> callback);
+
+    std::string Render() const;
+
+    // 输出的直方图桶边界 (纳秒): 1us 到约 100s, 每个 2 的幂区间两个, 都落在内部桶的边界上
+    static const std::vector<uint64_t>& BucketBounds();
+
+private:
+    Registry() = default;
+
+    struct HistogramSeries {
+        Labels labels;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family {
+        std::string help;
+        std::vector<HistogramSeries> histograms;
+        GaugeCallback gauge; // 为空表示这是直方图 family
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+}
+
+#define METRICS metrics::Registry::GetInstance()
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "registry.h"
+#include <string>
+
+namespace metrics {
+
+// 推理流水线每个阶段的耗时, 用 stage 标签区分
+// queue / decode / serialize 每张图一个样本, 其余每个 batch 一个; *_run 只算 session.Run 本身, 不含等锁
+inline Histogram& InferenceStage(const std::string& stage) {
+    return METRICS.GetHistogram("boneage_stage_duration_seconds",
+                                "Time spent in each stage of the bone age inference pipeline.",
+                                {{"stage", stage}});
+}
+
+// HTTP 层每个请求的解析、路由 (含同步执行的处理函数) 和发送耗时
+inline Histogram& HttpStage(const std::string& stage) {
+    return METRICS.GetHistogram("http_stage_duration_seconds",
+                                "Time spent parsing, routing and sending each HTTP request.",
+                                {{"stage", stage}});
+}
+
+}
@@ -4,22 +4,25 @@
 #include <fcntl.h>
 #include <stdexcept>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
+#include "logging/logger.h"
+#include "tracing/tracer.h"
 
 namespace net {
 
-static int OpenIdleFd() {
-    return ::open("/dev/null", O_RDONLY | O_CLOEXEC);
-}
-
 Acceptor::Acceptor(EventLoop* loop, const InetAddress& listen_addr, bool reuse_port)
     : loop_(loop)
     , accept_socket_(Socket::CreateNonblockingTCP())
-    , idle_fd_(OpenIdleFd()) {
+    , retry_timer_fd_(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+    , window_start_ns_(NowNs_()) {
 
     if (!accept_socket_.IsValid()) {
         throw std::runtime_error("Acceptor CreateNonblockingTCP failed");
     }
+    if (retry_timer_fd_ < 0) {
+        throw std::runtime_error("Acceptor timerfd_create failed");
+    }
 
     accept_socket_.SetReuseAddr(true);
     if (reuse_port) {
@@ -32,27 +35,77 @@ Acceptor::Acceptor(EventLoop* loop, const InetAddress& listen_addr, bool reuse_p
 
     accept_channel_ = std::make_unique<Channel>(loop, accept_socket_.GetFd());
     accept_channel_->SetReadCallback([this]() { HandleRead_(); });
+
+    retry_channel_ = std::make_unique<Channel>(loop, retry_timer_fd_);
+    retry_channel_->SetReadCallback([this]() { HandleRetryTimer_(); });
 }
 
 Acceptor::~Acceptor() {
     accept_channel_->DisableAll();
-    if (idle_fd_ >= 0) { ::close(idle_fd_); idle_fd_ = -1; }
+    retry_channel_->DisableAll();
+    ::close(retry_timer_fd_);
 }
 
 void Acceptor::Listen() {
     if (listening_) return;
     listening_ = true;
     accept_socket_.Listen();
-    accept_channel_->EnableReading();
+    retry_channel_->EnableReading();
+    UpdateAccepting_();
+}
+
+void Acceptor::StopAccepting() {
+    loop_->AssertInLoopThread();
+    limit_paused_ = true;
+    UpdateAccepting_();
+}
+
+void Acceptor::StartAccepting() {
+    loop_->AssertInLoopThread();
+    limit_paused_ = false;
+    UpdateAccepting_();
+}
+
+void Acceptor::UpdateAccepting_() {
+    bool accepting = listening_ && !limit_paused_ && !fd_paused_;
+    if (accepting == accepting_) return;
+    accepting_ = accepting;
+    if (accepting) {
+        accept_channel_->EnableReading();
+    } else {
+        paused_.fetch_add(1, std::memory_order_relaxed);
+        accept_channel_->DisableReading();
+    }
+}
+
+AcceptStats Acceptor::GetStats() const {
+    // 窗口超过 1 秒没有滚动说明这段时间没有 accept (空闲或暂停), 把空闲时间算进去, 速率逐渐降到 0
+    double rate = accepts_per_sec_.load(std::memory_order_relaxed);
+    double elapsed = (NowNs_() - window_start_ns_.load(std::memory_order_relaxed)) / 1e9;
+    if (elapsed >= 1.0) {
+        rate = window_accepted_.load(std::memory_order_relaxed) / elapsed;
+    }
+    return {accepted_.load(std::memory_order_relaxed),
+            rounds_.load(std::memory_order_relaxed),
+            paused_.load(std::memory_order_relaxed),
+            fd_exhausted_.load(std::memory_order_relaxed),
+            rate,
+            accepting_};
 }
 
 void Acceptor::HandleRead_() {
     loop_->AssertInLoopThread();
-    for (;;) {
+    TRACE_SPAN("net", "accept", 0);
+    rounds_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t accepted = 0;
+
+    // 回调中可能因为达到连接数上限而 StopAccepting, 此时立即停止
+    while (accepting_ && accepted < kMaxAcceptPerRound) {
         InetAddress peer_addr;
         Socket conn_sock = accept_socket_.Accept(&peer_addr);
 
         if (conn_sock.IsValid()) {
+            accepted++;
             if (new_connection_callback_) new_connection_callback_(conn_sock.Release(), peer_addr);
             continue;
         }
@@ -62,13 +115,46 @@ void Acceptor::HandleRead_() {
         if (e == EINTR || e == ECONNABORTED) continue; // 被信号中断/客户端断开, 重试
 
         if (e == EMFILE || e == ENFILE) { // 文件描述符数量达到上限
-            ::close(idle_fd_);
-            idle_fd_ = ::accept(accept_socket_.GetFd(), nullptr, nullptr);
-            ::close(idle_fd_);
-            idle_fd_ = OpenIdleFd();
+            // 暂停 accept, 连接留在 backlog 里, kFdRetryDelayMs 后重试; 还是不够再暂停
+            fd_exhausted_.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN("Acceptor fd exhausted, retry in {} ms", kFdRetryDelayMs);
+            fd_paused_ = true;
+            UpdateAccepting_();
+            struct itimerspec spec{};
+            spec.it_value.tv_nsec = kFdRetryDelayMs * 1000 * 1000;
+            ::timerfd_settime(retry_timer_fd_, 0, &spec, nullptr);
             break;
         }
+        LOG_ERROR("Acceptor accept error: {}", e);
+        break;
     }
+
+    accepted_.fetch_add(accepted, std::memory_order_relaxed);
+    UpdateRate_(accepted);
+}
+
+void Acceptor::HandleRetryTimer_() {
+    loop_->AssertInLoopThread();
+    uint64_t expirations;
+    ::read(retry_timer_fd_, &expirations, sizeof(expirations));
+    fd_paused_ = false;
+    UpdateAccepting_(); // 监听 fd 是水平触发, backlog 里还有连接时下一轮就会进 HandleRead_
 }
 
-}
\ No newline at end of file
+void Acceptor::UpdateRate_(uint64_t accepted) {
+    uint64_t window_accepted = window_accepted_.load(std::memory_order_relaxed) + accepted;
+    int64_t now = NowNs_();
+    double elapsed = (now - window_start_ns_.load(std::memory_order_relaxed)) / 1e9;
+    if (elapsed >= 1.0) {
+        accepts_per_sec_.store(window_accepted / elapsed, std::memory_order_relaxed);
+        window_start_ns_.store(now, std::memory_order_relaxed);
+        window_accepted = 0;
+    }
+    window_accepted_.store(window_accepted, std::memory_order_relaxed);
+}
+
+int64_t Acceptor::NowNs_() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include "net/eventloop.h"
 #include "socket.h"
@@ -10,6 +12,15 @@ namespace net {
 class EventLoop;
 class InetAddress;
 
+struct AcceptStats {
+    uint64_t accepted;        // 累计接受的连接数
+    uint64_t rounds;          // 可读事件次数, accepted / rounds 即平均每批接受的连接数
+    uint64_t paused;          // 因连接数上限或 fd 不足暂停 accept 的次数
+    uint64_t fd_exhausted;    // EMFILE / ENFILE 的次数
+    double accepts_per_sec;   // 最近一秒左右的速率, 空闲或暂停时逐渐降到 0
+    bool accepting;
+};
+
 class Acceptor {
 public:
     using NewConnectionCallback = std::function<void(int sockfd, const InetAddress&)>;
@@ -26,17 +37,49 @@ public:
     // main reactor io线程执行
     void Listen();
 
+    // 暂停/恢复 accept, 暂停期间新连接留在内核的 backlog 中
+    // 都在 main reactor io线程执行; fd 不足引起的暂停由 Acceptor 自己定时重试, 和这里的暂停互不影响
+    void StopAccepting();
+    void StartAccepting();
+    bool IsAccepting() const { return accepting_; }
+
+    AcceptStats GetStats() const;
+
     int GetFd() const { return accept_socket_.GetFd(); }
 
 private:
     void HandleRead_();
+    void HandleRetryTimer_();
+    // 按 listening_ / 两种暂停状态打开或关闭监听 fd 的读事件
+    void UpdateAccepting_();
+    void UpdateRate_(uint64_t accepted);
+    static int64_t NowNs_();
 
     EventLoop* loop_;
     Socket accept_socket_;
     std::unique_ptr<Channel> accept_channel_;
     NewConnectionCallback new_connection_callback_;
     bool listening_{false};
-    int idle_fd_{-1};
+    bool limit_paused_{false}; // TcpServer 因连接数上限暂停
+    bool fd_paused_{false};    // EMFILE / ENFILE 暂停, 等重试定时器
+    std::atomic<bool> accepting_{false};
+
+    // fd 不足时不依赖连接关闭来恢复: 占满 fd 的可能不是连接, 关闭的连接 fd 也可能还没释放
+    int retry_timer_fd_;
+    std::unique_ptr<Channel> retry_channel_;
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> rounds_{0};
+    std::atomic<uint64_t> paused_{0};
+    std::atomic<uint64_t> fd_exhausted_{0};
+    // 速率窗口: loop 线程在 UpdateRate_ 中滚动, GetStats 读取时如果窗口已经超过 1 秒没有滚动, 按实际经过的时间重新算
+    std::atomic<double> accepts_per_sec_{0.0};
+    std::atomic<int64_t> window_start_ns_;
+    std::atomic<uint64_t> window_accepted_{0};
+
+    // 一次可读事件最多接受的连接数, 避免 accept 风暴时长时间占住 main reactor
+    static constexpr int kMaxAcceptPerRound = 256;
+    static constexpr int kFdRetryDelayMs = 100;
 };
 
-}
\ No newline at end of file
+}
@@ -1,4 +1,6 @@
 #include "buffer.h"
+#include "bufferpool.h"
+#include <algorithm>
 #include <string_view>
 #include <sys/uio.h>
 #include <unistd.h>
@@ -6,14 +8,53 @@
 
 namespace net {
 
-Buffer::Buffer(size_t init_size) : buffer_(init_size), read_index_(0), write_index_(0) {}
+Buffer::Buffer(size_t init_size, std::shared_ptr<BufferPool> pool)
+    : read_index_(0), write_index_(0), pool_(std::move(pool)) {
+    if (init_size > 0) {
+        Reallocate_(init_size);
+    }
+}
+
+Buffer::~Buffer() {
+    FreeStorage_();
+}
+
+Buffer::Buffer(Buffer&& other) noexcept
+    : buffer_(other.buffer_),
+      capacity_(other.capacity_),
+      read_index_(other.read_index_),
+      write_index_(other.write_index_),
+      read_size_hint_(other.read_size_hint_),
+      pool_(std::move(other.pool_)) {
+    other.buffer_ = nullptr;
+    other.capacity_ = 0;
+    other.read_index_ = 0;
+    other.write_index_ = 0;
+}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        FreeStorage_();
+        buffer_ = other.buffer_;
+        capacity_ = other.capacity_;
+        read_index_ = other.read_index_;
+        write_index_ = other.write_index_;
+        read_size_hint_ = other.read_size_hint_;
+        pool_ = std::move(other.pool_);
+        other.buffer_ = nullptr;
+        other.capacity_ = 0;
+        other.read_index_ = 0;
+        other.write_index_ = 0;
+    }
+    return *this;
+}
 
 size_t Buffer::ReadableBytes() const {
     return write_index_ - read_index_;
 }
 
 size_t Buffer::WriteableBytes() const {
-    return buffer_.size() - write_index_;
+    return capacity_ - write_index_;
 }
 
 size_t Buffer::PrependableBytes() const {
@@ -32,10 +73,13 @@ void Buffer::Retrieve(size_t len) {
     }
 }
 
-// TODO: 收缩内存
 void Buffer::RetrieveAll() {
     read_index_ = 0;
     write_index_ = 0;
+    // 收缩内存: 处理完大报文后不再长期占用
+    if (capacity_ > kMaxIdleSize) {
+        FreeStorage_();
+    }
 }
 
 std::string Buffer::RetrieveAllToString() {
@@ -44,6 +88,14 @@ std::string Buffer::RetrieveAllToString() {
     return str;
 }
 
+void Buffer::ReleaseIfEmpty() {
+    if (ReadableBytes() == 0) {
+        read_index_ = 0;
+        write_index_ = 0;
+        FreeStorage_();
+    }
+}
+
 char* Buffer::BeginWrite() {
     return Begin_() + write_index_;
 }
@@ -69,27 +121,27 @@ void Buffer::Append(std::string_view str) {
 void Buffer::Append(const char* data, size_t len) {
     EnsureWriteable(len);
     std::copy(data, data + len, BeginWrite());
-    HasWritten(len);   
+    HasWritten(len);
 }
 
 ssize_t Buffer::ReadFd(int fd, int* saved_errno) {
-    char extra_buffer[65536];
-    struct iovec vec[2];
-
+    // 直接读进缓冲区, 不再借助栈上的 64KB 临时数组
+    // epoll 是水平触发, 一次没读完下一轮还会再通知
+    EnsureWriteable(read_size_hint_);
     const size_t writeable = WriteableBytes();
-    vec[0].iov_base = BeginWrite();
-    vec[0].iov_len = writeable;
-    vec[1].iov_base = extra_buffer;
-    vec[1].iov_len = sizeof(extra_buffer);
 
-    ssize_t n = readv(fd, vec, 2);
+    ssize_t n = ::read(fd, BeginWrite(), writeable);
     if (n < 0) {
         *saved_errno = errno;
-    } else if (static_cast<size_t>(n) <= writeable) {
-        HasWritten(n);
-    } else {
-        HasWritten(writeable);
-        Append(extra_buffer, n - writeable);
+        return n;
+    }
+    HasWritten(n);
+
+    // 读满说明报文较大, 下次多读一些; 读得很少就逐步回落
+    if (static_cast<size_t>(n) == writeable) {
+        read_size_hint_ = std::min(read_size_hint_ * 2, kMaxReadSize);
+    } else if (static_cast<size_t>(n) < read_size_hint_ / 4) {
+        read_size_hint_ = std::max(read_size_hint_ / 2, kMinReadSize);
     }
     return n;
 }
@@ -105,16 +157,17 @@ ssize_t Buffer::WriteFd(int fd, int* saved_errno) {
 }
 
 char* Buffer::Begin_() {
-    return &buffer_[0];
+    return buffer_;
 }
 
 const char* Buffer::Begin_() const {
-    return &buffer_[0];
+    return buffer_;
 }
 
 void Buffer::MakeSpace_(size_t len) {
     if (PrependableBytes() + WriteableBytes() < len) {
-        buffer_.resize(write_index_ + len);
+        // 按 2 倍增长, 避免大报文反复拷贝
+        Reallocate_(std::max(write_index_ - read_index_ + len, capacity_ * 2));
     } else { // 内部挪腾
         size_t readable = ReadableBytes();
         std::copy(Begin_() + read_index_, Begin_() + write_index_, Begin_());
@@ -123,4 +176,38 @@ void Buffer::MakeSpace_(size_t len) {
     }
 }
 
-}
\ No newline at end of file
+// 申请一块新内存并把可读数据搬过去, 旧内存归还
+void Buffer::Reallocate_(size_t len) {
+    size_t readable = ReadableBytes();
+    size_t new_capacity = 0;
+    char* new_buffer = nullptr;
+    if (pool_) {
+        new_buffer = pool_->Acquire(len, &new_capacity);
+    } else {
+        new_capacity = BufferPool::RoundUp(len);
+        new_buffer = BufferPool::AllocateBlock(new_capacity);
+    }
+    if (readable > 0) {
+        std::copy(Begin_() + read_index_, Begin_() + write_index_, new_buffer);
+    }
+    FreeStorage_();
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+    read_index_ = 0;
+    write_index_ = readable;
+}
+
+void Buffer::FreeStorage_() {
+    if (buffer_ == nullptr) {
+        return;
+    }
+    if (pool_) {
+        pool_->Release(buffer_, capacity_);
+    } else {
+        BufferPool::FreeBlock(buffer_);
+    }
+    buffer_ = nullptr;
+    capacity_ = 0;
+}
+
+}
@@ -3,17 +3,33 @@
 #include <string>
 #include <string_view>
 #include <atomic>
+#include <memory>
 
 namespace net {
 
+class BufferPool;
+
 class Buffer {
 public:
-    explicit Buffer(size_t init_size = 1024);
-    ~Buffer() = default;
+    static constexpr size_t kInitialSize = 1024;
+    static constexpr size_t kMaxIdleSize = 64 * 1024;       // RetrieveAll 后超过这个容量就收缩
+    static constexpr size_t kMinReadSize = 4 * 1024;
+    static constexpr size_t kMaxReadSize = 256 * 1024;
+
+    // init_size 为 0 时延迟到第一次写入再申请内存
+    explicit Buffer(size_t init_size = kInitialSize, std::shared_ptr<BufferPool> pool = nullptr);
+    ~Buffer();
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    Buffer(Buffer&& other) noexcept;
+    Buffer& operator=(Buffer&& other) noexcept;
 
     size_t ReadableBytes() const;
-    size_t WriteableBytes() const;       
+    size_t WriteableBytes() const;
     size_t PrependableBytes() const;
+    size_t Capacity() const { return capacity_; }
 
     const char* Peek() const;
 
@@ -22,6 +38,9 @@ public:
     void RetrieveAll() ;
     std::string RetrieveAllToString();
 
+    // 没有可读数据时把内存块还给 pool, 空闲连接不占用缓冲区
+    void ReleaseIfEmpty();
+
     char* BeginWrite();
     const char* BeginWriteConst() const;
 
@@ -31,18 +50,26 @@ public:
     void Append(std::string_view str);
     void Append(const char* data, size_t len);
 
+    // 每次读取的大小根据上一次的读取量自适应调整
     ssize_t ReadFd(int fd, int* saved_errno);
     ssize_t WriteFd(int fd, int* saved_errno);
 
+    size_t ReadSizeHint() const { return read_size_hint_; }
+
 private:
     char* Begin_();  // 整个buffer的起始指针
     const char* Begin_() const;
     void MakeSpace_(size_t len);
+    void Reallocate_(size_t len);
+    void FreeStorage_();
 
 private:
-    std::vector<char> buffer_;
+    char* buffer_{nullptr};
+    size_t capacity_{0};
     size_t read_index_;  // 读的下标
     size_t write_index_; // 写的下标
+    size_t read_size_hint_{kMinReadSize};
+    std::shared_ptr<BufferPool> pool_;
 };
 
 }
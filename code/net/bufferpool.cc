@@ -0,0 +1,76 @@
+#include "bufferpool.h"
+#include <new>
+
+namespace net {
+
+BufferPool::BufferPool() : owner_(std::this_thread::get_id()) {}
+
+BufferPool::~BufferPool() {
+    for (auto& list : free_lists_) {
+        for (char* block : list) {
+            FreeBlock(block);
+        }
+    }
+}
+
+size_t BufferPool::RoundUp(size_t size) {
+    if (size > kMaxBlockSize) {
+        return size;
+    }
+    size_t capacity = kMinBlockSize;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+int BufferPool::ClassIndex_(size_t capacity) {
+    if (capacity > kMaxBlockSize) {
+        return -1;
+    }
+    int index = 0;
+    for (size_t c = kMinBlockSize; c < capacity; c <<= 1) {
+        index++;
+    }
+    return index;
+}
+
+char* BufferPool::AllocateBlock(size_t capacity) {
+    return static_cast<char*>(::operator new(capacity));
+}
+
+void BufferPool::FreeBlock(char* block) {
+    ::operator delete(block);
+}
+
+char* BufferPool::Acquire(size_t size, size_t* capacity) {
+    *capacity = RoundUp(size);
+    int index = ClassIndex_(*capacity);
+    if (index >= 0 && IsOwnerThread_()) {
+        auto& list = free_lists_[index];
+        if (!list.empty()) {
+            char* block = list.back();
+            list.pop_back();
+            cached_bytes_ -= *capacity;
+            return block;
+        }
+    }
+    return AllocateBlock(*capacity);
+}
+
+void BufferPool::Release(char* block, size_t capacity) {
+    if (block == nullptr) {
+        return;
+    }
+    int index = ClassIndex_(capacity);
+    // 大块、跨线程释放、或者该级别缓存已满, 直接还给堆
+    if (index < 0 || RoundUp(capacity) != capacity || !IsOwnerThread_() ||
+        (free_lists_[index].size() + 1) * capacity > kMaxCachedBytesPerClass) {
+        FreeBlock(block);
+        return;
+    }
+    free_lists_[index].push_back(block);
+    cached_bytes_ += capacity;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace net {
+
+// 每个 EventLoop 一个, 按尺寸分级缓存 Buffer 的内存块
+// 只有所属线程可以把内存块放回缓存, 其他线程释放时直接还给堆, 所以不需要加锁
+class BufferPool {
+public:
+    static constexpr size_t kMinBlockSize = 1024;         // 最小级别 1 KB
+    static constexpr size_t kMaxBlockSize = 1024 * 1024;  // 最大级别 1 MB, 更大的块不缓存
+    static constexpr size_t kNumClasses = 11;             // 1K, 2K, ..., 1M
+    static constexpr size_t kMaxCachedBytesPerClass = 4 * 1024 * 1024;
+
+    BufferPool();
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 申请至少 size 字节, 实际容量通过 capacity 返回
+    char* Acquire(size_t size, size_t* capacity);
+    void Release(char* block, size_t capacity);
+
+    // 把 size 向上取整到所属级别
+    static size_t RoundUp(size_t size);
+
+    // 不经过缓存的分配, 用于没有绑定 pool 的 Buffer
+    static char* AllocateBlock(size_t capacity);
+    static void FreeBlock(char* block);
+
+    size_t CachedBytes() const { return cached_bytes_; }
+
+private:
+    static int ClassIndex_(size_t capacity);
+    bool IsOwnerThread_() const { return owner_ == std::this_thread::get_id(); }
+
+    const std::thread::id owner_;
+    std::array<std::vector<char*>, kNumClasses> free_lists_;
+    size_t cached_bytes_{0};
+};
+
+}
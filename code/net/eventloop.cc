@@ -1,7 +1,9 @@
 #include "eventloop.h"
 #include "epoller.h"
 #include "channel.h"
+#include "bufferpool.h"
 #include <cassert>
+#include <chrono>
 #include <memory>
 #include <stdexcept>
 #include <sys/eventfd.h>
@@ -25,10 +27,12 @@ int CreateEventFd() {
 EventLoop::EventLoop()
     : looping_(false),
       quit_(false),
+      calling_pending_functors_(false),
       thread_id_(std::this_thread::get_id()),
       poller_(std::make_unique<Epoller>()),
       wakeup_fd_(CreateEventFd()),
-      wakeup_channel_(std::make_unique<Channel>(this, wakeup_fd_)) {
+      wakeup_channel_(std::make_unique<Channel>(this, wakeup_fd_)),
+      buffer_pool_(std::make_shared<BufferPool>()) {
     
     wakeup_channel_->SetReadCallback([this] { this->HandleRead_(); });
     wakeup_channel_->EnableReading();
@@ -38,24 +42,33 @@ EventLoop::~EventLoop() {
     wakeup_channel_->DisableAll();
     UpdateChannel(wakeup_channel_.get());
     ::close(wakeup_fd_);
+    while (PendingFunctor* node = pending_functors_.Pop()) {
+        delete node;
+    }
 }
 
 void EventLoop::Loop() {
     AssertInLoopThread();
     looping_ = true;
-    quit_ = false;
+    // 不在这里重置 quit_: 其他线程可能在 Loop() 开始前就已经调用了 Quit()
 
     Epoller::ChannelList active_channels;
 
     while (!quit_) {
         active_channels.clear();
         poller_->Poll(-1, &active_channels);
+        auto busy_start = std::chrono::steady_clock::now();
 
         for (Channel* channel : active_channels) {
             channel->HandleEvent();
         }
 
         DoPendingFunctors_();
+
+        auto busy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - busy_start).count();
+        load_.busy_ns.fetch_add(busy_ns, std::memory_order_relaxed);
+        load_.iterations.fetch_add(1, std::memory_order_relaxed);
     }
     looping_ = false;
 }
@@ -77,13 +90,13 @@ void EventLoop::RunInLoop(Functor cb) {
 }
 
 void EventLoop::QueueInLoop(Functor cb) {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        pending_functors_.push_back(std::move(cb));
-    }
+    pending_functors_.Push(new PendingFunctor{std::move(cb)});
 
+    // 只有 loop 处理完上一批之后的第一次投递才写 eventfd
     if (!IsInLoopThread() || calling_pending_functors_) {
-        Wakeup_();
+        if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+            Wakeup_();
+        }
     }
 }
 
@@ -96,6 +109,7 @@ void EventLoop::HandleRead_() {
     uint64_t one = 1;
     ssize_t n = ::read(wakeup_fd_, &one, sizeof(one));
     assert(n == sizeof(one));
+    wakeup_count_.fetch_add(1, std::memory_order_relaxed);
 }
 
 void EventLoop::Wakeup_() {
@@ -105,16 +119,24 @@ void EventLoop::Wakeup_() {
 }
 
 void EventLoop::DoPendingFunctors_() {
-    std::vector<Functor> functors;
     calling_pending_functors_ = true;
-
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        functors.swap(pending_functors_);
+    // 先清除标志再取任务: 之后入队的任务一定会重新唤醒 loop
+    // acq_rel 保证看到设置标志的生产者已经入队的任务
+    wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+
+    // 限制单轮执行数量, 防止任务不断投递新任务时饿死 IO 事件
+    size_t executed = 0;
+    while (executed < kMaxFunctorsPerRound) {
+        PendingFunctor* node = pending_functors_.Pop();
+        if (node == nullptr) {
+            break;
+        }
+        node->functor();
+        delete node;
+        executed++;
     }
-
-    for (const Functor& functor : functors) {
-        functor();
+    if (executed == kMaxFunctorsPerRound && !wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+        Wakeup_();
     }
     calling_pending_functors_ = false;
 }
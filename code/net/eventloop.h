@@ -4,12 +4,22 @@
 #include <vector>
 #include <memory>
 #include <thread>
-#include <mutex>
+#include <atomic>
+#include "mpscqueue.h"
 
 namespace net {
 
 class Epoller;
 class Channel;
+class BufferPool;
+
+// 每个 loop 的负载计数, 由 TcpConnection 维护, 供 EventLoopThreadPool 挑选 loop
+struct LoopLoad {
+    std::atomic<int64_t> connections{0};   // 当前连接数
+    std::atomic<int64_t> pending_bytes{0}; // 输入/输出缓冲区中待处理的字节数
+    std::atomic<uint64_t> busy_ns{0};      // 处理事件和任务的累计时间
+    std::atomic<uint64_t> iterations{0};
+};
 
 class EventLoop {
 public:
@@ -35,13 +45,27 @@ public:
 
     bool IsInLoopThread() const { return thread_id_ == std::this_thread::get_id(); }
 
+    // 本 loop 上的连接共用的缓冲区内存池
+    const std::shared_ptr<BufferPool>& GetBufferPool() const { return buffer_pool_; }
+
+    LoopLoad& GetLoad() { return load_; }
+    const LoopLoad& GetLoad() const { return load_; }
+
+    // eventfd 被唤醒的次数
+    uint64_t GetWakeupCount() const { return wakeup_count_.load(std::memory_order_relaxed); }
+
 private:
+    struct PendingFunctor {
+        Functor functor;
+        std::atomic<PendingFunctor*> next{nullptr};
+    };
+
     void HandleRead_(); // 用于 eventfd
     void Wakeup_();
     void DoPendingFunctors_();
 
     bool looping_;
-    bool quit_;
+    std::atomic<bool> quit_;
     bool calling_pending_functors_;
     const std::thread::id thread_id_; // 创建该对象的线程ID
 
@@ -50,8 +74,17 @@ private:
     int wakeup_fd_;
     std::unique_ptr<Channel> wakeup_channel_;
 
-    std::mutex mutex_;
-    std::vector<Functor> pending_functors_;
+    std::shared_ptr<BufferPool> buffer_pool_;
+
+    // 跨线程投递的任务, 无锁入队, 只在 loop 线程出队
+    MpscQueue<PendingFunctor> pending_functors_;
+    // 已经写过 eventfd 且 loop 还没处理时为 true, 期间的投递不再重复唤醒
+    std::atomic<bool> wakeup_pending_{false};
+    std::atomic<uint64_t> wakeup_count_{0};
+
+    LoopLoad load_;
+
+    static constexpr size_t kMaxFunctorsPerRound = 4096;
 };
 
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "eventloopthread.h"
 #include "eventloop.h"
 #include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include "logging/logger.h"
 
 namespace net {
 
@@ -22,6 +25,18 @@ EventLoop* EventLoopThread::StartLoop() {
 }
 
 void EventLoopThread::Run_() {
+    if (!cpus_.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (int cpu : cpus_) {
+            CPU_SET(cpu, &cpu_set);
+        }
+        int err = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (err != 0) {
+            LOG_WARN("EventLoopThread set cpu affinity failed, err={}", err);
+        }
+    }
+
     EventLoop loop;
 
     std::unique_lock<std::mutex> lock(mutex_);
@@ -2,6 +2,7 @@
 
 #include <condition_variable>
 #include <thread>
+#include <vector>
 
 namespace net {
 
@@ -15,6 +16,9 @@ public:
     EventLoopThread(const EventLoopThread&) = delete;
     EventLoopThread& operator=(const EventLoopThread&) = delete;
 
+    // 在 StartLoop 之前调用, 把 loop 线程绑定到给定的 CPU 集合上
+    void SetCpuAffinity(std::vector<int> cpus) { cpus_ = std::move(cpus); }
+
     EventLoop* StartLoop();
 
 private:
@@ -22,6 +26,7 @@ private:
 
 private:
     EventLoop* loop_{nullptr};
+    std::vector<int> cpus_;
     
     std::thread loop_thread_;
 
@@ -29,4 +34,4 @@ private:
     std::condition_variable loop_cv_;
 };
 
-}
\ No newline at end of file
+}
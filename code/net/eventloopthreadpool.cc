@@ -1,9 +1,49 @@
 #include "eventloopthreadpool.h"
 #include "eventloopthread.h"
+#include "eventloop.h"
 #include "net/channel.h"
+#include "logging/logger.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 namespace net {
 
+namespace {
+// 解析 /sys 中形如 "0-3,8-11" 的 CPU 列表
+std::vector<int> ParseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<std::vector<int>> ReadNumaNodes() {
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0;; node++) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            break;
+        }
+        std::string list;
+        std::getline(file, list);
+        nodes.push_back(ParseCpuList(list));
+    }
+    return nodes;
+}
+} // namespace
+
 EventLoopThreadPool::EventLoopThreadPool(int loop_count) : loop_count_(loop_count) {}
 
 EventLoopThreadPool::~EventLoopThreadPool() = default;
@@ -11,17 +51,111 @@ EventLoopThreadPool::~EventLoopThreadPool() = default;
 void EventLoopThreadPool::Start() {
     for (int i = 0; i < loop_count_; i++) {
         auto thread = std::make_unique<EventLoopThread>();
+        thread->SetCpuAffinity(CpusForLoop_(i));
         loops_.emplace_back(thread->StartLoop());
         loop_threads_.emplace_back(std::move(thread));
     }
 }
 
+std::vector<int> EventLoopThreadPool::CpusForLoop_(int index) const {
+    switch (affinity_) {
+        case LoopAffinity::kCore: {
+            int cpu_count = static_cast<int>(std::thread::hardware_concurrency());
+            if (cpu_count <= 0) {
+                return {};
+            }
+            return {index % cpu_count};
+        }
+        case LoopAffinity::kNumaNode: {
+            static const std::vector<std::vector<int>> nodes = ReadNumaNodes();
+            if (nodes.empty()) {
+                LOG_WARN("no NUMA node found, io thread {} not pinned", index);
+                return {};
+            }
+            return nodes[index % nodes.size()];
+        }
+        case LoopAffinity::kNone:
+            break;
+    }
+    return {};
+}
+
 EventLoop* EventLoopThreadPool::GetNextLoop() {
     if (loops_.empty()) {
         return nullptr;
     }
+    switch (policy_) {
+        case LoopSelectPolicy::kLeastConnections:
+            return SelectLeastConnections_();
+        case LoopSelectPolicy::kLeastPendingBytes:
+            return SelectLeastPendingBytes_();
+        case LoopSelectPolicy::kPowerOfTwoChoices:
+            return SelectPowerOfTwo_();
+        case LoopSelectPolicy::kRoundRobin:
+            break;
+    }
     int current_index = next_.fetch_add(1);
     return loops_[current_index % loops_.size()];
 }
 
-}
\ No newline at end of file
+EventLoop* EventLoopThreadPool::SelectLeastConnections_() const {
+    EventLoop* best = loops_[0];
+    int64_t best_connections = best->GetLoad().connections.load(std::memory_order_relaxed);
+    for (size_t i = 1; i < loops_.size(); i++) {
+        int64_t connections = loops_[i]->GetLoad().connections.load(std::memory_order_relaxed);
+        if (connections < best_connections) {
+            best = loops_[i];
+            best_connections = connections;
+        }
+    }
+    return best;
+}
+
+EventLoop* EventLoopThreadPool::SelectLeastPendingBytes_() const {
+    EventLoop* best = loops_[0];
+    const LoopLoad& best_load = best->GetLoad();
+    int64_t best_bytes = best_load.pending_bytes.load(std::memory_order_relaxed);
+    int64_t best_connections = best_load.connections.load(std::memory_order_relaxed);
+    for (size_t i = 1; i < loops_.size(); i++) {
+        const LoopLoad& load = loops_[i]->GetLoad();
+        int64_t bytes = load.pending_bytes.load(std::memory_order_relaxed);
+        int64_t connections = load.connections.load(std::memory_order_relaxed);
+        // 积压字节相同时 (比如都是 0) 再看连接数
+        if (bytes < best_bytes || (bytes == best_bytes && connections < best_connections)) {
+            best = loops_[i];
+            best_bytes = bytes;
+            best_connections = connections;
+        }
+    }
+    return best;
+}
+
+EventLoop* EventLoopThreadPool::SelectPowerOfTwo_() {
+    if (loops_.size() == 1) {
+        return loops_[0];
+    }
+    std::uniform_int_distribution<size_t> dist(0, loops_.size() - 1);
+    size_t a = dist(rng_);
+    size_t b = dist(rng_);
+    while (b == a) {
+        b = dist(rng_);
+    }
+    int64_t connections_a = loops_[a]->GetLoad().connections.load(std::memory_order_relaxed);
+    int64_t connections_b = loops_[b]->GetLoad().connections.load(std::memory_order_relaxed);
+    return connections_a <= connections_b ? loops_[a] : loops_[b];
+}
+
+std::vector<LoopStats> EventLoopThreadPool::GetStats() const {
+    std::vector<LoopStats> stats;
+    stats.reserve(loops_.size());
+    for (EventLoop* loop : loops_) {
+        const LoopLoad& load = loop->GetLoad();
+        stats.push_back({load.connections.load(std::memory_order_relaxed),
+                         load.pending_bytes.load(std::memory_order_relaxed),
+                         load.busy_ns.load(std::memory_order_relaxed),
+                         load.iterations.load(std::memory_order_relaxed)});
+    }
+    return stats;
+}
+
+}
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <random>
 
 namespace net {
 
@@ -10,6 +11,28 @@ class EventLoop;
 
 class EventLoopThread;
 
+// 新连接分配到哪个 sub-reactor
+enum class LoopSelectPolicy {
+    kRoundRobin,
+    kLeastConnections,   // 当前连接数最少
+    kLeastPendingBytes,  // 缓冲区积压字节最少
+    kPowerOfTwoChoices,  // 随机选两个, 取连接数少的
+};
+
+// IO 线程的 CPU 绑定方式
+enum class LoopAffinity {
+    kNone,
+    kCore,      // 第 i 个 loop 绑定到第 i 个 CPU
+    kNumaNode,  // 第 i 个 loop 绑定到第 i 个 NUMA 节点的所有 CPU
+};
+
+struct LoopStats {
+    int64_t connections;
+    int64_t pending_bytes;
+    uint64_t busy_ns;
+    uint64_t iterations;
+};
+
 class EventLoopThreadPool {
 public:
     explicit EventLoopThreadPool(int loop_count);
@@ -18,14 +41,31 @@ public:
     EventLoopThreadPool(const EventLoopThreadPool&) = delete;
     EventLoopThreadPool& operator=(const EventLoopThreadPool&) = delete;
 
+    void SetSelectPolicy(LoopSelectPolicy policy) { policy_ = policy; }
+    // 在 Start 之前调用
+    void SetAffinity(LoopAffinity affinity) { affinity_ = affinity; }
+
     void Start();
+    // 只在 main reactor 线程中调用
     EventLoop* GetNextLoop();
 
+    const std::vector<EventLoop*>& GetLoops() const { return loops_; }
+    std::vector<LoopStats> GetStats() const;
+
 private:
+    EventLoop* SelectLeastConnections_() const;
+    EventLoop* SelectLeastPendingBytes_() const;
+    EventLoop* SelectPowerOfTwo_();
+    std::vector<int> CpusForLoop_(int index) const;
+
     int loop_count_;
     std::vector<std::unique_ptr<EventLoopThread>> loop_threads_;
     std::vector<EventLoop*> loops_;
     std::atomic<int> next_{0};
+
+    LoopSelectPolicy policy_{LoopSelectPolicy::kRoundRobin};
+    LoopAffinity affinity_{LoopAffinity::kNone};
+    std::minstd_rand rng_{std::random_device{}()};
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+
+namespace net {
+
+// 侵入式无锁多生产者单消费者队列 (Vyukov MPSC)
+// Node 需要有成员 std::atomic<Node*> next, 队列不负责节点的内存
+// Push 可以在任意线程调用, Pop 只能在唯一的消费者线程调用
+template <typename Node>
+class MpscQueue {
+public:
+    MpscQueue() : head_(&stub_), tail_(&stub_) {
+        stub_.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(Node* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        // prev 和 node 链接之前, 消费者会看到队列暂时 "断开", Pop 返回 nullptr
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 队列为空或生产者正在入队时返回 nullptr
+    Node* Pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        // 只剩最后一个节点, 把 stub 放回去才能把它取出来
+        Push(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    bool Empty() const {
+        return tail_ == &stub_ && stub_.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    alignas(64) std::atomic<Node*> head_; // 生产者端
+    alignas(64) Node* tail_;              // 消费者端
+    Node stub_;
+};
+
+}
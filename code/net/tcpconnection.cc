@@ -6,17 +6,19 @@
 #include <utility>
 #include <unistd.h>
 #include "logging/logger.h"
+#include "tracing/tracer.h"
 
 namespace net {
 
-TcpConnection::TcpConnection(EventLoop* loop, int sockfd, const std::string& name, const InetAddress& local_addr, const InetAddress& peer_addr)
+TcpConnection::TcpConnection(EventLoop* loop, int sockfd, uint64_t id, const InetAddress& peer_addr)
     : loop_(loop),
+      id_(id),
       state_(State::kConnecting),
       socket_(std::make_unique<Socket>(sockfd)),
-      name_(name),
       channel_(std::make_unique<Channel>(loop, sockfd)),
-      local_addr_(local_addr),
-      peer_addr_(peer_addr) {
+      peer_addr_(peer_addr),
+      input_buffer_(0, loop->GetBufferPool()),
+      output_buffer_(0, loop->GetBufferPool()) {
 
     channel_->SetReadCallback([this] { this->HandleRead_(); });
     channel_->SetWriteCallback([this] { this->HandleWrite_(); });
@@ -24,10 +26,45 @@ TcpConnection::TcpConnection(EventLoop* loop, int sockfd, const std::string& nam
     channel_->SetErrorCallback([this] { this->HandleError_(); });
 
     socket_->SetKeepAlive(true);
+
+    // 在挑选 loop 之后立即计数, 避免突发连接时都挑中同一个 loop
+    loop_->GetLoad().connections.fetch_add(1, std::memory_order_relaxed);
+    load_counted_ = true;
 }
 
 TcpConnection::~TcpConnection() {
     LOG_DEBUG("TcpConnection::~TcpConnection() at {} fd={}", static_cast<void*>(this), channel_->GetFd());
+    ReleaseLoad_();
+}
+
+void TcpConnection::UpdatePendingBytes_() {
+    int64_t pending = static_cast<int64_t>(input_buffer_.ReadableBytes() + output_buffer_.ReadableBytes());
+    if (pending != reported_pending_bytes_) {
+        loop_->GetLoad().pending_bytes.fetch_add(pending - reported_pending_bytes_, std::memory_order_relaxed);
+        reported_pending_bytes_ = pending;
+    }
+}
+
+void TcpConnection::ReleaseLoad_() {
+    if (load_counted_) {
+        load_counted_ = false;
+        LoopLoad& load = loop_->GetLoad();
+        load.connections.fetch_sub(1, std::memory_order_relaxed);
+        load.pending_bytes.fetch_sub(reported_pending_bytes_, std::memory_order_relaxed);
+        reported_pending_bytes_ = 0;
+    }
+}
+
+const InetAddress& TcpConnection::GetLocalAddress() const {
+    if (!local_addr_resolved_) {
+        struct sockaddr_in local{};
+        socklen_t addrlen = sizeof(local);
+        if (::getsockname(channel_->GetFd(), reinterpret_cast<struct sockaddr*>(&local), &addrlen) == 0) {
+            local_addr_.SetSockAddr(local);
+        }
+        local_addr_resolved_ = true;
+    }
+    return local_addr_;
 }
 
 bool TcpConnection::IsConnected() const {
@@ -55,10 +92,12 @@ void TcpConnection::ConnectDestroyed() {
         }
     }
     loop_->UpdateChannel(channel_.get());
+    ReleaseLoad_();
 }
 
 void TcpConnection::HandleRead_() {
     loop_->AssertInLoopThread();
+    TRACE_SPAN("net", "read", id_);
     int saved_errno = 0;
     ssize_t n = input_buffer_.ReadFd(channel_->GetFd(), &saved_errno);
 
@@ -67,6 +106,9 @@ void TcpConnection::HandleRead_() {
         if (message_callback_) {
             message_callback_(shared_from_this(), input_buffer_);
         }
+        // 报文处理完了就把内存还给 pool, 保持长连接的空闲开销很小
+        input_buffer_.ReleaseIfEmpty();
+        UpdatePendingBytes_();
     } else if (n == 0) {
         // 对端关闭连接
         HandleClose_();
@@ -131,6 +173,9 @@ void TcpConnection::SendInLoop_(const void* data, size_t len) {
         nwrote = ::write(channel_->GetFd(), data, len);
         if (nwrote >= 0) {
             remaining = len - nwrote;
+            if (remaining == 0) {
+                TRACE_INSTANT("net", "write_done", id_);
+            }
             if (remaining == 0 && write_complete_callback_) {
                 // 数据一次性发送完毕，调用写完成回调
                 loop_->QueueInLoop([ptr = shared_from_this()]() {
@@ -154,6 +199,7 @@ void TcpConnection::SendInLoop_(const void* data, size_t len) {
         if (!channel_->IsWriting()) {
             channel_->EnableWriting();
         }
+        UpdatePendingBytes_();
     }
 }
 
@@ -163,8 +209,11 @@ void TcpConnection::HandleWrite_() {
         ssize_t n = ::write(channel_->GetFd(), output_buffer_.Peek(), output_buffer_.ReadableBytes());
         if (n > 0) {
             output_buffer_.Retrieve(n);
+            UpdatePendingBytes_();
             if (output_buffer_.ReadableBytes() == 0) {
                 channel_->DisableWriting();
+                output_buffer_.ReleaseIfEmpty();
+                TRACE_INSTANT("net", "write_done", id_);
                 if (write_complete_callback_) {
                      loop_->QueueInLoop([ptr = shared_from_this()]() {
                         ptr->write_complete_callback_(ptr);
@@ -189,6 +238,20 @@ void TcpConnection::Shutdown() {
     }
 }
 
+void TcpConnection::StopReading() {
+    loop_->AssertInLoopThread();
+    if (state_ != State::kDisconnected && channel_->IsReading()) {
+        channel_->DisableReading();
+    }
+}
+
+void TcpConnection::StartReading() {
+    loop_->AssertInLoopThread();
+    if (state_ != State::kDisconnected && !channel_->IsReading()) {
+        channel_->EnableReading();
+    }
+}
+
 void TcpConnection::ShutdownInLoop_() {
     loop_->AssertInLoopThread();
     if (!channel_->IsWriting()) { // 只有当没有数据待发送时才关闭写端
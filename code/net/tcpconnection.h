@@ -22,7 +22,7 @@ public:
     using CloseCallback = std::function<void(const Ptr&)>;
     using WriteCompleteCallback = std::function<void(const Ptr&)>;
 
-    TcpConnection(EventLoop* loop, int sockfd, const std::string& name, const InetAddress& local_addr, const InetAddress& peer_addr);
+    TcpConnection(EventLoop* loop, int sockfd, uint64_t id, const InetAddress& peer_addr);
     ~TcpConnection();
 
     void Send(const void* data, size_t len);
@@ -30,6 +30,12 @@ public:
     void Send(Buffer& buf);
     void Shutdown();
 
+    // 暂停/恢复读事件, 暂停期间数据留在内核里, 对端被 TCP 流控挡住; 都在 IO 线程调用
+    void StopReading();
+    void StartReading();
+    // 收到了但消息回调还没取走的数据, 恢复读之后应用层自己回头处理; 只在 IO 线程访问
+    Buffer& GetInputBuffer() { return input_buffer_; }
+
     // 通过回调添加到server中之后调用
     void ConnectEstablished();
     // 从server中删除后调用
@@ -37,8 +43,9 @@ public:
 
     bool IsConnected() const;
     EventLoop* GetLoop() const { return loop_; }
-    const std::string& GetName() const { return name_; }
-    const InetAddress& GetLocalAddress() const { return local_addr_; }
+    uint64_t GetId() const { return id_; }
+    // 第一次调用时才 getsockname
+    const InetAddress& GetLocalAddress() const;
     const InetAddress& GetPeerAddress() const { return peer_addr_; }
 
     void SetContext(const std::any& context) { context_ = context; }
@@ -66,14 +73,19 @@ private:
     void SendInLoop_(const void* data, size_t len);
     void ShutdownInLoop_();
 
+    // 把缓冲区积压字节数的变化同步到 loop 的负载计数
+    void UpdatePendingBytes_();
+    void ReleaseLoad_();
+
     EventLoop* loop_;
-    const std::string name_;
+    const uint64_t id_;
     State state_;
     
     std::unique_ptr<Socket> socket_;
     std::unique_ptr<Channel> channel_;
 
-    const InetAddress local_addr_;
+    mutable InetAddress local_addr_;
+    mutable bool local_addr_resolved_{false};
     const InetAddress peer_addr_;
 
     ConnectionCallback connection_callback_;
@@ -84,6 +96,9 @@ private:
     Buffer input_buffer_;
     Buffer output_buffer_;
 
+    bool load_counted_{false};
+    int64_t reported_pending_bytes_{0};
+
     std::any context_;
 };
 
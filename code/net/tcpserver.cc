@@ -5,6 +5,7 @@
 #include <cassert>
 #include <memory>
 #include <string>
+#include <unistd.h>
 
 namespace net {
 
@@ -23,9 +24,11 @@ TcpServer::TcpServer(const InetAddress& listen_addr, const std::string& name)
 
 TcpServer::~TcpServer() {
     loop_->AssertInLoopThread();
-    for (auto& item : connections_) {
-        TcpConnection::Ptr conn(item.second);
-        item.second.reset();
+    for (auto& slot : connection_slots_) {
+        if (!slot.conn) {
+            continue;
+        }
+        TcpConnection::Ptr conn(std::move(slot.conn));
         conn->GetLoop()->RunInLoop([conn]() {
             conn->ConnectDestroyed();
         });
@@ -40,6 +43,8 @@ void TcpServer::SetThreadNum(int num_threads) {
 void TcpServer::Start() {
     if (!started_) {
         started_ = true;
+        thread_pool_->SetSelectPolicy(loop_select_policy_);
+        thread_pool_->SetAffinity(loop_affinity_);
         thread_pool_->Start();
         loop_->RunInLoop([this]() {
             acceptor_->Listen();
@@ -48,26 +53,83 @@ void TcpServer::Start() {
     loop_->Loop();
 }
 
-// 在 main Reactor 中执行
-void TcpServer::NewConnection_(int sockfd, const InetAddress& peer_addr) {
-    loop_->AssertInLoopThread();
-    
+EventLoop* TcpServer::SelectLoop_() {
     // 从线程池中挑选一个 sub-reactor
     EventLoop* io_loop = thread_pool_->GetNextLoop();
     if (io_loop == nullptr) { // 如果没有设置线程池，就使用 main reactor
         io_loop = loop_.get();
     }
+    if (max_connections_per_loop_ == 0 || LoopConnections_(io_loop) < max_connections_per_loop_) {
+        return io_loop;
+    }
+    // 选中的 loop 已满, 退而选连接最少的
+    EventLoop* best = nullptr;
+    size_t best_count = max_connections_per_loop_;
+    for (EventLoop* loop : thread_pool_->GetLoops()) {
+        size_t count = LoopConnections_(loop);
+        if (count < best_count) {
+            best = loop;
+            best_count = count;
+        }
+    }
+    return best;
+}
 
-    std::string conn_name = name_ + "#" + std::to_string(next_conn_id_++);
-    
-    // 获取本地地址
-    struct sockaddr_in local;
-    socklen_t addrlen = sizeof(local);
-    ::getsockname(sockfd, (struct sockaddr*)&local, &addrlen);
-    InetAddress local_addr(local);
+// 单 loop 的连接数直接用 LoopLoad, 新连接在 TcpConnection 构造时就已计入
+size_t TcpServer::LoopConnections_(EventLoop* loop) {
+    return static_cast<size_t>(loop->GetLoad().connections.load(std::memory_order_relaxed));
+}
+
+bool TcpServer::HasCapacity_() const {
+    if (max_connections_ > 0 && connection_count_ >= max_connections_) {
+        return false;
+    }
+    if (max_connections_per_loop_ == 0) {
+        return true;
+    }
+    auto loop_has_room = [this](EventLoop* loop) {
+        return LoopConnections_(loop) < max_connections_per_loop_;
+    };
+    const auto& loops = thread_pool_->GetLoops();
+    if (loops.empty()) {
+        return loop_has_room(loop_.get());
+    }
+    for (EventLoop* loop : loops) {
+        if (loop_has_room(loop)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    TcpConnection::Ptr conn = std::make_shared<TcpConnection>(io_loop, sockfd, conn_name, local_addr, peer_addr);
-    connections_[conn_name] = conn;
+uint64_t TcpServer::AllocateSlot_() {
+    uint32_t index;
+    if (!free_slots_.empty()) {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(connection_slots_.size());
+        connection_slots_.emplace_back();
+    }
+    return (static_cast<uint64_t>(connection_slots_[index].generation) << 32) | index;
+}
+
+// 在 main Reactor 中执行
+void TcpServer::NewConnection_(int sockfd, const InetAddress& peer_addr) {
+    loop_->AssertInLoopThread();
+
+    EventLoop* io_loop = SelectLoop_();
+    if (io_loop == nullptr) {
+        // 正常情况下达到上限时已经暂停 accept, 不会走到这里
+        ::close(sockfd);
+        acceptor_->StopAccepting();
+        return;
+    }
+
+    uint64_t id = AllocateSlot_();
+    TcpConnection::Ptr conn = std::make_shared<TcpConnection>(io_loop, sockfd, id, peer_addr);
+    connection_slots_[static_cast<uint32_t>(id)].conn = conn;
+    connection_count_++;
 
     conn->SetConnectionCallback(connection_callback_);
     conn->SetMessageCallback(message_callback_);
@@ -76,6 +138,10 @@ void TcpServer::NewConnection_(int sockfd, const InetAddress& peer_addr) {
             this->RemoveConnection_(c);
         }
     );
+
+    if (!HasCapacity_()) {
+        acceptor_->StopAccepting();
+    }
     
     // 在 sub-reactor 线程中执行连接建立
     io_loop->RunInLoop([conn]() {
@@ -91,13 +157,30 @@ void TcpServer::RemoveConnection_(const TcpConnection::Ptr& conn) {
 
 void TcpServer::RemoveConnectionInLoop_(const TcpConnection::Ptr& conn) {
     loop_->AssertInLoopThread();
-    
-    size_t n = connections_.erase(conn->GetName());
-    assert(n == 1);
+
+    uint32_t index = static_cast<uint32_t>(conn->GetId());
+    assert(index < connection_slots_.size() && connection_slots_[index].conn == conn);
+    connection_slots_[index].conn.reset();
+    connection_slots_[index].generation++;
+    free_slots_.push_back(index);
+    connection_count_--;
+
+    // 只解除连接数上限引起的暂停; fd 不足的暂停由 Acceptor 定时重试, 这时连接的 fd 还没关闭
+    if (HasCapacity_()) {
+        acceptor_->StartAccepting();
+    }
 
     EventLoop* io_loop = conn->GetLoop();
-    io_loop->QueueInLoop([conn]() {
+    io_loop->QueueInLoop([this, conn]() {
         conn->ConnectDestroyed();
+        if (max_connections_per_loop_ > 0) {
+            // 单 loop 的连接数在 ConnectDestroyed 里才减掉, 回到 main reactor 再检查一次
+            loop_->QueueInLoop([this]() {
+                if (HasCapacity_()) {
+                    acceptor_->StartAccepting();
+                }
+            });
+        }
     });
 }
 
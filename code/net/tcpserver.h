@@ -1,15 +1,15 @@
 #pragma once
 
 #include "tcpconnection.h"
+#include "eventloopthreadpool.h"
+#include "acceptor.h"
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace net {
 
 class EventLoop;
-class Acceptor;
-class EventLoopThreadPool;
 
 class TcpServer {
 public:
@@ -21,6 +21,16 @@ public:
 
     // 设置 sub-reactor (IO 线程) 的数量
     void SetThreadNum(int num_threads);
+    // 新连接分配 sub-reactor 的策略和 IO 线程的 CPU 绑定, 在 Start 之前调用
+    void SetLoopSelectPolicy(LoopSelectPolicy policy) { loop_select_policy_ = policy; }
+    void SetLoopAffinity(LoopAffinity affinity) { loop_affinity_ = affinity; }
+    // 连接数上限, 0 表示不限制; 达到上限后暂停 accept, 有连接关闭后恢复
+    void SetMaxConnections(size_t max_connections) { max_connections_ = max_connections; }
+    void SetMaxConnectionsPerLoop(size_t max_connections) { max_connections_per_loop_ = max_connections; }
+
+    // 每个 sub-reactor 的连接数和繁忙时间, 可以在任意线程调用
+    std::vector<LoopStats> GetLoopStats() const { return thread_pool_->GetStats(); }
+    AcceptStats GetAcceptStats() const { return acceptor_->GetStats(); }
 
     void Start();
 
@@ -32,7 +42,17 @@ private:
     void RemoveConnection_(const TcpConnection::Ptr& conn);
     void RemoveConnectionInLoop_(const TcpConnection::Ptr& conn);
 
-    using ConnectionMap = std::unordered_map<std::string, TcpConnection::Ptr>;
+    // 挑选一个没达到单 loop 上限的 sub-reactor, 都满了返回 nullptr
+    EventLoop* SelectLoop_();
+    bool HasCapacity_() const;
+    static size_t LoopConnections_(EventLoop* loop);
+
+    // 连接按整数 id 存放在 slot 数组里: 低 32 位是下标, 高 32 位是 slot 的复用代数
+    struct ConnectionSlot {
+        TcpConnection::Ptr conn;
+        uint32_t generation{0};
+    };
+    uint64_t AllocateSlot_();
 
     std::unique_ptr<EventLoop> loop_;
     const std::string name_;
@@ -43,9 +63,15 @@ private:
     TcpConnection::ConnectionCallback connection_callback_;
     TcpConnection::MessageCallback message_callback_;
 
+    LoopSelectPolicy loop_select_policy_{LoopSelectPolicy::kRoundRobin};
+    LoopAffinity loop_affinity_{LoopAffinity::kNone};
+    size_t max_connections_{0};
+    size_t max_connections_per_loop_{0};
+
     bool started_{false};
-    int next_conn_id_{1};
-    ConnectionMap connections_;
+    std::vector<ConnectionSlot> connection_slots_;
+    std::vector<uint32_t> free_slots_;
+    size_t connection_count_{0};
 };
 
 } // namespace net
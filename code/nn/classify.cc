@@ -1,10 +1,14 @@
 #include "classify.h"
-#include <execution>
+#include "model_cache.h"
 #include <numeric>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <stdexcept>
 #include <algorithm>
 #include <cmath>
 #include "logging/logger.h"
+#include "metrics/stages.h"
+#include "tracing/tracer.h"
 #include <fmt/ranges.h>
 #include "bone_info.h"
 
@@ -15,7 +19,8 @@ MaturityClassifier::MaturityClassifier(
     const std::string& model_path,
     bool use_gpu, 
     const cv::Size& input_size,
-    const std::vector<size_t>& warmup_batch_sizes)
+    const std::vector<size_t>& warmup_batch_sizes,
+    const std::string& model_cache_dir)
     : env_(env),
       session_(nullptr),
       input_size_(input_size)
@@ -25,12 +30,14 @@ MaturityClassifier::MaturityClassifier(
     session_options.SetIntraOpNumThreads(1);
     session_options.SetInterOpNumThreads(1);
     session_options.SetExecutionMode(ORT_SEQUENTIAL);
+    // QDQ 量化模型要靠图优化把 Q/DQ 节点和卷积融合成 int8 kernel
+    session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
     if (use_gpu) {
         OrtCUDAProviderOptions cuda_options;
         cuda_options.device_id = 0;
         session_options.AppendExecutionProvider_CUDA(cuda_options);
     }
-    session_ = Ort::Session(*env_, model_path.c_str(), session_options);
+    session_ = ModelCache(model_cache_dir).CreateSession(*env_, model_path, session_options, use_gpu);
 
     // 获取节点信息
     LOG_DEBUG("获取节点信息");
@@ -140,7 +147,12 @@ std::vector<ClassificationResult> MaturityClassifier::Classify(const std::vector
     if (images.empty()) {
         return {};
     }
+    static auto& preprocess_histogram = metrics::InferenceStage("classify_preprocess");
+    static auto& run_histogram = metrics::InferenceStage("classify_run");
+    static auto& postprocess_histogram = metrics::InferenceStage("classify_postprocess");
+
     LOG_DEBUG("running classification inference");
+    auto preprocess_start = std::chrono::steady_clock::now();
 
     const size_t batch_size = images.size();
 
@@ -163,23 +175,30 @@ std::vector<ClassificationResult> MaturityClassifier::Classify(const std::vector
     ));
     const char* input_names[] = {image_input_name_str_.c_str(), category_id_input_name_str_.c_str()};
     const char* output_names[] = {output_name_str_.c_str()};
+    preprocess_histogram.RecordSince(preprocess_start);
     // run inference
     LOG_DEBUG("running onnxruntime session");
     std::vector<Ort::Value> output_tensors;
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        metrics::ScopedTimer timer(run_histogram); // 不含等锁的时间
+        TRACE_SPAN("nn", "classify_run", 0);
         output_tensors = session_.Run(Ort::RunOptions{nullptr}, input_names, input_tensors.data(), 2, output_names, 1);
     }
     LOG_DEBUG("onnxruntime session done");
     LOG_DEBUG("running postprocess");
+    metrics::ScopedTimer postprocess_timer(postprocess_histogram);
     std::vector<ClassificationResult> batch_results(batch_size);
     const float* output_data_ptr = output_tensors[0].GetTensorData<float>();
     const int num_total_stages = output_dims_[1];
 
-    for (int i = 0; i < batch_size; i++) {
-        const float* single_output_data = output_data_ptr + i * num_total_stages;
-        batch_results[i] = Postprocess_(single_output_data, category_ids[i]);
-    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batch_size),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                const float* single_output_data = output_data_ptr + i * num_total_stages;
+                batch_results[i] = Postprocess_(single_output_data, category_ids[i]);
+            }
+        });
     LOG_DEBUG("classification inference done, batch size: {}", batch_size);
 
     return batch_results;
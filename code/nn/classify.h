@@ -21,7 +21,8 @@ public:
                        const std::string& model_path,
                        bool use_gpu, 
                        const cv::Size& input_size,
-                       const std::vector<size_t>& warmup_batch_sizes = {});
+                       const std::vector<size_t>& warmup_batch_sizes = {},
+                       const std::string& model_cache_dir = "");
 
     MaturityClassifier(const MaturityClassifier&) = delete;
     MaturityClassifier& operator=(const MaturityClassifier&) = delete;
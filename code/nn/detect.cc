@@ -1,4 +1,5 @@
 #include "detect.h"
+#include "model_cache.h"
 #include "onnxruntime_cxx_api.h"
 #include <algorithm>
 #include <bits/stdint-intn.h>
@@ -6,9 +7,11 @@
 #include <opencv2/core/types.hpp>
 #include <opencv2/core/utility.hpp>
 #include <opencv2/flann.hpp>
-#include <numeric>
-#include <execution>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include "logging/logger.h"
+#include "metrics/stages.h"
+#include "tracing/tracer.h"
 #include <fmt/format.h>
 #include <stdexcept>
 #include <fmt/ranges.h>
@@ -16,7 +19,7 @@
 
 namespace nn {
 
-YOLO11Detector::YOLO11Detector(std::shared_ptr<Ort::Env> env, const std::string& model_path, bool use_gpu, const cv::Size& input_size, const std::vector<size_t>& warmup_batch_sizes)
+YOLO11Detector::YOLO11Detector(std::shared_ptr<Ort::Env> env, const std::string& model_path, bool use_gpu, const cv::Size& input_size, const std::vector<size_t>& warmup_batch_sizes, const std::string& model_cache_dir)
     : env_(env),
       session_(nullptr),
       input_size_(input_size)
@@ -26,13 +29,15 @@ YOLO11Detector::YOLO11Detector(std::shared_ptr<Ort::Env> env, const std::string&
     session_options.SetIntraOpNumThreads(1);
     session_options.SetInterOpNumThreads(1);
     session_options.SetExecutionMode(ORT_SEQUENTIAL);
+    // int8 模型的 Q/DQ 节点在 ORT_ENABLE_ALL 下才会和卷积融合
+    session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
     if (use_gpu) {
         OrtCUDAProviderOptions cuda_options;
         cuda_options.device_id = 0;
         session_options.AppendExecutionProvider_CUDA(cuda_options);
     }
     // session_options.DisableMemPattern();
-    session_ = Ort::Session(*env_, model_path.c_str(), session_options);
+    session_ = ModelCache(model_cache_dir).CreateSession(*env_, model_path, session_options, use_gpu);
 
     // 获取输入/输出节点信息
     auto input_name_ptr = session_.GetInputNameAllocated(0, allocator_);
@@ -73,22 +78,25 @@ std::vector<std::vector<DetectionResult>> YOLO11Detector::Detect(const std::vect
     if (images.empty()) {
         return {};
     }
+    static auto& preprocess_histogram = metrics::InferenceStage("detect_preprocess");
+    static auto& run_histogram = metrics::InferenceStage("detect_run");
+    static auto& postprocess_histogram = metrics::InferenceStage("detect_postprocess");
+
     LOG_DEBUG("running detection inference");
+    auto preprocess_start = std::chrono::steady_clock::now();
     const size_t batch_size = images.size();
     std::vector<cv::Mat> preprocessed_imgs(batch_size);
     std::vector<float> scales(batch_size);
     std::vector<cv::Size> original_sizes(batch_size);
     
-    // std::vector<size_t> indices(batch_size);
-    // std::iota(indices.begin(), indices.end(), 0);
-    // std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
-    //     blobs[i] = Preprocess_(images[i], scales[i]);
-    //     original_sizes[i] = images[i].size();
-    // });
-    for (int i = 0; i < batch_size; i++) {
-        preprocessed_imgs[i] = Preprocess_(images[i], scales[i]);
-        original_sizes[i] = images[i].size();
-    }
+    // 逐图 letterbox, 在调用方所在的 task_arena 里并行
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batch_size),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                preprocessed_imgs[i] = Preprocess_(images[i], scales[i]);
+                original_sizes[i] = images[i].size();
+            }
+        });
     cv::Mat batch_blob = cv::dnn::blobFromImages(
         preprocessed_imgs,
         1.0 / 255.0, // 归一化到[0,1]
@@ -112,10 +120,13 @@ std::vector<std::vector<DetectionResult>> YOLO11Detector::Detect(const std::vect
         memory_info, batch_blob.ptr<float>(), batch_blob.total(), batch_input_dims.data(), batch_input_dims.size()
     ));
     // 有且只有一个输出通道：output_tensors[0].size = [batch_size, num_attributes, num_proposals] = [bs, 7 + 4 = 11, 8400]
+    preprocess_histogram.RecordSince(preprocess_start);
     LOG_DEBUG("running onnxruntime session");
     std::vector<Ort::Value> output_tensors;
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        metrics::ScopedTimer timer(run_histogram); // 不含等锁的时间
+        TRACE_SPAN("nn", "detect_run", 0);
         output_tensors = session_.Run(
             Ort::RunOptions{nullptr},
             input_names,
@@ -127,20 +138,19 @@ std::vector<std::vector<DetectionResult>> YOLO11Detector::Detect(const std::vect
     }
     LOG_DEBUG("onnxruntime session done");
     LOG_DEBUG("running postprocess");
+    metrics::ScopedTimer postprocess_timer(postprocess_histogram);
     std::vector<std::vector<DetectionResult>> batch_results(batch_size);
     const float* output_data = output_tensors[0].GetTensorData<float>();
     const int num_attributes = output_dims_[1];
     const int num_proposals = output_dims_[2];
-    // std::for_each(std::execution::par, indices.begin(), indices.end(),
-    //     [&](size_t i) {
-    //         const float* single_output_data = output_data + i * num_proposals * num_attributes;
-    //         batch_results[i] = Postprocess_(single_output_data, scales[i], original_sizes[i]);
-    //     }
-    // );
-    for (int i = 0; i < batch_size; i++) {
-        const float* single_output_data = output_data + i * num_proposals * num_attributes;
-        batch_results[i] = Postprocess_(single_output_data, scales[i], original_sizes[i]);
-    }
+    // 每张图的解码 + NMS 只读自己那段输出, 可以并行
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, batch_size),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                const float* single_output_data = output_data + i * num_proposals * num_attributes;
+                batch_results[i] = Postprocess_(single_output_data, scales[i], original_sizes[i]);
+            }
+        });
     LOG_DEBUG("detection inference done, batch size: {}", batch_size);
     return batch_results;
 }
@@ -15,7 +15,7 @@ struct DetectionResult {
 
 class YOLO11Detector {
 public:
-    YOLO11Detector(std::shared_ptr<Ort::Env> env, const std::string& model_path, bool use_gpu, const cv::Size& input_size, const std::vector<size_t>& warmup_batch_sizes = {});
+    YOLO11Detector(std::shared_ptr<Ort::Env> env, const std::string& model_path, bool use_gpu, const cv::Size& input_size, const std::vector<size_t>& warmup_batch_sizes = {}, const std::string& model_cache_dir = "");
 
     YOLO11Detector(const YOLO11Detector&) = delete;
     YOLO11Detector& operator=(const YOLO11Detector&) = delete;
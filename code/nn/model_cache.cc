@@ -0,0 +1,107 @@
+#include "model_cache.h"
+#include "logging/logger.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#include <fmt/format.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace nn {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t Fnv1a(const char* data, size_t size, uint64_t hash = kFnvOffset) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// 模型文件内容的哈希, 模型重新导出后路径不变也能失效
+uint64_t HashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("cannot open model " + path);
+    }
+    std::vector<char> buffer(1 << 20);
+    uint64_t hash = kFnvOffset;
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        hash = Fnv1a(buffer.data(), file.gcount(), hash);
+    }
+    return hash;
+}
+
+// NCHWc 等布局优化按 CPU 指令集选块大小, 换了 CPU 缓存就不能用
+uint64_t HashCpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            return Fnv1a(line.data(), line.size());
+        }
+    }
+    return 0;
+}
+
+}
+
+std::string ModelCache::CachedModelPath(const std::string& model_path, bool use_gpu) const {
+    static const uint64_t cpu_hash = HashCpuModel();
+    fs::path path(model_path);
+    std::string name = fmt::format("{}-{:016x}-ort{}-{}-{:08x}.onnx",
+                                   path.stem().string(), HashFile(model_path), OrtGetApiBase()->GetVersionString(),
+                                   use_gpu ? "cuda" : "cpu", cpu_hash & 0xffffffff);
+    return (fs::path(cache_dir_) / name).string();
+}
+
+Ort::Session ModelCache::CreateSession(const Ort::Env& env, const std::string& model_path, Ort::SessionOptions& options, bool use_gpu) const {
+    if (!Enabled()) {
+        return Ort::Session(env, model_path.c_str(), options);
+    }
+
+    const std::string cached_path = CachedModelPath(model_path, use_gpu);
+    std::error_code ec;
+    if (fs::exists(cached_path, ec)) {
+        // 图已经优化过, 再跑一遍优化只是浪费时间
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+        try {
+            Ort::Session session(env, cached_path.c_str(), options);
+            LOG_INFO("loaded optimized model from cache: {}", cached_path);
+            return session;
+        } catch (const Ort::Exception& e) {
+            LOG_WARN("broken model cache {}, rebuilding: {}", cached_path, e.what());
+            fs::remove(cached_path, ec);
+        }
+    }
+
+    // 先写到临时文件, session 创建成功后再改名, 同时启动的几个进程不会读到写了一半的文件
+    fs::create_directories(cache_dir_, ec);
+    if (!fs::is_directory(cache_dir_, ec)) {
+        LOG_WARN("model cache dir {} is not usable, loading without cache", cache_dir_);
+        return Ort::Session(env, model_path.c_str(), options);
+    }
+    const std::string tmp_path = fmt::format("{}.tmp.{}", cached_path, ::getpid());
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    options.SetOptimizedModelFilePath(tmp_path.c_str());
+    Ort::Session session(env, model_path.c_str(), options);
+    fs::rename(tmp_path, cached_path, ec);
+    if (ec) {
+        LOG_WARN("cannot write model cache {}: {}", cached_path, ec.message());
+        fs::remove(tmp_path, ec);
+    } else {
+        LOG_INFO("saved optimized model to cache: {}", cached_path);
+    }
+    return session;
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <onnxruntime_cxx_api.h>
+
+namespace nn {
+
+// onnxruntime 图优化结果的磁盘缓存, 缩短重启时创建 session 的时间
+// 第一次加载时让 onnxruntime 把 ORT_ENABLE_ALL 优化后的图写进 cache_dir, 之后直接加载优化后的图并关闭图优化
+// 缓存文件名由模型内容哈希、onnxruntime 版本、provider 和 CPU 型号决定, 模型或运行环境变了自然失效
+// 优化后的图和硬件相关 (NCHWc 布局、CUDA 融合算子), cache_dir 不要在不同机型之间共享
+class ModelCache {
+public:
+    // cache_dir 为空时不使用缓存
+    explicit ModelCache(std::string cache_dir) : cache_dir_(std::move(cache_dir)) {}
+
+    // 按缓存情况创建 session, 会修改 options 的图优化设置; 缓存文件损坏时删掉并从原模型重新生成
+    Ort::Session CreateSession(const Ort::Env& env, const std::string& model_path, Ort::SessionOptions& options, bool use_gpu) const;
+
+    // 模型对应的缓存文件路径
+    std::string CachedModelPath(const std::string& model_path, bool use_gpu) const;
+
+    bool Enabled() const { return !cache_dir_.empty(); }
+
+private:
+    std::string cache_dir_;
+};
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace nn {
+
+// 模型精度, 启动时按阶段 (检测 / 分类) 选择
+// int8 模型是 tools/quantize_models.py 生成的 QDQ 量化模型, 和 fp32 模型放在同一目录, 文件名多一个 _int8 后缀
+enum class Precision {
+    kFp32,
+    kInt8,
+};
+
+// fp32 模型路径对应的 int8 模型路径: models/foo.onnx -> models/foo_int8.onnx; 已经是 int8 模型时原样返回
+inline std::string ModelPathFor(const std::string& fp32_path, Precision precision) {
+    if (precision == Precision::kFp32) {
+        return fp32_path;
+    }
+    std::filesystem::path path(fp32_path);
+    std::string stem = path.stem().string();
+    const std::string suffix = "_int8";
+    if (stem.size() >= suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return fp32_path;
+    }
+    return (path.parent_path() / (stem + suffix + path.extension().string())).string();
+}
+
+inline const char* PrecisionName(Precision precision) {
+    return precision == Precision::kInt8 ? "int8" : "fp32";
+}
+
+}
@@ -0,0 +1,148 @@
+// 把二进制访问日志 (access-<pid>-<tid>.bin) 解码成文本或 CSV, 多个文件按时间合并
+// accesslog_decode [--csv] [--paths paths.tsv] access-*.bin
+
+#include "http/accesslog.h"
+#include "CLI/CLI.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using http::AccessFileHeader;
+using http::AccessRecord;
+
+// 按写入顺序读出环里还保留的记录
+bool ReadRecords(const std::string& path, std::vector<AccessRecord>* records) {
+    std::ifstream file(path, std::ios::binary);
+    AccessFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << path << ": too short" << std::endl;
+        return false;
+    }
+    if (std::memcmp(header.magic, AccessFileHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != AccessFileHeader::kVersion || header.record_size != sizeof(AccessRecord) ||
+        header.capacity == 0) {
+        std::cerr << path << ": not an access log or unsupported version" << std::endl;
+        return false;
+    }
+    std::vector<AccessRecord> ring(header.capacity);
+    if (!file.read(reinterpret_cast<char*>(ring.data()), ring.size() * sizeof(AccessRecord))) {
+        std::cerr << path << ": truncated" << std::endl;
+        return false;
+    }
+    uint64_t count = std::min(header.head, header.capacity);
+    for (uint64_t i = header.head - count; i < header.head; i++) {
+        records->push_back(ring[i % header.capacity]);
+    }
+    return true;
+}
+
+std::unordered_map<uint16_t, std::string> ReadPaths(const std::string& path) {
+    std::unordered_map<uint16_t, std::string> paths;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        auto tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        paths[static_cast<uint16_t>(std::stoul(line.substr(0, tab)))] = line.substr(tab + 1);
+    }
+    return paths;
+}
+
+std::string FormatTime(uint64_t timestamp_ns) {
+    std::time_t seconds = static_cast<std::time_t>(timestamp_ns / 1000000000ull);
+    std::tm tm_local;
+    localtime_r(&seconds, &tm_local);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm_local);
+    return fmt::format("{}.{:06}", buf, timestamp_ns % 1000000000ull / 1000);
+}
+
+// CSV 字段里有逗号或引号时加引号
+std::string CsvField(const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos) {
+        return field;
+    }
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+}
+
+int main(int argc, char** argv) {
+    CLI::App app{"Decode binary access log ring files"};
+
+    std::vector<std::string> files;
+    std::string paths_file;
+    bool csv = false;
+    app.add_option("files", files, "access-*.bin files")->required();
+    app.add_option("--paths", paths_file, "Path table (default: paths.tsv next to the first file)");
+    app.add_flag("--csv", csv, "Write CSV with a header row instead of text");
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (paths_file.empty()) {
+        paths_file = (std::filesystem::path(files.front()).parent_path() / "paths.tsv").string();
+    }
+    std::unordered_map<uint16_t, std::string> paths;
+    try {
+        paths = ReadPaths(paths_file);
+    } catch (const std::exception& e) { // 路径编号不是数字
+        std::cerr << paths_file << ": malformed path table (" << e.what() << ")\n\n" << app.help();
+        return 1;
+    }
+
+    std::vector<AccessRecord> records;
+    for (const auto& file : files) {
+        if (!ReadRecords(file, &records)) {
+            return 1;
+        }
+    }
+    std::stable_sort(records.begin(), records.end(), [](const AccessRecord& a, const AccessRecord& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+
+    std::string out;
+    if (csv) {
+        out += "time,request_id,conn_id,method,path,status,bytes,total_us,parse_us,route_us,queue_us,inference_us\n";
+    }
+    for (const auto& record : records) {
+        auto it = paths.find(record.path_id);
+        std::string path = it != paths.end() ? it->second : fmt::format("<path {}>", record.path_id);
+        auto method = http::AccessMethodName(static_cast<http::AccessMethod>(record.method));
+        if (csv) {
+            out += fmt::format("{},{},{},{},{},{},{},{},{},{},{},{}\n", FormatTime(record.timestamp_ns),
+                               record.request_id, record.conn_id, method, CsvField(path), record.status, record.bytes,
+                               record.total_us, record.parse_us, record.route_us, record.queue_us, record.inference_us);
+        } else {
+            out += fmt::format("{} {} {} {} {}B {}us (parse {}us, route {}us, queue {}us, inference {}us) request={} conn={}\n",
+                               FormatTime(record.timestamp_ns), method, path, record.status, record.bytes, record.total_us,
+                               record.parse_us, record.route_us, record.queue_us, record.inference_us,
+                               record.request_id, record.conn_id);
+        }
+        if (out.size() > (1 << 20)) {
+            std::cout << out;
+            out.clear();
+        }
+    }
+    std::cout << out;
+    return 0;
+}
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+# 用仓库里的测试图把检测 / 分类模型做静态 INT8 (QDQ) 量化, 输出到 fp32 模型旁边的 <name>_int8.onnx
+# 服务端用 --detect-precision int8 / --classify-precision int8 加载 (见 nn/precision.h)
+#   python3 code/tools/quantize_models.py --yolo-model models/yolo11m_detect.onnx --cls-model models/bone_maturity_predict.onnx
+# 校准数据:
+#   检测: tests/images/hand 下的整手图, 按 YOLO11Detector 的方式 letterbox 到 640
+#   分类: tests/images/joint/<hand>_annotations/<Joint>_Grade<N>.png, 按 MaturityClassifier 的方式缩放到 112, 带 category_id
+# 脚本最后在关节标注上比较 fp32 和 int8 分类模型 (一致率和速度), 完整的对比用 bench_accuracy:
+#   bench_accuracy --out fp32.json
+#   bench_accuracy --baseline fp32.json --detect-precision int8 --classify-precision int8
+# 依赖: onnxruntime (>= 1.16), onnx, opencv-python, numpy
+
+import argparse
+import os
+import re
+import sys
+import time
+from pathlib import Path
+
+import cv2
+import numpy as np
+import onnxruntime as ort
+from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat, QuantType,
+                                      quantize_dynamic, quantize_static)
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+REPO_ROOT = Path(__file__).resolve().parents[2]
+
+# 标注文件名里的关节名 -> BoneInfo::kClsBones 的 category id, 和 bench/bench_accuracy.cc 的 kAnnotatedJoints 一致
+ANNOTATED_JOINTS = {
+    "Radius": 0,
+    "Ulna": 1,
+    "First_Metacarpal": 2,
+    "Third_Metacarpal": 3,
+    "Fifth_Metacarpal": 3,
+    "First_Proximal_Phalanx": 4,
+    "Third_Proximal_Phalanx": 5,
+    "Fifth_Proximal_Phalanx": 5,
+    "Third_Middle_Phalanx": 6,
+    "Fifth_Middle_Phalanx": 6,
+    "First_Distal_Phalanx": 7,
+    "Third_Distal_Phalanx": 8,
+    "Fifth_Distal_Phalanx": 8,
+}
+
+# BoneInfo::kClsBones 的 maturity_range, 分类输出只看前 maturity_range 个分数
+MATURITY_RANGE = [14, 12, 11, 10, 12, 12, 12, 11, 11]
+
+ANNOTATION_RE = re.compile(r"^(.+)_Grade(\d+)\.png$")
+
+CALIBRATION_METHODS = {
+    "minmax": CalibrationMethod.MinMax,
+    "entropy": CalibrationMethod.Entropy,
+    "percentile": CalibrationMethod.Percentile,
+}
+
+
+def int8_path(fp32_path):
+    # 和 nn::ModelPathFor 一致
+    path = Path(fp32_path)
+    return str(path.with_name(path.stem + "_int8" + path.suffix))
+
+
+def to_blob(images, size):
+    # cv::dnn::blobFromImages(images, 1/255, size, Scalar(), swapRB=true, crop=false)
+    resized = [cv2.resize(image, size) if image.shape[1::-1] != size else image for image in images]
+    batch = np.stack(resized).astype(np.float32) / 255.0
+    return np.ascontiguousarray(batch[..., ::-1].transpose(0, 3, 1, 2))
+
+
+def letterbox(image, size=640):
+    # YOLO11Detector::Letterbox_: 等比缩放到左上角, 右侧和下方填 114
+    h, w = image.shape[:2]
+    scale = min(size / w, size / h)
+    nw, nh = int(w * scale), int(h * scale)
+    canvas = np.full((size, size, 3), 114, dtype=np.uint8)
+    canvas[:nh, :nw] = cv2.resize(image, (nw, nh), interpolation=cv2.INTER_AREA)
+    return canvas
+
+
+def load_hands(hand_dir):
+    images = []
+    for path in sorted(Path(hand_dir).glob("*")):
+        if path.suffix.lower() not in (".jpg", ".jpeg", ".png", ".bmp"):
+            continue
+        image = cv2.imread(str(path), cv2.IMREAD_COLOR)
+        if image is not None:
+            images.append(image)
+    return images
+
+
+def load_joints(joint_dir):
+    # 返回 [(image, category_id, grade)]
+    joints = []
+    for annotations in sorted(Path(joint_dir).glob("*_annotations")):
+        for path in sorted(annotations.iterdir()):
+            match = ANNOTATION_RE.match(path.name)
+            if not match or match.group(1) not in ANNOTATED_JOINTS:
+                continue
+            image = cv2.imread(str(path), cv2.IMREAD_COLOR)
+            if image is not None:
+                joints.append((image, ANNOTATED_JOINTS[match.group(1)], int(match.group(2))))
+    return joints
+
+
+class DetectorReader(CalibrationDataReader):
+    def __init__(self, model_path, hands):
+        self.input_name = ort.InferenceSession(model_path, providers=["CPUExecutionProvider"]).get_inputs()[0].name
+        self.hands = hands
+        self.index = 0
+
+    def get_next(self):
+        if self.index >= len(self.hands):
+            return None
+        image = self.hands[self.index]
+        self.index += 1
+        return {self.input_name: to_blob([letterbox(image)], (640, 640))}
+
+    def rewind(self):
+        self.index = 0
+
+
+class ClassifierReader(CalibrationDataReader):
+    def __init__(self, model_path, joints):
+        inputs = ort.InferenceSession(model_path, providers=["CPUExecutionProvider"]).get_inputs()
+        self.image_name = inputs[0].name
+        self.category_name = inputs[1].name
+        self.joints = joints
+        self.index = 0
+
+    def get_next(self):
+        if self.index >= len(self.joints):
+            return None
+        image, category_id, _ = self.joints[self.index]
+        self.index += 1
+        return {
+            self.image_name: to_blob([image], (112, 112)),
+            self.category_name: np.array([category_id], dtype=np.int64),
+        }
+
+    def rewind(self):
+        self.index = 0
+
+
+def quantize(model_path, reader, args):
+    output_path = int8_path(model_path)
+    # 先做形状推断和图优化, 量化工具需要完整的中间张量形状
+    preprocessed_path = output_path + ".pre.onnx"
+    quant_pre_process(model_path, preprocessed_path, skip_symbolic_shape=True)
+    try:
+        if args.mode == "dynamic":
+            quantize_dynamic(preprocessed_path, output_path, weight_type=QuantType.QInt8, per_channel=args.per_channel)
+        else:
+            # onnxruntime 推荐 QDQ 先用 S8S8, 精度不够再试 --activation-type uint8 (U8S8)
+            quantize_static(preprocessed_path, output_path, reader,
+                            quant_format=QuantFormat.QDQ,
+                            activation_type=QuantType.QInt8 if args.activation_type == "int8" else QuantType.QUInt8,
+                            weight_type=QuantType.QInt8,
+                            per_channel=args.per_channel,
+                            calibrate_method=CALIBRATION_METHODS[args.method],
+                            nodes_to_exclude=args.nodes_to_exclude)
+    finally:
+        if os.path.exists(preprocessed_path):
+            os.remove(preprocessed_path)
+    print(f"{model_path} -> {output_path} "
+          f"({os.path.getsize(model_path) / 1e6:.1f} MB -> {os.path.getsize(output_path) / 1e6:.1f} MB)")
+    return output_path
+
+
+def classify(session, joints, batch_size):
+    inputs = session.get_inputs()
+    stages = []
+    start = time.perf_counter()
+    for begin in range(0, len(joints), batch_size):
+        batch = joints[begin:begin + batch_size]
+        scores = session.run(None, {
+            inputs[0].name: to_blob([image for image, _, _ in batch], (112, 112)),
+            inputs[1].name: np.array([category_id for _, category_id, _ in batch], dtype=np.int64),
+        })[0]
+        for row, (_, category_id, _) in zip(scores, batch):
+            stages.append(int(np.argmax(row[:MATURITY_RANGE[category_id]])) + 1)
+    return stages, time.perf_counter() - start
+
+
+def compare_classifier(fp32_path, int8_path_, joints, args):
+    options = ort.SessionOptions()
+    options.intra_op_num_threads = args.threads
+    options.graph_optimization_level = ort.GraphOptimizationLevel.ORT_ENABLE_ALL
+    report = {}
+    for name, path in (("fp32", fp32_path), ("int8", int8_path_)):
+        session = ort.InferenceSession(path, options, providers=["CPUExecutionProvider"])
+        classify(session, joints[:args.batch_size], args.batch_size)  # 预热
+        stages, elapsed = classify(session, joints, args.batch_size)
+        for _ in range(args.repeat - 1):
+            elapsed = min(elapsed, classify(session, joints, args.batch_size)[1])
+        exact = sum(stage == grade for stage, (_, _, grade) in zip(stages, joints))
+        report[name] = {"stages": stages, "elapsed": elapsed, "exact": exact}
+
+    total = len(joints)
+    agree = sum(a == b for a, b in zip(report["fp32"]["stages"], report["int8"]["stages"]))
+    print(f"classifier on {total} annotated joints (CPU, {args.threads} threads, batch {args.batch_size}):")
+    for name in ("fp32", "int8"):
+        r = report[name]
+        print(f"  {name}: annotation agreement {100.0 * r['exact'] / total:.1f}%, "
+              f"{total / r['elapsed']:.1f} joints/s")
+    print(f"  int8 vs fp32: same stage {100.0 * agree / total:.1f}%, "
+          f"speedup {report['fp32']['elapsed'] / report['int8']['elapsed']:.2f}x")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Static INT8 (QDQ) quantization of the bone age models")
+    parser.add_argument("--yolo-model", default="models/yolo11m_detect.onnx", help="fp32 detection model")
+    parser.add_argument("--cls-model", default="models/bone_maturity_predict.onnx", help="fp32 classification model")
+    parser.add_argument("--stages", default="detect,classify", help="Models to quantize: detect, classify or both")
+    parser.add_argument("--hands", default=str(REPO_ROOT / "tests" / "images" / "hand"),
+                        help="Full hand images for detector calibration")
+    parser.add_argument("--joints", default=str(REPO_ROOT / "tests" / "images" / "joint"),
+                        help="Folder of <hand>_annotations directories for classifier calibration")
+    parser.add_argument("--mode", choices=["static", "dynamic"], default="static",
+                        help="static uses the calibration images; dynamic only quantizes weights")
+    parser.add_argument("--method", choices=sorted(CALIBRATION_METHODS), default="minmax",
+                        help="Calibration method for activation ranges")
+    parser.add_argument("--activation-type", choices=["int8", "uint8"], default="int8")
+    parser.add_argument("--no-per-channel", dest="per_channel", action="store_false",
+                        help="Per-tensor weight scales instead of per-channel")
+    parser.add_argument("--nodes-to-exclude", nargs="*", default=[],
+                        help="Node names kept in fp32 (e.g. the detection head if boxes drift)")
+    parser.add_argument("--threads", type=int, default=1, help="intra-op threads for the comparison")
+    parser.add_argument("--batch-size", type=int, default=1, help="Batch size for the comparison")
+    parser.add_argument("--repeat", type=int, default=3, help="Timed passes for the comparison, fastest is reported")
+    args = parser.parse_args()
+
+    stages = {stage.strip() for stage in args.stages.split(",") if stage.strip()}
+    if not stages or not stages <= {"detect", "classify"}:
+        parser.error("--stages must be detect, classify or detect,classify")
+
+    if "detect" in stages:
+        hands = load_hands(args.hands)
+        if not hands and args.mode == "static":
+            sys.exit(f"no hand images in {args.hands}")
+        quantize(args.yolo_model, DetectorReader(args.yolo_model, hands), args)
+
+    if "classify" in stages:
+        joints = load_joints(args.joints)
+        if not joints:
+            sys.exit(f"no joint annotations in {args.joints}")
+        output_path = quantize(args.cls_model, ClassifierReader(args.cls_model, joints), args)
+        compare_classifier(args.cls_model, output_path, joints, args)
+
+
+if __name__ == "__main__":
+    main()
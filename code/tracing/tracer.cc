@@ -0,0 +1,100 @@
+#include "tracer.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tracing {
+
+thread_local Tracer::Ring* Tracer::tls_ring_ = nullptr;
+
+Tracer::Ring* Tracer::CreateLocalRing_() {
+    auto ring = std::make_unique<Ring>();
+    ring->tid = static_cast<int>(::syscall(SYS_gettid));
+    char name[16] = {0};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+        ring->thread_name = name;
+    }
+    tls_ring_ = ring.get();
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.push_back(std::move(ring));
+    return tls_ring_;
+}
+
+std::string Tracer::DumpChromeJson() const {
+    const int pid = static_cast<int>(::getpid());
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto begin_event = [&]() {
+        if (!first) {
+            out += ",\n";
+        }
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Event> events;
+    for (const auto& ring : rings_) {
+        if (!ring->thread_name.empty()) {
+            begin_event();
+            out += fmt::format("{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                               pid, ring->tid, ring->thread_name);
+        }
+
+        // 写线程可能同时在覆盖最旧的事件: 先拷贝, 再按拷贝后的 head 丢掉可能被覆盖的部分
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = head > kRingCapacity ? head - kRingCapacity : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            const Slot& slot = ring->slots[i % kRingCapacity];
+            events.push_back({slot.category.load(std::memory_order_relaxed), slot.name.load(std::memory_order_relaxed),
+                              slot.phase.load(std::memory_order_relaxed), slot.start_ns.load(std::memory_order_relaxed),
+                              slot.duration_ns.load(std::memory_order_relaxed), slot.id.load(std::memory_order_relaxed)});
+        }
+        uint64_t new_head = ring->head.load(std::memory_order_acquire);
+        uint64_t valid_begin = new_head >= kRingCapacity ? new_head - kRingCapacity + 1 : 0;
+
+        for (uint64_t i = std::max(begin, valid_begin); i < head; i++) {
+            const Event& event = events[i - begin];
+            begin_event();
+            // Chrome trace 的时间单位是微秒
+            out += fmt::format("{{\"cat\":\"{}\",\"name\":\"{}\",\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":{},\"tid\":{}",
+                               event.category, event.name, event.phase, event.start_ns / 1e3, pid, ring->tid);
+            if (event.phase == 'X') {
+                out += fmt::format(",\"dur\":{:.3f}", event.duration_ns / 1e3);
+            } else if (event.phase == 'i') {
+                out += ",\"s\":\"t\"";
+            } else {
+                out += fmt::format(",\"id\":\"0x{:x}\"", event.id);
+            }
+            if (event.id != 0) {
+                out += fmt::format(",\"args\":{{\"id\":{}}}", event.id);
+            }
+            out += '}';
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+std::string Tracer::DumpToFile(const std::string& dir) const {
+    std::time_t now = std::time(nullptr);
+    std::tm tm_now;
+    localtime_r(&now, &tm_now);
+    char name[64];
+    std::strftime(name, sizeof(name), "trace-%Y%m%d-%H%M%S.json", &tm_now);
+    std::string path = (std::filesystem::path(dir) / name).string();
+
+    std::string json = DumpChromeJson();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.write(json.data(), json.size())) {
+        return {};
+    }
+    return path;
+}
+
+}
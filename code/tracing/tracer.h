@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tracing {
+
+// 一条 Chrome trace 事件
+// phase: 'X' 完整区间, 'i' 瞬时事件, 'b' / 'e' 异步区间的开始和结束 (跨线程, 按 category + name + id 配对)
+struct Event {
+    const char* category;
+    const char* name;      // 必须是字符串字面量, 只保存指针
+    char phase;
+    int64_t start_ns;      // steady_clock
+    int64_t duration_ns;   // 只有 'X' 有意义
+    uint64_t id;           // 请求 id 或连接 id, 0 表示没有
+};
+
+// 每个线程一个定长环形缓冲区, 写满后覆盖最旧的事件; 只有本线程写, 不加锁
+// Dump 时把所有线程的事件导出成 Chrome trace JSON (chrome://tracing 或 ui.perfetto.dev 可以直接打开)
+// 由编译开关 BONEAGE_TRACING 控制, 关闭时下面的 TRACE_* 宏都是空的, 没有任何开销
+class Tracer {
+public:
+    static constexpr size_t kRingCapacity = 1 << 14; // 每个线程保留的最近事件数
+
+    static Tracer& GetInstance() {
+        static Tracer instance;
+        return instance;
+    }
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    static int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Record(const Event& event) {
+        Ring* ring = tls_ring_ != nullptr ? tls_ring_ : CreateLocalRing_();
+        uint64_t index = ring->head.load(std::memory_order_relaxed);
+        Slot& slot = ring->slots[index % kRingCapacity];
+        slot.category.store(event.category, std::memory_order_relaxed);
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.phase.store(event.phase, std::memory_order_relaxed);
+        slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+        slot.duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+        slot.id.store(event.id, std::memory_order_relaxed);
+        ring->head.store(index + 1, std::memory_order_release);
+    }
+
+    // 所有线程当前保留的事件, Chrome trace JSON 格式
+    std::string DumpChromeJson() const;
+    // 写到 dir 下的 trace-<时间>.json, 返回文件路径, 失败返回空串
+    std::string DumpToFile(const std::string& dir) const;
+
+private:
+    Tracer() = default;
+
+    struct Slot {
+        std::atomic<const char*> category{nullptr};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<char> phase{0};
+        std::atomic<int64_t> start_ns{0};
+        std::atomic<int64_t> duration_ns{0};
+        std::atomic<uint64_t> id{0};
+    };
+
+    struct Ring {
+        int tid;
+        std::string thread_name;
+        std::atomic<uint64_t> head{0}; // 写过的事件总数
+        std::unique_ptr<Slot[]> slots{new Slot[kRingCapacity]};
+    };
+
+    Ring* CreateLocalRing_();
+
+private:
+    static thread_local Ring* tls_ring_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_; // 线程退出后保留, 事件还能导出
+};
+
+// 析构时记录一个 'X' 区间
+class ScopedSpan {
+public:
+    ScopedSpan(const char* category, const char* name, uint64_t id)
+        : category_(category), name_(name), id_(id), start_ns_(Tracer::NowNs()) {}
+
+    ~ScopedSpan() {
+        Tracer::GetInstance().Record({category_, name_, 'X', start_ns_, Tracer::NowNs() - start_ns_, id_});
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    const char* category_;
+    const char* name_;
+    uint64_t id_;
+    int64_t start_ns_;
+};
+
+inline void RecordEvent(const char* category, const char* name, char phase, uint64_t id) {
+    Tracer::GetInstance().Record({category, name, phase, Tracer::NowNs(), 0, id});
+}
+
+}
+
+#define TRACE_CONCAT_INNER_(a, b) a##b
+#define TRACE_CONCAT_(a, b) TRACE_CONCAT_INNER_(a, b)
+
+#ifdef BONEAGE_TRACING
+// 当前作用域结束时记录一个区间
+#define TRACE_SPAN(category, name, id) tracing::ScopedSpan TRACE_CONCAT_(trace_span_, __LINE__)(category, name, id)
+#define TRACE_INSTANT(category, name, id) tracing::RecordEvent(category, name, 'i', id)
+// 跨线程的区间, 开始和结束可以在不同线程, 按 category + name + id 配对
+#define TRACE_ASYNC_BEGIN(category, name, id) tracing::RecordEvent(category, name, 'b', id)
+#define TRACE_ASYNC_END(category, name, id) tracing::RecordEvent(category, name, 'e', id)
+#else
+#define TRACE_SPAN(category, name, id) ((void)0)
+#define TRACE_INSTANT(category, name, id) ((void)0)
+#define TRACE_ASYNC_BEGIN(category, name, id) ((void)0)
+#define TRACE_ASYNC_END(category, name, id) ((void)0)
+#endif
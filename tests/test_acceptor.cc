@@ -3,8 +3,12 @@
 #include "net/inetaddress.h"
 #include "net/socket.h"
 #include <gtest/gtest.h>
+#include <atomic>
 #include <thread>
 #include <future>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 using namespace net;
@@ -72,3 +76,185 @@ TEST_F(AcceptorTest, ReliableAcceptanceFlow) {
     t.join();
 }
 
+
+// 测试暂停 accept 后连接留在 backlog 中, 恢复后一次性接受完
+TEST_F(AcceptorTest, StopAndResumeAccepting) {
+    std::promise<InetAddress> addr_promise;
+    auto addr_future = addr_promise.get_future();
+    std::promise<void> first_promise;
+    auto first_future = first_promise.get_future();
+    std::promise<void> all_promise;
+    auto all_future = all_promise.get_future();
+
+    EventLoop* loop_ptr = nullptr;
+    Acceptor* acceptor_ptr = nullptr;
+    std::vector<int> accepted_fds;
+
+    std::thread t([&]() {
+        EventLoop loop;
+        Acceptor acceptor(&loop, InetAddress("127.0.0.1", 0));
+        loop_ptr = &loop;
+        acceptor_ptr = &acceptor;
+
+        acceptor.SetNewConnectionCallback([&](int sockfd, const InetAddress&) {
+            accepted_fds.push_back(sockfd);
+            if (accepted_fds.size() == 1) {
+                acceptor.StopAccepting(); // 模拟达到连接数上限
+                first_promise.set_value();
+            } else if (accepted_fds.size() == 3) {
+                all_promise.set_value();
+            }
+        });
+        acceptor.Listen();
+
+        struct sockaddr_in local;
+        socklen_t addrlen = sizeof(local);
+        ::getsockname(acceptor.GetFd(), (struct sockaddr*)&local, &addrlen);
+        addr_promise.set_value(InetAddress(local));
+
+        loop.Loop();
+    });
+
+    InetAddress server_addr = addr_future.get();
+    std::vector<int> client_fds;
+    for (int i = 0; i < 3; i++) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(::connect(fd, server_addr.GetSockAddr(), sizeof(sockaddr_in)), 0);
+        client_fds.push_back(fd);
+    }
+
+    ASSERT_EQ(first_future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    AcceptStats stats = acceptor_ptr->GetStats();
+    EXPECT_FALSE(stats.accepting);
+    EXPECT_EQ(stats.accepted, 1u);
+    EXPECT_EQ(stats.paused, 1u);
+
+    loop_ptr->RunInLoop([&]() { acceptor_ptr->StartAccepting(); });
+    ASSERT_EQ(all_future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_TRUE(acceptor_ptr->GetStats().accepting);
+
+    loop_ptr->Quit();
+    t.join();
+    for (int fd : client_fds) ::close(fd);
+    for (int fd : accepted_fds) ::close(fd);
+}
+
+// fd 用完时暂停 accept, 释放 fd 后不需要任何连接关闭也能由重试定时器恢复
+TEST_F(AcceptorTest, ResumesAfterFdExhaustionWithoutConnectionClose) {
+    std::promise<InetAddress> addr_promise;
+    auto addr_future = addr_promise.get_future();
+    std::promise<int> fd_promise;
+    auto fd_future = fd_promise.get_future();
+
+    EventLoop* loop_ptr = nullptr;
+    Acceptor* acceptor_ptr = nullptr;
+    std::thread t([&]() {
+        EventLoop loop;
+        Acceptor acceptor(&loop, InetAddress("127.0.0.1", 0));
+        loop_ptr = &loop;
+        acceptor_ptr = &acceptor;
+        acceptor.SetNewConnectionCallback([&](int sockfd, const InetAddress&) { fd_promise.set_value(sockfd); });
+        acceptor.Listen();
+
+        struct sockaddr_in local;
+        socklen_t addrlen = sizeof(local);
+        ::getsockname(acceptor.GetFd(), (struct sockaddr*)&local, &addrlen);
+        addr_promise.set_value(InetAddress(local));
+        loop.Loop();
+    });
+    InetAddress server_addr = addr_future.get();
+
+    int client_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(client_fd, 0);
+
+    // 先占满 fd, 再连接, accept 只能拿到 EMFILE
+    struct rlimit old_limit;
+    ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &old_limit), 0);
+    std::vector<int> fillers;
+    int probe = ::open("/dev/null", O_RDONLY);
+    ASSERT_GE(probe, 0);
+    struct rlimit limit = old_limit;
+    limit.rlim_cur = probe + 1;
+    ::close(probe);
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &limit), 0);
+    for (int fd; (fd = ::open("/dev/null", O_RDONLY)) >= 0;) {
+        fillers.push_back(fd);
+    }
+    ASSERT_EQ(::connect(client_fd, server_addr.GetSockAddr(), sizeof(sockaddr_in)), 0);
+
+    for (int i = 0; i < 100 && acceptor_ptr->GetStats().fd_exhausted == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    AcceptStats stats = acceptor_ptr->GetStats();
+    EXPECT_GE(stats.fd_exhausted, 1u);
+    EXPECT_EQ(stats.accepted, 0u);
+
+    for (int fd : fillers) ::close(fd);
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &old_limit), 0);
+
+    ASSERT_EQ(fd_future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    int conn_fd = fd_future.get();
+    EXPECT_TRUE(acceptor_ptr->GetStats().accepting);
+
+    loop_ptr->Quit();
+    t.join();
+    ::close(conn_fd);
+    ::close(client_fd);
+}
+
+// 空闲时 accepts_per_sec 按经过的时间下降, 不停在最后一次突发的速率
+TEST_F(AcceptorTest, AcceptRateDecaysWhenIdle) {
+    std::promise<InetAddress> addr_promise;
+    auto addr_future = addr_promise.get_future();
+    std::vector<int> accepted_fds;
+    std::atomic<size_t> accepted{0};
+
+    EventLoop* loop_ptr = nullptr;
+    Acceptor* acceptor_ptr = nullptr;
+    std::thread t([&]() {
+        EventLoop loop;
+        Acceptor acceptor(&loop, InetAddress("127.0.0.1", 0));
+        loop_ptr = &loop;
+        acceptor_ptr = &acceptor;
+        acceptor.SetNewConnectionCallback([&](int sockfd, const InetAddress&) {
+            accepted_fds.push_back(sockfd);
+            accepted++;
+        });
+        acceptor.Listen();
+
+        struct sockaddr_in local;
+        socklen_t addrlen = sizeof(local);
+        ::getsockname(acceptor.GetFd(), (struct sockaddr*)&local, &addrlen);
+        addr_promise.set_value(InetAddress(local));
+        loop.Loop();
+    });
+    InetAddress server_addr = addr_future.get();
+
+    // 一秒多一点里连 20 次, 最后一次让窗口滚动
+    std::vector<int> client_fds;
+    auto connect_one = [&]() {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(::connect(fd, server_addr.GetSockAddr(), sizeof(sockaddr_in)), 0);
+        client_fds.push_back(fd);
+    };
+    for (int i = 0; i < 19; i++) {
+        connect_one();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    connect_one();
+    for (int i = 0; i < 100 && accepted < 20; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double busy_rate = acceptor_ptr->GetStats().accepts_per_sec;
+    EXPECT_GT(busy_rate, 10.0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    double idle_rate = acceptor_ptr->GetStats().accepts_per_sec;
+    EXPECT_LT(idle_rate, busy_rate / 2);
+
+    loop_ptr->Quit();
+    t.join();
+    for (int fd : client_fds) ::close(fd);
+    for (int fd : accepted_fds) ::close(fd);
+}
@@ -0,0 +1,132 @@
+#include "http/accesslog.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace http;
+
+namespace {
+
+struct RingFile {
+    AccessFileHeader header;
+    std::vector<AccessRecord> records;
+};
+
+std::vector<RingFile> ReadRings(const std::filesystem::path& dir) {
+    std::vector<RingFile> rings;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() != ".bin") {
+            continue;
+        }
+        std::ifstream file(entry.path(), std::ios::binary);
+        RingFile ring;
+        file.read(reinterpret_cast<char*>(&ring.header), sizeof(ring.header));
+        ring.records.resize(ring.header.capacity);
+        file.read(reinterpret_cast<char*>(ring.records.data()), ring.records.size() * sizeof(AccessRecord));
+        rings.push_back(std::move(ring));
+    }
+    return rings;
+}
+
+AccessEntry MakeEntry(uint64_t request_id, std::string_view path) {
+    return AccessEntry{request_id, 7, "GET", path, 200, 512, std::chrono::steady_clock::now(), 3000, 4000, 0, 0};
+}
+
+}
+
+class AccessLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() / "boneage_accesslog_test";
+        std::filesystem::remove_all(dir_);
+    }
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    std::filesystem::path dir_;
+};
+
+// 每隔 N 个请求采样一次
+TEST_F(AccessLogTest, SamplesEveryNthRequest) {
+    AccessLog log;
+    EXPECT_FALSE(log.ShouldSample());
+    log.SetSampleInterval(3);
+    std::vector<bool> sampled;
+    for (int i = 0; i < 6; i++) {
+        sampled.push_back(log.ShouldSample());
+    }
+    EXPECT_EQ(sampled, std::vector<bool>({true, false, false, true, false, false}));
+}
+
+// 记录的字段、路径编号和路径表
+TEST_F(AccessLogTest, BinaryRecordFields) {
+    {
+        AccessLog log;
+        log.RegisterPath("/predict");
+        log.RegisterPath("/metrics");
+        ASSERT_TRUE(log.OpenBinary(dir_.string(), 16));
+        log.Write(MakeEntry(1, "/metrics"));
+        log.Write(MakeEntry(2, "/unknown"));
+    }
+
+    std::ifstream paths(dir_ / "paths.tsv");
+    std::stringstream ss;
+    ss << paths.rdbuf();
+    EXPECT_EQ(ss.str(), "1\t/predict\n2\t/metrics\n");
+
+    auto rings = ReadRings(dir_);
+    ASSERT_EQ(rings.size(), 1u);
+    const auto& header = rings[0].header;
+    EXPECT_EQ(std::memcmp(header.magic, AccessFileHeader::kMagic, sizeof(header.magic)), 0);
+    EXPECT_EQ(header.record_size, sizeof(AccessRecord));
+    EXPECT_EQ(header.capacity, 16u);
+    ASSERT_EQ(header.head, 2u);
+
+    const auto& first = rings[0].records[0];
+    EXPECT_EQ(first.request_id, 1u);
+    EXPECT_EQ(first.conn_id, 7u);
+    EXPECT_EQ(first.path_id, 2);
+    EXPECT_EQ(first.method, static_cast<uint8_t>(AccessMethod::kGet));
+    EXPECT_EQ(first.status, 200);
+    EXPECT_EQ(first.bytes, 512u);
+    EXPECT_EQ(first.parse_us, 3u);
+    EXPECT_EQ(first.route_us, 4u);
+    EXPECT_GT(first.timestamp_ns, 0u);
+    EXPECT_EQ(rings[0].records[1].path_id, 0);
+}
+
+// 写满后覆盖最旧的记录, 每个线程一个文件
+TEST_F(AccessLogTest, PerThreadRingsWrapAround) {
+    {
+        AccessLog log;
+        ASSERT_TRUE(log.OpenBinary(dir_.string(), 8));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; t++) {
+            threads.emplace_back([&log, t]() {
+                for (uint64_t i = 0; i < 20; i++) {
+                    log.Write(MakeEntry(t * 100 + i, "/"));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    auto rings = ReadRings(dir_);
+    ASSERT_EQ(rings.size(), 2u);
+    for (const auto& ring : rings) {
+        ASSERT_EQ(ring.header.head, 20u);
+        uint64_t base = ring.records[0].request_id / 100 * 100;
+        // 保留最后 8 条: 12..19
+        for (uint64_t i = 12; i < 20; i++) {
+            EXPECT_EQ(ring.records[i % 8].request_id, base + i);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#include "http/bodyparser.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace http;
+
+class BodyParserTest : public ::testing::Test {
+protected:
+    static std::string MakeMultipart(const std::string& boundary, const std::vector<std::string>& payloads) {
+        std::string body;
+        for (size_t i = 0; i < payloads.size(); i++) {
+            body += "--" + boundary + "\r\n";
+            body += "Content-Disposition: form-data; name=\"image\"; filename=\"" + std::to_string(i) + ".png\"\r\n";
+            body += "Content-Type: image/png\r\n\r\n";
+            body += payloads[i] + "\r\n";
+        }
+        body += "--" + boundary + "--\r\n";
+        return body;
+    }
+};
+
+TEST_F(BodyParserTest, ExtractsBoundaryFromContentType) {
+    EXPECT_EQ(GetMultipartBoundary("multipart/form-data; boundary=abc123"), "abc123");
+    EXPECT_EQ(GetMultipartBoundary("multipart/form-data; boundary=\"quoted\"; charset=utf-8"), "quoted");
+    EXPECT_FALSE(GetMultipartBoundary("multipart/form-data"));
+    EXPECT_FALSE(GetMultipartBoundary("application/json; boundary=abc"));
+}
+
+// 每个 part 的数据原样取出, 数据里出现 "--boundary" 前缀但不在行首时不会被截断
+TEST_F(BodyParserTest, SplitsAllParts) {
+    std::vector<std::string> payloads = {"first", std::string("\x00\xff--bound\x01", 10), ""};
+    std::string body = MakeMultipart("bound", payloads);
+
+    std::vector<MultipartPart> parts;
+    ASSERT_TRUE(ParseMultipart(body, "bound", &parts));
+    ASSERT_EQ(parts.size(), payloads.size());
+    for (size_t i = 0; i < payloads.size(); i++) {
+        EXPECT_EQ(parts[i].data, payloads[i]) << "part " << i;
+        EXPECT_NE(parts[i].headers.find("Content-Type: image/png"), std::string_view::npos);
+    }
+}
+
+TEST_F(BodyParserTest, RejectsTruncatedMultipart) {
+    std::string body = MakeMultipart("bound", {"data"});
+    std::vector<MultipartPart> parts;
+    EXPECT_FALSE(ParseMultipart(body.substr(0, body.size() - 20), "bound", &parts));
+    EXPECT_FALSE(ParseMultipart("no boundary here", "bound", &parts));
+}
+
+TEST_F(BodyParserTest, DecodesBase64) {
+    std::vector<unsigned char> out;
+    ASSERT_TRUE(DecodeBase64("aGVsbG8gd29ybGQ=", &out));
+    EXPECT_EQ(std::string(out.begin(), out.end()), "hello world");
+
+    out.clear();
+    ASSERT_TRUE(DecodeBase64("AP8A", &out));
+    EXPECT_EQ(out, std::vector<unsigned char>({0x00, 0xff, 0x00}));
+
+    out.clear();
+    ASSERT_TRUE(DecodeBase64("YQ", &out)); // 缺省填充
+    EXPECT_EQ(std::string(out.begin(), out.end()), "a");
+
+    out.clear();
+    EXPECT_FALSE(DecodeBase64("a$==", &out));
+    EXPECT_FALSE(DecodeBase64("abcde", &out));
+}
@@ -0,0 +1,130 @@
+#include "bone_info.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 直接读前端的 scripts.js, 保证服务端的表和前端一致
+class BoneInfoTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fs::path path = fs::path(__FILE__).parent_path() / ".." / "res" / "js" / "scripts.js";
+        std::ifstream file(path);
+        ASSERT_TRUE(file.is_open()) << "cannot open " << path;
+        std::stringstream ss;
+        ss << file.rdbuf();
+        js_ = ss.str();
+    }
+
+    // SCORE['boy'|'girl'][joint]
+    std::vector<int> JsScores(const std::string& sex, std::string_view joint) {
+        size_t sex_pos = js_.find("'" + sex + "': {", js_.find("const SCORE"));
+        size_t joint_pos = js_.find("'" + std::string(joint) + "': [", sex_pos);
+        size_t end = js_.find(']', joint_pos);
+        std::string list = js_.substr(joint_pos, end - joint_pos);
+        std::vector<int> scores;
+        std::regex number(R"(\b\d+\b)");
+        for (auto it = std::sregex_iterator(list.begin(), list.end(), number); it != std::sregex_iterator(); ++it) {
+            scores.push_back(std::stoi(it->str()));
+        }
+        return scores;
+    }
+
+    // calculateBoneAge 里对应性别分支的 11 个多项式系数
+    std::vector<double> JsCurve(const std::string& sex) {
+        size_t begin = js_.find("gender === '" + sex + "'", js_.find("function calculateBoneAge"));
+        size_t end = js_.find(';', begin);
+        std::string expr = js_.substr(begin, end - begin);
+        std::vector<double> coefs;
+        std::regex number(R"([-]?\d+\.\d+(?:[eE][-+]?\d+)?)");
+        for (auto it = std::sregex_iterator(expr.begin(), expr.end(), number); it != std::sregex_iterator(); ++it) {
+            coefs.push_back(std::stod(it->str()));
+        }
+        return coefs;
+    }
+
+    // 照搬 JS 的写法: 逐项 pow 再相加
+    static double JsBoneAge(const std::vector<double>& c, int total) {
+        double age = c[0] + c[1] * total;
+        for (int k = 2; k <= 10; k++) {
+            age += std::pow(total, k) * c[k];
+        }
+        return std::max(0.0, age);
+    }
+
+    std::string js_;
+};
+
+TEST_F(BoneInfoTest, ScoreTablesMatchFrontend) {
+    const std::pair<std::string, BoneInfo::Sex> sexes[] = {{"boy", BoneInfo::Sex::kBoy}, {"girl", BoneInfo::Sex::kGirl}};
+    for (const auto& [name, sex] : sexes) {
+        const auto& table = BoneInfo::kRusChnScores[static_cast<size_t>(sex)];
+        for (size_t j = 0; j < BoneInfo::kKeyJoints.size(); j++) {
+            std::vector<int> expected = JsScores(name, BoneInfo::kKeyJoints[j]);
+            ASSERT_FALSE(expected.empty()) << name << " " << BoneInfo::kKeyJoints[j];
+            // 等级 1..maturity_range 都有分值
+            ASSERT_LT(expected.size(), BoneInfo::kRusChnStages);
+            for (size_t stage = 0; stage < BoneInfo::kRusChnStages; stage++) {
+                int value = stage < expected.size() ? expected[stage] : 0;
+                EXPECT_EQ(table[j][stage], value) << name << " " << BoneInfo::kKeyJoints[j] << " stage " << stage;
+            }
+        }
+    }
+}
+
+TEST_F(BoneInfoTest, CurvesMatchFrontend) {
+    for (auto [name, sex] : {std::pair{"boy", BoneInfo::Sex::kBoy}, std::pair{"girl", BoneInfo::Sex::kGirl}}) {
+        std::vector<double> expected = JsCurve(name);
+        ASSERT_EQ(expected.size(), 11u) << name;
+        const auto& curve = BoneInfo::kRusChnCurves[static_cast<size_t>(sex)];
+        for (size_t k = 0; k < expected.size(); k++) {
+            EXPECT_EQ(curve[k], expected[k]) << name << " coefficient " << k;
+        }
+    }
+}
+
+// 随机等级组合 (包括未检出和越界) 下, 总分和骨龄都与 JS 算法一致
+TEST_F(BoneInfoTest, ScoringMatchesFrontendAlgorithm) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> stage_dist(-1, 16);
+    for (auto [name, sex] : {std::pair{"boy", BoneInfo::Sex::kBoy}, std::pair{"girl", BoneInfo::Sex::kGirl}}) {
+        std::vector<std::vector<int>> tables;
+        for (auto joint : BoneInfo::kKeyJoints) {
+            tables.push_back(JsScores(name, joint));
+        }
+        std::vector<double> curve = JsCurve(name);
+
+        for (int round = 0; round < 2000; round++) {
+            std::array<int, 13> stages;
+            int expected_total = 0;
+            for (size_t j = 0; j < stages.size(); j++) {
+                stages[j] = stage_dist(rng);
+                if (stages[j] >= 0 && stages[j] < static_cast<int>(tables[j].size())) {
+                    expected_total += tables[j][stages[j]];
+                }
+            }
+            int total = BoneInfo::RusChnTotalScore(sex, stages);
+            ASSERT_EQ(total, expected_total);
+            EXPECT_NEAR(BoneInfo::RusChnBoneAge(sex, total), JsBoneAge(curve, total), 1e-6) << name << " score " << total;
+        }
+    }
+}
+
+// 全部关节达到最高等级时骨龄接近成年, 全部未检出时分数为 0
+TEST_F(BoneInfoTest, ScoringBoundaries) {
+    std::array<int, 13> none;
+    none.fill(-1);
+    EXPECT_EQ(BoneInfo::RusChnTotalScore(BoneInfo::Sex::kGirl, none), 0);
+
+    static_assert(BoneInfo::RusChnTotalScore(BoneInfo::Sex::kBoy, {14, 12, 11, 10, 10, 12, 12, 12, 12, 12, 11, 11, 11}) == 1000);
+    double adult = BoneInfo::RusChnBoneAge(BoneInfo::Sex::kBoy, 1000);
+    EXPECT_GT(adult, 15.0);
+    EXPECT_LT(adult, 20.0);
+}
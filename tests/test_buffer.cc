@@ -1,5 +1,8 @@
 #include "net/buffer.h"
+#include "net/bufferpool.h"
 #include <gtest/gtest.h>
+#include <memory>
+#include <unistd.h>
 
 using namespace net;
 
@@ -118,4 +121,81 @@ TEST_F(BufferTest, EnsureWriteable) {
     buffer_.EnsureWriteable(1200);
     // 调用后，可写空间必须大于等于请求的空间
     ASSERT_GE(buffer_.WriteableBytes(), 1200);
-}
\ No newline at end of file
+}
+
+// 测试7：大报文处理完后收缩内存
+TEST_F(BufferTest, ShrinkAfterLargeMessage) {
+    buffer_.Append(std::string(5 * 1024 * 1024, 'z'));
+    ASSERT_GE(buffer_.Capacity(), 5 * 1024 * 1024);
+
+    buffer_.RetrieveAll();
+    ASSERT_EQ(buffer_.Capacity(), 0);
+    ASSERT_EQ(buffer_.ReadableBytes(), 0);
+
+    // 收缩后还能继续正常使用
+    buffer_.Append("again");
+    ASSERT_EQ(buffer_.RetrieveAllToString(), "again");
+}
+
+// 测试8：延迟申请 + 空闲时归还给 pool, 再次申请时复用同一块内存
+TEST_F(BufferTest, PoolReuse) {
+    auto pool = std::make_shared<BufferPool>();
+    Buffer buf(0, pool);
+    ASSERT_EQ(buf.Capacity(), 0);
+
+    buf.Append("hello");
+    ASSERT_EQ(buf.Capacity(), BufferPool::kMinBlockSize);
+    const char* first_block = buf.Peek();
+
+    // 还有数据时不释放
+    buf.ReleaseIfEmpty();
+    ASSERT_EQ(buf.Capacity(), BufferPool::kMinBlockSize);
+
+    buf.Retrieve(5);
+    buf.ReleaseIfEmpty();
+    ASSERT_EQ(buf.Capacity(), 0);
+    ASSERT_EQ(pool->CachedBytes(), BufferPool::kMinBlockSize);
+
+    buf.Append("world");
+    ASSERT_EQ(buf.Peek(), first_block);
+    ASSERT_EQ(pool->CachedBytes(), 0);
+}
+
+// 测试9：尺寸分级
+TEST_F(BufferTest, PoolSizeClasses) {
+    ASSERT_EQ(BufferPool::RoundUp(1), 1024);
+    ASSERT_EQ(BufferPool::RoundUp(1025), 2048);
+    ASSERT_EQ(BufferPool::RoundUp(BufferPool::kMaxBlockSize), BufferPool::kMaxBlockSize);
+    // 超过最大级别的不取整
+    ASSERT_EQ(BufferPool::RoundUp(BufferPool::kMaxBlockSize + 1), BufferPool::kMaxBlockSize + 1);
+}
+
+// 测试10：ReadFd 的读取大小随报文大小自适应
+TEST_F(BufferTest, AdaptiveReadSize) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    Buffer buf(0);
+    int saved_errno = 0;
+    size_t initial_hint = buf.ReadSizeHint();
+
+    // 大报文: 每次都读满, 读取大小增长
+    std::string big(64 * 1024, 'b');
+    ASSERT_EQ(::write(fds[1], big.data(), big.size()), static_cast<ssize_t>(big.size()));
+    while (buf.ReadableBytes() < big.size()) {
+        ASSERT_GT(buf.ReadFd(fds[0], &saved_errno), 0);
+    }
+    ASSERT_GT(buf.ReadSizeHint(), initial_hint);
+    ASSERT_EQ(buf.RetrieveAllToString(), big);
+
+    // 小报文: 读取大小逐步回落
+    size_t grown_hint = buf.ReadSizeHint();
+    for (int i = 0; i < 8; i++) {
+        ASSERT_EQ(::write(fds[1], "x", 1), 1);
+        ASSERT_EQ(buf.ReadFd(fds[0], &saved_errno), 1);
+    }
+    ASSERT_LT(buf.ReadSizeHint(), grown_hint);
+    ASSERT_GE(buf.ReadSizeHint(), Buffer::kMinReadSize);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
@@ -0,0 +1,87 @@
+#include "http/chunkwriter.h"
+#include "http/httpresponse.h"
+#include "net/eventloop.h"
+#include "net/inetaddress.h"
+#include "net/tcpconnection.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace http;
+
+// 用 socketpair 的一端建 TcpConnection, 另一端读出写进去的原始字节
+// 连接还没进 loop 时 Send 在当前线程直接写 socket, 不需要跑 Loop
+class ChunkWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds_), 0);
+        conn_ = std::make_shared<net::TcpConnection>(&loop_, fds_[0], 1, net::InetAddress());
+        conn_->ConnectEstablished();
+    }
+
+    void TearDown() override {
+        ::close(fds_[1]);
+    }
+
+    std::string ReadAll() {
+        std::string out;
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::recv(fds_[1], buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+            out.append(buf, n);
+        }
+        return out;
+    }
+
+    std::string Body(const std::string& raw) {
+        auto pos = raw.find("\r\n\r\n");
+        return pos == std::string::npos ? std::string() : raw.substr(pos + 4);
+    }
+
+    net::EventLoop loop_;
+    int fds_[2];
+    net::TcpConnection::Ptr conn_;
+    HttpResponse response_;
+};
+
+// 默认每次 Write 都是一个块, Finish 发结束块
+TEST_F(ChunkWriterTest, WritesEachCallAsChunk) {
+    response_.SetStatusCode(200);
+    response_.SetContentType("application/x-ndjson");
+    ChunkWriter writer(conn_, response_);
+    writer.Write("{\"index\": 0}\n");
+    writer.Write("");
+    writer.Write("{\"index\": 1}\n");
+    writer.Finish();
+    writer.Write("ignored");
+
+    std::string raw = ReadAll();
+    EXPECT_NE(raw.find("Transfer-Encoding: chunked\r\n"), std::string::npos);
+    EXPECT_EQ(raw.find("Content-Length"), std::string::npos);
+    EXPECT_EQ(Body(raw), "d\r\n{\"index\": 0}\n\r\nd\r\n{\"index\": 1}\n\r\n0\r\n\r\n");
+    EXPECT_TRUE(writer.IsFinished());
+    EXPECT_EQ(writer.BytesWritten(), 26u);
+}
+
+// 设置阈值后小块先攒起来, 超过阈值或 Finish 时合并成一个块
+TEST_F(ChunkWriterTest, CoalescesSmallWrites) {
+    ChunkWriter writer(conn_, response_, 8);
+    writer.Write("abc");
+    writer.Write("defghi");
+    writer.Write("x");
+    writer.Flush();
+    writer.Write("yz");
+    writer.Finish();
+
+    EXPECT_EQ(Body(ReadAll()), "9\r\nabcdefghi\r\n1\r\nx\r\n2\r\nyz\r\n0\r\n\r\n");
+}
+
+// 不 Finish 就不会有结束块, 客户端能发现响应被截断
+TEST_F(ChunkWriterTest, NoLastChunkWithoutFinish) {
+    {
+        ChunkWriter writer(conn_, response_);
+        writer.Write("partial");
+    }
+    EXPECT_EQ(Body(ReadAll()), "7\r\npartial\r\n");
+}
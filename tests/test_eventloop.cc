@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <atomic>
 #include <sys/timerfd.h>
+#include <vector>
 
 using namespace net;
 
@@ -193,4 +194,52 @@ TEST_F(ReactorCoreTest, ChannelRemoval) {
     loop->Quit();
     t.join();
     ::close(timer_fd);
-}
\ No newline at end of file
+}
+// 测试5：多线程并发投递
+// 验证无锁队列不丢任务, 且同一个生产者的任务按投递顺序执行
+TEST_F(ReactorCoreTest, MultiProducerQueueInLoop) {
+    std::promise<EventLoop*> promise;
+    auto future = promise.get_future();
+
+    std::thread t([&]() {
+        EventLoop loop;
+        promise.set_value(&loop);
+        loop.Loop();
+    });
+    EventLoop* loop = future.get();
+
+    constexpr int kProducers = 4;
+    constexpr int kTasksPerProducer = 20000;
+    std::vector<int> last_seen(kProducers, -1); // 只在 loop 线程中访问
+    std::atomic<int> executed = 0;
+    std::atomic<bool> out_of_order = false;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kTasksPerProducer; i++) {
+                loop->QueueInLoop([&, p, i]() {
+                    if (last_seen[p] + 1 != i) {
+                        out_of_order = true;
+                    }
+                    last_seen[p] = i;
+                    executed++;
+                });
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    for (int i = 0; i < 200 && executed.load() < kProducers * kTasksPerProducer; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(executed.load(), kProducers * kTasksPerProducer);
+    ASSERT_FALSE(out_of_order.load());
+    // 唤醒被合并, eventfd 的唤醒次数远小于投递次数
+    ASSERT_LT(loop->GetWakeupCount(), static_cast<uint64_t>(kProducers * kTasksPerProducer));
+
+    loop->Quit();
+    t.join();
+}
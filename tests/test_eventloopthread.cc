@@ -7,6 +7,7 @@
 #include <set>
 #include <vector>
 #include <memory> // 需要包含 memory 头文件
+#include <pthread.h>
 
 using namespace net;
 
@@ -81,3 +82,57 @@ TEST_F(ThreadingInfrastructureTest, EventLoopThreadPoolDistributionAndLifecycle)
       // 如果测试能正常结束，就证明了 RAII 的正确性。
 }
 
+
+// 测试按负载挑选 loop 的策略
+TEST_F(ThreadingInfrastructureTest, LoadAwareSelection) {
+    EventLoopThreadPool pool(3);
+    pool.Start();
+
+    std::vector<EventLoop*> loops;
+    for (int i = 0; i < 3; ++i) {
+        loops.push_back(pool.GetNextLoop());
+    }
+    loops[0]->GetLoad().connections = 5;
+    loops[1]->GetLoad().connections = 1;
+    loops[2]->GetLoad().connections = 3;
+    loops[0]->GetLoad().pending_bytes = 0;
+    loops[1]->GetLoad().pending_bytes = 4096;
+    loops[2]->GetLoad().pending_bytes = 0;
+
+    pool.SetSelectPolicy(LoopSelectPolicy::kLeastConnections);
+    ASSERT_EQ(pool.GetNextLoop(), loops[1]);
+
+    // 积压字节相同时按连接数
+    pool.SetSelectPolicy(LoopSelectPolicy::kLeastPendingBytes);
+    ASSERT_EQ(pool.GetNextLoop(), loops[2]);
+
+    // 随机选两个时, 负载最高的 loop 永远不会被选中
+    pool.SetSelectPolicy(LoopSelectPolicy::kPowerOfTwoChoices);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_NE(pool.GetNextLoop(), loops[0]);
+    }
+
+    auto stats = pool.GetStats();
+    ASSERT_EQ(stats.size(), 3);
+    ASSERT_EQ(stats[1].connections, 1);
+    ASSERT_EQ(stats[1].pending_bytes, 4096);
+}
+
+// 测试 IO 线程绑核
+TEST_F(ThreadingInfrastructureTest, CoreAffinity) {
+    EventLoopThreadPool pool(1);
+    pool.SetAffinity(LoopAffinity::kCore);
+    pool.Start();
+    EventLoop* loop = pool.GetNextLoop();
+
+    std::promise<int> promise;
+    auto future = promise.get_future();
+    loop->RunInLoop([&promise]() {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        ::pthread_getaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set);
+        promise.set_value(CPU_COUNT(&cpu_set));
+    });
+    // 第 0 个 loop 只绑定在 CPU 0 上
+    ASSERT_EQ(future.get(), 1);
+}
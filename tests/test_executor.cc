@@ -0,0 +1,140 @@
+#include "context/context.h"
+#include "context/executor.h"
+#include "context/task.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace ctx;
+
+class ExecutorTest : public ::testing::Test {};
+
+// 小的 lambda 放在 Task 内部, 大的放到堆上, 两种都能正确移动和调用
+TEST_F(ExecutorTest, TaskInlineAndHeapStorage) {
+    EXPECT_EQ(sizeof(Task), 64u);
+
+    int calls = 0;
+    Task small([&calls]() { calls++; });
+    EXPECT_TRUE(small.IsInline());
+
+    std::array<char, 128> payload{};
+    payload[0] = 1;
+    Task large([&calls, payload]() { calls += payload[0]; });
+    EXPECT_FALSE(large.IsInline());
+
+    Task moved_small = std::move(small);
+    Task moved_large = std::move(large);
+    EXPECT_FALSE(small);
+    EXPECT_FALSE(large);
+    moved_small();
+    moved_large();
+    EXPECT_EQ(calls, 2);
+}
+
+// Task 可以持有只能移动的对象, 析构时释放
+TEST_F(ExecutorTest, TaskHoldsMoveOnlyCallable) {
+    auto counter = std::make_shared<int>(0);
+    std::weak_ptr<int> weak = counter;
+    {
+        auto owned = std::make_unique<std::shared_ptr<int>>(std::move(counter));
+        Task task([owned = std::move(owned)]() { (**owned)++; });
+        Task other;
+        other = std::move(task);
+        other();
+        EXPECT_EQ(*weak.lock(), 1);
+    }
+    EXPECT_TRUE(weak.expired());
+}
+
+// 注册后的 runner 可以被查到, 投递到不存在的 tag 在 debug 下断言, release 下返回失败
+TEST_F(ExecutorTest, RunnerLookupAfterRegistration) {
+#ifndef NDEBUG
+    // 在启动 runner 线程之前 fork
+    EXPECT_DEATH(Executor().PostTask(12345, []() {}), "unregistered runner tag");
+    EXPECT_DEATH(Executor().PostRetTask(12345, []() { return 0; }), "unregistered runner tag");
+#endif
+    Executor executor;
+    TaskRunnerTag strand = executor.AddStrandRunner(10);
+    TaskRunnerTag parallel = executor.AddParallelRunner(10, 2); // tag 冲突会换一个
+    EXPECT_NE(strand, parallel);
+
+    EXPECT_EQ(executor.PostRetTask(strand, []() { return 1; }).get(), 1);
+    EXPECT_EQ(executor.PostRetTask(parallel, [](int x) { return x * 2; }, 21).get(), 42);
+
+#ifdef NDEBUG
+    EXPECT_FALSE(executor.PostTask(12345, []() {}));
+    EXPECT_FALSE(executor.PostRetTask(12345, []() { return 0; }).valid());
+#endif
+}
+
+// 多线程并发投递的同时注册新的 runner
+TEST_F(ExecutorTest, ConcurrentPostDuringRegistration) {
+    constexpr int kThreads = 4;
+    constexpr int kPostsPerThread = 10000;
+    Executor executor;
+    TaskRunnerTag tag = executor.AddParallelRunner(1, 2);
+
+    std::atomic<int> executed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < kPostsPerThread; i++) {
+                executor.PostTask(tag, [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (int i = 0; i < 20; i++) {
+        executor.AddStrandRunner(100 + i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (executed.load() < kThreads * kPostsPerThread && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(executed.load(), kThreads * kPostsPerThread);
+}
+
+// 延时任务和重复任务
+TEST_F(ExecutorTest, DelayedAndRepeatedTasks) {
+    Executor executor;
+    TaskRunnerTag tag = executor.AddStrandRunner(1);
+
+    std::promise<void> delayed;
+    executor.PostDelayedTask(tag, [&delayed]() { delayed.set_value(); }, std::chrono::milliseconds(5));
+    EXPECT_EQ(delayed.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    std::atomic<int> repeats{0};
+    std::promise<void> repeated;
+    executor.PostRepeatedTask(tag, [&]() {
+        if (repeats.fetch_add(1) + 1 == 3) {
+            repeated.set_value();
+        }
+    }, std::chrono::milliseconds(1), 3);
+    EXPECT_EQ(repeated.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(repeats.load(), 3);
+}
+
+// 延时任务可以在到期前取消
+TEST_F(ExecutorTest, CancelDelayedTask) {
+    Executor executor;
+    TaskRunnerTag tag = executor.AddStrandRunner(1);
+
+    std::atomic<bool> fired{false};
+    TimerId id = executor.PostDelayedTask(tag, [&fired]() { fired = true; }, std::chrono::milliseconds(50));
+    EXPECT_TRUE(executor.CancelTimer(id));
+    EXPECT_FALSE(executor.CancelTimer(id));
+
+    std::promise<void> later;
+    executor.PostDelayedTask(tag, [&later]() { later.set_value(); }, std::chrono::milliseconds(80));
+    EXPECT_EQ(later.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_FALSE(fired.load());
+}
@@ -0,0 +1,143 @@
+#include "metrics/histogram.h"
+#include "metrics/registry.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace metrics;
+
+// 每个值都落在自己桶的 [lower, upper) 里, 桶宽不超过下界的 1/16
+TEST(HistogramTest, BucketBoundsContainValue) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> values;
+    for (uint64_t v = 0; v < 5000; v++) {
+        values.push_back(v);
+    }
+    for (int i = 0; i < 100000; i++) {
+        values.push_back(rng() >> (rng() % 64));
+    }
+    size_t last_index = 0;
+    for (uint64_t v = 0; v < 5000; v++) {
+        size_t index = Histogram::BucketIndex(v);
+        EXPECT_GE(index, last_index);
+        last_index = index;
+    }
+    for (uint64_t v : values) {
+        size_t index = Histogram::BucketIndex(v);
+        ASSERT_LT(index, Histogram::kBucketCount);
+        if (index == Histogram::kBucketCount - 1) {
+            EXPECT_GE(v, Histogram::BucketLowerBound(index));
+            continue;
+        }
+        uint64_t lower = Histogram::BucketLowerBound(index);
+        uint64_t upper = Histogram::BucketUpperBound(index);
+        ASSERT_LE(lower, v);
+        ASSERT_LT(v, upper);
+        EXPECT_LE((upper - lower) * Histogram::kSubBucketCount, std::max<uint64_t>(lower, Histogram::kSubBucketCount));
+    }
+}
+
+TEST(HistogramTest, QuantilesWithinPrecision) {
+    Histogram histogram;
+    std::mt19937_64 rng(2);
+    std::lognormal_distribution<double> latency(13.0, 1.0); // 中位数约 0.44ms
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 200000; i++) {
+        uint64_t v = static_cast<uint64_t>(latency(rng));
+        values.push_back(v);
+        histogram.Record(v);
+    }
+    std::sort(values.begin(), values.end());
+    auto snapshot = histogram.GetSnapshot();
+    EXPECT_EQ(snapshot.count, values.size());
+    EXPECT_EQ(snapshot.max, values.back());
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double exact = static_cast<double>(values[static_cast<size_t>(q * values.size()) - 1]);
+        EXPECT_NEAR(snapshot.ValueAtQuantile(q), exact, exact / Histogram::kSubBucketCount) << "q=" << q;
+    }
+    EXPECT_EQ(snapshot.ValueAtQuantile(1.0), values.back());
+}
+
+// 各线程写自己的分片, 合并后计数和总和都不丢
+TEST(HistogramTest, MergesPerThreadShards) {
+    Histogram histogram;
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 100000;
+    std::atomic<bool> done{false};
+    std::thread reader([&]() {
+        uint64_t last = 0;
+        while (!done.load()) {
+            uint64_t count = histogram.GetSnapshot().count;
+            EXPECT_GE(count, last);
+            last = count;
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; t++) {
+        writers.emplace_back([&histogram, t]() {
+            for (int i = 0; i < kPerThread; i++) {
+                histogram.Record(t * 1000 + i % 100);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+
+    auto snapshot = histogram.GetSnapshot();
+    EXPECT_EQ(snapshot.count, uint64_t{kThreads} * kPerThread);
+    uint64_t expected_sum = 0;
+    for (int t = 0; t < kThreads; t++) {
+        expected_sum += uint64_t{kPerThread} * t * 1000 + (kPerThread / 100) * 4950;
+    }
+    EXPECT_EQ(snapshot.sum, expected_sum);
+    EXPECT_EQ(snapshot.max, uint64_t{(kThreads - 1) * 1000 + 99});
+}
+
+// 同一个线程写多个直方图, 各自独立
+TEST(HistogramTest, ManyHistogramsOnOneThread) {
+    std::vector<std::unique_ptr<Histogram>> histograms;
+    for (int i = 0; i < 50; i++) {
+        histograms.push_back(std::make_unique<Histogram>());
+    }
+    for (int i = 0; i < 50; i++) {
+        for (int j = 0; j <= i; j++) {
+            histograms[i]->Record(j);
+        }
+    }
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(histograms[i]->GetSnapshot().count, static_cast<uint64_t>(i + 1));
+    }
+}
+
+TEST(RegistryTest, SameNameAndLabelsShareHistogram) {
+    auto& a = METRICS.GetHistogram("test_shared_seconds", "help", {{"stage", "a"}});
+    auto& b = METRICS.GetHistogram("test_shared_seconds", "other help", {{"stage", "b"}});
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(&a, &METRICS.GetHistogram("test_shared_seconds", "help", {{"stage", "a"}}));
+}
+
+TEST(RegistryTest, RendersPrometheusText) {
+    auto& histogram = METRICS.GetHistogram("test_render_seconds", "Render test.", {{"stage", "x\"y"}});
+    histogram.Record(1500);        // 1.5us
+    histogram.Record(2'000'000);   // 2ms
+    METRICS.SetGauge("test_render_depth", "Queue depth.", []() { return 7.0; });
+    METRICS.SetGauge("test_render_connections", "Per loop.", []() {
+        return std::vector<Registry::Sample>{{{{"loop", "0"}}, 3}, {{{"loop", "1"}}, 5}};
+    });
+
+    std::string text = METRICS.Render();
+    EXPECT_NE(text.find("# HELP test_render_seconds Render test.\n# TYPE test_render_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_bucket{stage=\"x\\\"y\",le=\"1.024e-06\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_bucket{stage=\"x\\\"y\",le=\"1.536e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_bucket{stage=\"x\\\"y\",le=\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_sum{stage=\"x\\\"y\"} 0.0020015\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_seconds_count{stage=\"x\\\"y\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE test_render_depth gauge\ntest_render_depth 7\n"), std::string::npos);
+    EXPECT_NE(text.find("test_render_connections{loop=\"0\"} 3\ntest_render_connections{loop=\"1\"} 5\n"), std::string::npos);
+}
@@ -1,15 +1,16 @@
 #include "gtest/gtest.h"
-#include "net/httprequest.h" // 引入我们要测试的类
+#include "http/httprequest.h" // 引入我们要测试的类
 #include "net/buffer.h"   // 引入 Buffer 类
 
-using namespace net;
+using namespace http;
+using net::Buffer;
 
 // 测试固件，为每个测试用例提供干净的环境
 class HttpRequestTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        // 每个测试开始前，都会调用 Init() 来重置 request 对象
-        request.Init();
+        // 每个测试开始前，都会调用 Reset() 来重置 request 对象
+        request.Reset();
     }
 
     Buffer buffer;
@@ -115,4 +116,85 @@ TEST_F(HttpRequestTest, ParseBadRequestLine) {
 TEST_F(HttpRequestTest, ParseBadHeader) {
     buffer.Append("GET / HTTP/1.1\r\nInvalid Header\r\n\r\n");
     ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kBadRequest);
-}
\ No newline at end of file
+}
+
+// Content-Length 之后的字节属于下一个请求, 不能被读进 body
+TEST_F(HttpRequestTest, ParsePipelinedRequests) {
+    buffer.Append("POST /a HTTP/1.1\r\nContent-Length: 3\r\n\r\nabcGET /b HTTP/1.1\r\n\r\n");
+
+    ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kGetRequest);
+    EXPECT_EQ(request.GetBody(), "abc");
+
+    request.Reset();
+    ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kGetRequest);
+    EXPECT_EQ(request.GetPath(), "/b");
+    EXPECT_EQ(buffer.ReadableBytes(), 0);
+}
+
+// query 参数从 path 中拆出来
+TEST_F(HttpRequestTest, ParseQueryString) {
+    buffer.Append("GET /predict?priority=bulk&deadline_ms=500&flag HTTP/1.1\r\n\r\n");
+
+    ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kGetRequest);
+    EXPECT_EQ(request.GetPath(), "/predict");
+    EXPECT_EQ(request.GetQuery(), "priority=bulk&deadline_ms=500&flag");
+    const auto& params = request.GetQueryParams();
+    EXPECT_EQ(params.at("priority"), "bulk");
+    EXPECT_EQ(params.at("deadline_ms"), "500");
+    EXPECT_EQ(params.at("flag"), "");
+}
+
+// chunked 请求体, 包括块扩展和 trailer
+TEST_F(HttpRequestTest, ParseChunkedBody) {
+    buffer.Append("POST /upload HTTP/1.1\r\n"
+                  "Transfer-Encoding: chunked\r\n"
+                  "\r\n"
+                  "5\r\nhello\r\n"
+                  "7;name=value\r\n, world\r\n"
+                  "0\r\n"
+                  "X-Checksum: 1234\r\n"
+                  "\r\n");
+
+    ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kGetRequest);
+    EXPECT_TRUE(request.IsChunked());
+    EXPECT_EQ(request.GetBody(), "hello, world");
+    EXPECT_EQ(buffer.ReadableBytes(), 0);
+}
+
+// chunked 请求体逐字节到达
+TEST_F(HttpRequestTest, ParseChunkedBodyByteByByte) {
+    const std::string raw = "POST /upload HTTP/1.1\r\n"
+                            "Transfer-Encoding: Chunked\r\n"
+                            "\r\n"
+                            "a\r\n0123456789\r\n"
+                            "1\r\nX\r\n"
+                            "0\r\n\r\n";
+    for (size_t i = 0; i + 1 < raw.size(); i++) {
+        buffer.Append(raw.substr(i, 1));
+        ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kNoRequest) << "at byte " << i;
+    }
+    buffer.Append(raw.substr(raw.size() - 1));
+    ASSERT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kGetRequest);
+    EXPECT_EQ(request.GetBody(), "0123456789X");
+}
+
+// 非法的块大小、块数据后缺少 CRLF、不支持的编码、非法 Content-Length
+TEST_F(HttpRequestTest, ParseBadChunkedBody) {
+    buffer.Append("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n");
+    EXPECT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kBadRequest);
+
+    request.Reset();
+    buffer.RetrieveAll();
+    buffer.Append("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcdef\r\n");
+    EXPECT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kBadRequest);
+
+    request.Reset();
+    buffer.RetrieveAll();
+    buffer.Append("POST / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n");
+    EXPECT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kBadRequest);
+
+    request.Reset();
+    buffer.RetrieveAll();
+    buffer.Append("POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n");
+    EXPECT_EQ(request.Parse(buffer), HttpRequest::HttpCode::kBadRequest);
+}
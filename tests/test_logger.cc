@@ -0,0 +1,63 @@
+// 编译期只保留 warn 及以上
+#define LOG_ACTIVE_LEVEL LOG_LEVEL_WARN
+#include "logging/logger.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+int Touch(int* counter) {
+    return ++*counter;
+}
+
+std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+}
+
+// 低于编译期级别的宏展开为空, 参数不会被求值
+TEST(LoggerTest, CompileTimeLevelStripsCalls) {
+    logging::InitConsole(logging::LogLevel::Off); // 运行时不输出, 但保留的宏仍会求值参数
+    int counter = 0;
+    LOG_TRACE("{}", Touch(&counter));
+    LOG_DEBUG("{}", Touch(&counter));
+    LOG_INFO("{}", Touch(&counter));
+    EXPECT_EQ(counter, 0);
+    LOG_WARN("{}", Touch(&counter));
+    EXPECT_EQ(counter, 1);
+}
+
+// 异步日志在 Shutdown 之后全部落盘, 顺序不变
+TEST(LoggerTest, AsyncLoggerFlushesOnShutdown) {
+    auto dir = std::filesystem::temp_directory_path() / "boneage_logger_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    logging::AsyncOptions async;
+    async.enabled = true;
+    async.queue_size = 16;
+    logging::Init(dir.string(), logging::LogLevel::Info, async);
+    for (int i = 0; i < 100; i++) {
+        LOG_WARN("line {}", i);
+    }
+    logging::Shutdown();
+
+    std::string content;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        content += ReadFile(entry.path());
+    }
+    std::filesystem::remove_all(dir);
+
+    size_t pos = 0;
+    for (int i = 0; i < 100; i++) {
+        pos = content.find("line " + std::to_string(i) + "\n", pos);
+        ASSERT_NE(pos, std::string::npos) << i;
+    }
+}
@@ -0,0 +1,89 @@
+#include "nn/classify.h"
+#include "nn/model_cache.h"
+#include "logging/logger.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class ModelCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!fs::exists(model_path_)) {
+            GTEST_SKIP() << "model not found: " << model_path_;
+        }
+        logging::InitConsole(logging::LogLevel::Warn);
+        cache_dir_ = fs::temp_directory_path() / ("test_model_cache-" + std::to_string(::getpid()));
+        fs::remove_all(cache_dir_);
+        env_ = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "test_model_cache");
+
+        fs::path joint = fs::path(__FILE__).parent_path() / "images" / "joint" / "123_annotations" / "Radius_Grade6.png";
+        image_ = cv::imread(joint.string());
+        ASSERT_FALSE(image_.empty()) << "cannot read " << joint;
+    }
+
+    void TearDown() override {
+        if (!cache_dir_.empty()) {
+            fs::remove_all(cache_dir_);
+        }
+    }
+
+    nn::ClassificationResult Classify() {
+        nn::MaturityClassifier classifier(env_, model_path_, false, {112, 112}, {1}, cache_dir_.string());
+        return classifier.Classify({image_}, {0})[0];
+    }
+
+    const std::string model_path_ = "/workspace/BoneAge-Server/models/bone_maturity_predict.onnx";
+    fs::path cache_dir_;
+    std::shared_ptr<Ort::Env> env_;
+    cv::Mat image_;
+};
+
+// 第一次加载写出缓存, 第二次从缓存加载, 结果不变
+TEST_F(ModelCacheTest, SecondLoadUsesCacheWithSameResult) {
+    nn::ModelCache cache(cache_dir_.string());
+    const std::string cached_path = cache.CachedModelPath(model_path_, false);
+    EXPECT_EQ(fs::path(cached_path).parent_path(), cache_dir_);
+
+    auto first = Classify();
+    ASSERT_TRUE(fs::exists(cached_path));
+    auto mtime = fs::last_write_time(cached_path);
+
+    auto second = Classify();
+    EXPECT_EQ(fs::last_write_time(cached_path), mtime);
+    EXPECT_EQ(second.maturity_stage, first.maturity_stage);
+    EXPECT_NEAR(second.confidence, first.confidence, 1e-4);
+
+    // 只有缓存文件, 临时文件都已改名
+    size_t files = 0;
+    for (const auto& entry : fs::directory_iterator(cache_dir_)) {
+        EXPECT_EQ(entry.path().extension(), ".onnx");
+        files++;
+    }
+    EXPECT_EQ(files, 1u);
+}
+
+// 缓存文件损坏时删掉重新生成, 不影响加载
+TEST_F(ModelCacheTest, BrokenCacheIsRebuilt) {
+    nn::ModelCache cache(cache_dir_.string());
+    const std::string cached_path = cache.CachedModelPath(model_path_, false);
+    fs::create_directories(cache_dir_);
+    {
+        std::ofstream file(cached_path, std::ios::binary);
+        file << "not a model";
+    }
+
+    auto result = Classify();
+    EXPECT_GE(result.maturity_stage, 1);
+    EXPECT_GT(fs::file_size(cached_path), 100u);
+}
+
+// provider 不同缓存文件不同
+TEST_F(ModelCacheTest, KeyDependsOnProvider) {
+    nn::ModelCache cache(cache_dir_.string());
+    EXPECT_NE(cache.CachedModelPath(model_path_, false), cache.CachedModelPath(model_path_, true));
+}
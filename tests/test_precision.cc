@@ -0,0 +1,21 @@
+#include "nn/precision.h"
+#include <gtest/gtest.h>
+
+using nn::ModelPathFor;
+using nn::Precision;
+
+TEST(PrecisionTest, Fp32KeepsPath) {
+    EXPECT_EQ(ModelPathFor("models/bone_maturity_predict.onnx", Precision::kFp32), "models/bone_maturity_predict.onnx");
+}
+
+// int8 模型和 fp32 模型在同一目录, 文件名多一个 _int8 后缀, 和 code/tools/quantize_models.py 的输出一致
+TEST(PrecisionTest, Int8UsesSiblingFile) {
+    EXPECT_EQ(ModelPathFor("models/yolo11m_detect.onnx", Precision::kInt8), "models/yolo11m_detect_int8.onnx");
+    EXPECT_EQ(ModelPathFor("/opt/models/v2.1/cls.onnx", Precision::kInt8), "/opt/models/v2.1/cls_int8.onnx");
+    EXPECT_EQ(ModelPathFor("cls.onnx", Precision::kInt8), "cls_int8.onnx");
+}
+
+// 命令行直接给了 int8 模型时不再加后缀
+TEST(PrecisionTest, Int8PathIsNotSuffixedTwice) {
+    EXPECT_EQ(ModelPathFor("models/cls_int8.onnx", Precision::kInt8), "models/cls_int8.onnx");
+}
@@ -0,0 +1,200 @@
+#include "inference/request_scheduler.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace inference;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct FakeTask {
+    int id{0};
+    Priority priority{Priority::kNormal};
+    std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+    std::chrono::steady_clock::time_point enqueue_time{};
+};
+
+}
+
+class RequestSchedulerTest : public ::testing::Test {
+protected:
+    using Scheduler = RequestScheduler<FakeTask>;
+
+    void Push(int id, Priority priority,
+              std::chrono::steady_clock::time_point deadline = Scheduler::kNoDeadline) {
+        FakeTask task;
+        task.id = id;
+        task.priority = priority;
+        task.deadline = deadline;
+        ASSERT_TRUE(scheduler_.Push(std::move(task)));
+    }
+
+    std::vector<int> PopIds(size_t max_batch) {
+        std::vector<FakeTask> batch, expired;
+        EXPECT_TRUE(scheduler_.PopBatch(max_batch, &batch, &expired));
+        std::vector<int> ids;
+        for (auto& task : batch) {
+            ids.push_back(task.id);
+        }
+        return ids;
+    }
+
+    Scheduler scheduler_{100};
+};
+
+// 高优先级先出, 一个 batch 不混合不同级别
+TEST_F(RequestSchedulerTest, HigherClassFirstAndBatchesStayInOneClass) {
+    Push(1, Priority::kBulk);
+    Push(2, Priority::kBulk);
+    Push(3, Priority::kInteractive);
+    Push(4, Priority::kNormal);
+
+    EXPECT_EQ(PopIds(8), std::vector<int>({3}));
+    EXPECT_EQ(PopIds(8), std::vector<int>({4}));
+    EXPECT_EQ(PopIds(8), std::vector<int>({1, 2}));
+    EXPECT_EQ(scheduler_.Size(), 0u);
+}
+
+// 同一级别内截止时间早的先出, 没有截止时间的按到达顺序排在最后
+TEST_F(RequestSchedulerTest, EarliestDeadlineFirstWithinClass) {
+    auto now = std::chrono::steady_clock::now();
+    Push(1, Priority::kNormal);
+    Push(2, Priority::kNormal, now + 30s);
+    Push(3, Priority::kNormal);
+    Push(4, Priority::kNormal, now + 10s);
+    Push(5, Priority::kNormal, now + 20s);
+
+    EXPECT_EQ(PopIds(2), std::vector<int>({4, 5}));
+    EXPECT_EQ(PopIds(10), std::vector<int>({2, 1, 3}));
+}
+
+// 过期任务不进 batch, 单独返回并计数
+TEST_F(RequestSchedulerTest, ExpiredTasksAreDroppedBeforeBatching) {
+    auto now = std::chrono::steady_clock::now();
+    Push(1, Priority::kInteractive, now - 1ms);
+    Push(2, Priority::kNormal, now - 1ms);
+    Push(3, Priority::kNormal, now + 10s);
+    Push(4, Priority::kBulk);
+
+    std::vector<FakeTask> batch, expired;
+    ASSERT_TRUE(scheduler_.PopBatch(4, &batch, &expired));
+    ASSERT_EQ(expired.size(), 2u);
+    EXPECT_EQ(expired[0].id, 1);
+    EXPECT_EQ(expired[1].id, 2);
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_EQ(batch[0].id, 3);
+
+    EXPECT_EQ(scheduler_.GetStats(Priority::kInteractive).expired, 1u);
+    EXPECT_EQ(scheduler_.GetStats(Priority::kNormal).expired, 1u);
+    EXPECT_EQ(scheduler_.GetStats(Priority::kNormal).scheduled, 1u);
+    EXPECT_EQ(scheduler_.GetStats(Priority::kBulk).pending, 1u);
+}
+
+// 低级别的过期任务在服务高级别时也会被清掉, 释放队列容量
+TEST_F(RequestSchedulerTest, ExpiredTasksAreReapedAcrossClasses) {
+    auto now = std::chrono::steady_clock::now();
+    Push(1, Priority::kInteractive);
+    Push(2, Priority::kBulk, now - 1ms);
+    Push(3, Priority::kNormal, now - 1ms);
+    Push(4, Priority::kBulk);
+
+    std::vector<FakeTask> batch, expired;
+    ASSERT_TRUE(scheduler_.PopBatch(4, &batch, &expired));
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_EQ(batch[0].id, 1);
+    ASSERT_EQ(expired.size(), 2u);
+    EXPECT_EQ(expired[0].id, 3);
+    EXPECT_EQ(expired[1].id, 2);
+    EXPECT_EQ(scheduler_.Size(), 1u);
+    EXPECT_EQ(scheduler_.GetStats(Priority::kBulk).expired, 1u);
+}
+
+// 截止时间只接受 (0, 24h], 太大的值会让 now + ms 溢出
+TEST(DeadlineTest, RejectsOutOfRangeValues) {
+    auto deadline = RequestScheduler<FakeTask>::kNoDeadline;
+    EXPECT_FALSE(DeadlineFromNow(0, &deadline));
+    EXPECT_FALSE(DeadlineFromNow(-5, &deadline));
+    EXPECT_FALSE(DeadlineFromNow(kMaxDeadline.count() + 1, &deadline));
+    EXPECT_FALSE(DeadlineFromNow(std::numeric_limits<long long>::max(), &deadline));
+    EXPECT_EQ(deadline, RequestScheduler<FakeTask>::kNoDeadline);
+
+    auto before = std::chrono::steady_clock::now();
+    ASSERT_TRUE(DeadlineFromNow(kMaxDeadline.count(), &deadline));
+    EXPECT_GE(deadline, before + kMaxDeadline);
+    EXPECT_GT(deadline, std::chrono::steady_clock::now());
+}
+
+// 一组任务按顺序相邻出队; 放不下整组时不阻塞, 直接返回 false 且一张也不放
+TEST_F(RequestSchedulerTest, GroupIsDequeuedTogether) {
+    scheduler_.SetCapacity(6);
+    Push(100, Priority::kBulk);
+
+    auto make_group = []() {
+        std::vector<FakeTask> group;
+        for (int i = 0; i < 6; i++) {
+            FakeTask task;
+            task.id = i;
+            task.priority = Priority::kBulk;
+            group.push_back(task);
+        }
+        return group;
+    };
+    EXPECT_FALSE(scheduler_.TryPushGroup(make_group()));
+    EXPECT_EQ(scheduler_.Size(), 1u);
+    EXPECT_EQ(PopIds(4), std::vector<int>({100}));
+
+    EXPECT_TRUE(scheduler_.TryPushGroup(make_group()));
+    EXPECT_EQ(scheduler_.Size(), 6u);
+    EXPECT_FALSE(scheduler_.TryPush(FakeTask{7}));
+    EXPECT_EQ(PopIds(4), std::vector<int>({0, 1, 2, 3}));
+    EXPECT_TRUE(scheduler_.TryPush(FakeTask{7}));
+    EXPECT_EQ(PopIds(4), std::vector<int>({7})); // normal 比 bulk 优先
+    EXPECT_EQ(PopIds(4), std::vector<int>({4, 5}));
+
+    scheduler_.Close();
+    EXPECT_FALSE(scheduler_.TryPushGroup(make_group()));
+    EXPECT_FALSE(scheduler_.TryPush(FakeTask{8}));
+}
+
+// 排队时间按级别统计
+TEST_F(RequestSchedulerTest, TracksQueueWaitPerClass) {
+    Push(1, Priority::kBulk);
+    std::this_thread::sleep_for(5ms);
+    PopIds(1);
+
+    auto bulk = scheduler_.GetStats(Priority::kBulk);
+    EXPECT_EQ(bulk.scheduled, 1u);
+    EXPECT_GE(bulk.total_wait_ns, 5'000'000u);
+    EXPECT_EQ(bulk.max_wait_ns, bulk.total_wait_ns);
+    EXPECT_EQ(scheduler_.GetStats(Priority::kInteractive).scheduled, 0u);
+}
+
+// 队列满时生产者阻塞, Close 唤醒所有等待的生产者和消费者
+TEST_F(RequestSchedulerTest, CloseWakesBlockedProducersAndConsumers) {
+    scheduler_.SetCapacity(1);
+    Push(1, Priority::kNormal);
+
+    std::atomic<bool> push_result{true};
+    std::thread producer([this, &push_result]() {
+        push_result = scheduler_.Push(FakeTask{2});
+    });
+    EXPECT_EQ(PopIds(1), std::vector<int>({1}));
+    producer.join();
+    EXPECT_TRUE(push_result);
+    EXPECT_EQ(PopIds(1), std::vector<int>({2}));
+
+    std::atomic<bool> pop_result{true};
+    std::thread consumer([this, &pop_result]() {
+        std::vector<FakeTask> batch, expired;
+        pop_result = scheduler_.PopBatch(1, &batch, &expired);
+    });
+    std::this_thread::sleep_for(10ms);
+    scheduler_.Close();
+    consumer.join();
+    EXPECT_FALSE(pop_result);
+    EXPECT_FALSE(scheduler_.Push(FakeTask{3}));
+}
@@ -0,0 +1,203 @@
+#include "inference/result_writer.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <limits>
+#include <random>
+
+using json = nlohmann::json;
+using namespace inference;
+
+// 之前基于 nlohmann DOM 的序列化, 作为逐字节对比的基准
+namespace inference {
+
+void to_json(json& j, const BoneDetail& bone) {
+    j = {
+        {"joint", bone.joint},
+        {"box", {{"x", bone.box.x}, {"y", bone.box.y}, {"width", bone.box.width}, {"height", bone.box.height}}},
+        {"category_id", bone.category_id},
+        {"maturity_stage", bone.maturity_stage}
+    };
+}
+
+void to_json(json& j, const RusChnResult& rus_chn) {
+    j = {
+        {"sex", rus_chn.sex == BoneInfo::Sex::kBoy ? "boy" : "girl"},
+        {"total_score", rus_chn.total_score},
+        {"bone_age", rus_chn.bone_age}
+    };
+}
+
+void to_json(json& j, const HandDetail& hand) {
+    j = {
+        {"is_valid", hand.is_valid},
+        {"bones_detail", hand.bones_detail}
+    };
+    if (hand.rus_chn) {
+        j["rus_chn"] = *hand.rus_chn;
+    }
+}
+
+}
+
+class ResultWriterTest : public ::testing::Test {
+protected:
+    std::string Write(const HandDetail& hand) {
+        writer_.Clear();
+        writer_.Write(hand);
+        return writer_.ToString();
+    }
+
+    HandDetail RandomHand() {
+        std::uniform_int_distribution<int> coord(-50, 4000);
+        std::uniform_int_distribution<int> stage(0, 14);
+        HandDetail hand;
+        hand.is_valid = rng_() & 1;
+        size_t bones = rng_() % 22;
+        for (size_t i = 0; i < bones; i++) {
+            auto joint = BoneInfo::kKeyJoints[rng_() % BoneInfo::kKeyJoints.size()];
+            hand.bones_detail.push_back({std::string(joint), cv::Rect(coord(rng_), coord(rng_), coord(rng_), coord(rng_)),
+                                         static_cast<int>(rng_() % 9), stage(rng_)});
+        }
+        if (rng_() & 1) {
+            std::uniform_int_distribution<int> score(0, 1000);
+            auto sex = (rng_() & 1) ? BoneInfo::Sex::kBoy : BoneInfo::Sex::kGirl;
+            int total = score(rng_);
+            hand.rus_chn = RusChnResult{sex, total, BoneInfo::RusChnBoneAge(sex, total)};
+        }
+        return hand;
+    }
+
+    ResultWriter writer_;
+    std::mt19937 rng_{7};
+};
+
+TEST_F(ResultWriterTest, EmptyHand) {
+    HandDetail hand;
+    hand.is_valid = false;
+    EXPECT_EQ(Write(hand), R"({"bones_detail":[],"is_valid":false})");
+    EXPECT_EQ(Write(hand), json(hand).dump());
+}
+
+TEST_F(ResultWriterTest, MatchesNlohmannOnRandomResults) {
+    for (int i = 0; i < 2000; i++) {
+        HandDetail hand = RandomHand();
+        ASSERT_EQ(Write(hand), json(hand).dump()) << "case " << i;
+    }
+}
+
+// 骨龄的各种取值: 整数补 .0, 小数和 Grisu2 的输出一致, 非有限值写 null
+TEST_F(ResultWriterTest, DoubleFormattingMatchesNlohmann) {
+    const double values[] = {0.0, -0.0, 1.0, 12.0, 0.1, 1.0 / 3, 7.25, 17.999999999999996, 1e-4, 123456789.125,
+                             999999999999999.0, std::numeric_limits<double>::quiet_NaN(),
+                             std::numeric_limits<double>::infinity()};
+    for (double value : values) {
+        HandDetail hand;
+        hand.is_valid = true;
+        hand.rus_chn = RusChnResult{BoneInfo::Sex::kGirl, 1, value};
+        EXPECT_EQ(Write(hand), json(hand).dump()) << value;
+    }
+    std::uniform_real_distribution<double> age(0.0, 20.0);
+    for (int i = 0; i < 10000; i++) {
+        HandDetail hand;
+        hand.is_valid = true;
+        hand.rus_chn = RusChnResult{BoneInfo::Sex::kBoy, 1, age(rng_)};
+        ASSERT_EQ(Write(hand), json(hand).dump());
+    }
+}
+
+TEST_F(ResultWriterTest, EscapesStringsLikeNlohmann) {
+    HandDetail hand;
+    hand.is_valid = true;
+    hand.bones_detail.push_back({"a\"b\\c\n\t\x01\x1f/\xe6\xa1\xa1", cv::Rect(1, 2, 3, 4), 0, 0});
+    EXPECT_EQ(Write(hand), json(hand).dump());
+}
+
+// Write 是追加, Clear 之后复用同一块内存
+TEST_F(ResultWriterTest, AppendsAndReusesBuffer) {
+    HandDetail hand = RandomHand();
+    std::string once = Write(hand);
+    writer_.Write(hand);
+    EXPECT_EQ(writer_.View(), once + once);
+    writer_.Clear();
+    EXPECT_EQ(writer_.Size(), 0u);
+    writer_.Write(hand);
+    EXPECT_EQ(writer_.View(), once);
+}
+
+// 二进制格式和 JSON 的结构一样, 只是 box 是 [x, y, width, height]
+json ExpectedBinaryDom(const HandDetail& hand) {
+    json expected = hand;
+    for (auto& bone : expected["bones_detail"]) {
+        const auto& box = bone["box"];
+        bone["box"] = json::array({box["x"], box["y"], box["width"], box["height"]});
+    }
+    return expected;
+}
+
+TEST_F(ResultWriterTest, MsgPackDecodesToSameStructure) {
+    BinaryResultWriter writer(ResultFormat::kMsgPack);
+    for (int i = 0; i < 500; i++) {
+        HandDetail hand = RandomHand();
+        writer.Clear();
+        writer.Write(hand);
+        std::string_view bytes = writer.View();
+        ASSERT_EQ(json::from_msgpack(bytes.begin(), bytes.end()), ExpectedBinaryDom(hand)) << "case " << i;
+    }
+}
+
+TEST_F(ResultWriterTest, CborDecodesToSameStructure) {
+    BinaryResultWriter writer(ResultFormat::kCbor);
+    for (int i = 0; i < 500; i++) {
+        HandDetail hand = RandomHand();
+        writer.Clear();
+        writer.Write(hand);
+        std::string_view bytes = writer.View();
+        ASSERT_EQ(json::from_cbor(bytes.begin(), bytes.end()), ExpectedBinaryDom(hand)) << "case " << i;
+    }
+}
+
+// 各种宽度的整数和字符串长度都能正确往返
+TEST_F(ResultWriterTest, BinaryPrimitivesRoundTrip) {
+    const int64_t ints[] = {0, 1, 23, 24, 127, 128, 255, 256, 65535, 65536, 4294967295LL, 4294967296LL,
+                            -1, -24, -25, -32, -33, -128, -129, -32768, -32769, INT32_MIN, INT64_MIN, INT64_MAX};
+    const size_t lengths[] = {0, 15, 16, 23, 24, 31, 32, 255, 256, 70000};
+    for (auto format : {ResultFormat::kMsgPack, ResultFormat::kCbor}) {
+        BinaryResultWriter writer(format);
+        json expected = json::array();
+        writer.WriteArrayHeader(std::size(ints) + std::size(lengths) * 2 + 3);
+        for (int64_t value : ints) {
+            writer.WriteInt(value);
+            expected.push_back(value);
+        }
+        for (size_t length : lengths) {
+            std::string str(length, 'a');
+            writer.WriteString(str);
+            expected.push_back(str);
+            writer.WriteArrayHeader(length);
+            json array = json::array();
+            for (size_t i = 0; i < length; i++) {
+                writer.WriteBool(i % 2);
+                array.push_back(static_cast<bool>(i % 2));
+            }
+            expected.push_back(array);
+        }
+        writer.WriteDouble(-1.5);
+        expected.push_back(-1.5);
+        writer.WriteMapHeader(20);
+        json map = json::object();
+        for (int i = 0; i < 20; i++) {
+            std::string key = fmt::format("k{:02}", i);
+            writer.WriteString(key);
+            writer.WriteInt(i);
+            map[key] = i;
+        }
+        expected.push_back(map);
+        writer.WriteEncoded(std::string(1, format == ResultFormat::kCbor ? '\xf6' : '\xc0')); // null
+        expected.push_back(nullptr);
+
+        std::string_view bytes = writer.View();
+        json decoded = format == ResultFormat::kCbor ? json::from_cbor(bytes.begin(), bytes.end())
+                                                     : json::from_msgpack(bytes.begin(), bytes.end());
+        EXPECT_EQ(decoded, expected);
+    }
+}
@@ -0,0 +1,143 @@
+#include "context/executor.h"
+#include "context/strand.h"
+#include "context/thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ctx;
+
+class StrandTest : public ::testing::Test {
+protected:
+    // 等待 counter 达到 expected, 超时返回 false
+    static bool WaitFor(const std::atomic<int>& counter, int expected) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (counter.load() < expected) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+};
+
+// 多个线程同时投递, 每个线程投递的任务在 strand 中保持先后顺序
+TEST_F(StrandTest, KeepsPerProducerFifoOrder) {
+    constexpr int kProducers = 4;
+    constexpr int kTasksPerProducer = 5000;
+    ThreadPool pool(4);
+    Strand strand(&pool);
+
+    std::vector<int> last_seen(kProducers, -1);
+    std::atomic<int> executed{0};
+    std::atomic<bool> out_of_order{false};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kTasksPerProducer; i++) {
+                strand.Post([&, p, i]() {
+                    // strand 保证串行, 这里不需要加锁
+                    if (last_seen[p] != i - 1) {
+                        out_of_order = true;
+                    }
+                    last_seen[p] = i;
+                    executed.fetch_add(1);
+                });
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    ASSERT_TRUE(WaitFor(executed, kProducers * kTasksPerProducer));
+    EXPECT_FALSE(out_of_order.load());
+    pool.Stop(); // strand 销毁前先停掉线程池
+}
+
+// 同一个 strand 的任务不会同时在两个线程上运行, 不同 strand 可以并行
+TEST_F(StrandTest, NeverRunsConcurrently) {
+    constexpr int kStrands = 8;
+    constexpr int kTasksPerStrand = 200;
+    ThreadPool pool(4);
+    std::vector<std::unique_ptr<Strand>> strands;
+    std::vector<std::atomic<int>> in_flight(kStrands);
+    for (int s = 0; s < kStrands; s++) {
+        strands.emplace_back(std::make_unique<Strand>(&pool));
+        in_flight[s] = 0;
+    }
+
+    std::atomic<int> executed{0};
+    std::atomic<bool> overlapped{false};
+    for (int i = 0; i < kTasksPerStrand; i++) {
+        for (int s = 0; s < kStrands; s++) {
+            strands[s]->Post([&, s]() {
+                if (in_flight[s].fetch_add(1) != 0) {
+                    overlapped = true;
+                }
+                std::this_thread::yield();
+                in_flight[s].fetch_sub(1);
+                executed.fetch_add(1);
+            });
+        }
+    }
+
+    ASSERT_TRUE(WaitFor(executed, kStrands * kTasksPerStrand));
+    EXPECT_FALSE(overlapped.load());
+    pool.Stop();
+}
+
+// 大量 strand 共享线程池, 线程数不随 strand 数量增长
+TEST_F(StrandTest, ManyStrandsShareThreads) {
+    constexpr int kStrands = 10000;
+    Executor executor;
+    std::vector<TaskRunnerTag> tags;
+    for (int i = 0; i < kStrands; i++) {
+        tags.push_back(executor.AddStrandRunner(1));
+    }
+
+    std::mutex mutex;
+    std::set<std::thread::id> thread_ids;
+    std::atomic<int> executed{0};
+    for (TaskRunnerTag tag : tags) {
+        executor.PostTask(tag, [&]() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                thread_ids.insert(std::this_thread::get_id());
+            }
+            executed.fetch_add(1);
+        });
+    }
+
+    ASSERT_TRUE(WaitFor(executed, kStrands));
+    EXPECT_LE(thread_ids.size(), std::max(4u, std::thread::hardware_concurrency()));
+}
+
+// PostRetTask 在 strand 上按顺序执行并返回结果
+TEST_F(StrandTest, PostRetTaskOnStrand) {
+    Executor executor;
+    TaskRunnerTag tag = executor.AddStrandRunner(1);
+
+    std::vector<int> order;
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; i++) {
+        results.push_back(executor.PostRetTask(tag, [&order](int x) {
+            order.push_back(x);
+            return x * x;
+        }, i));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(order[i], i);
+    }
+}
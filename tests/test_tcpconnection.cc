@@ -4,6 +4,9 @@
 #include "net/socket.h"
 #include "net/buffer.h"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <string>
 #include <thread>
 #include <future>
 #include <unistd.h>
@@ -61,7 +64,7 @@ TEST_F(TcpConnectionTest, FullLifecycle) {
 
     // 5. 在 EventLoop 线程中创建 TcpConnection
     loop->RunInLoop([&]() {
-        TcpConnection::Ptr conn = std::make_shared<TcpConnection>(loop, conn_fd, "a", server_addr, peer_addr);
+        TcpConnection::Ptr conn = std::make_shared<TcpConnection>(loop, conn_fd, 1, peer_addr);
         
         conn->SetConnectionCallback([&](const TcpConnection::Ptr& c) {
             connection_cb_count++;
@@ -114,4 +117,72 @@ TEST_F(TcpConnectionTest, FullLifecycle) {
     // 9. 清理
     loop->Quit();
     server_thread.join();
-}
\ No newline at end of file
+}
+
+// 暂停读期间对端发来的数据不触发消息回调, 没取走的数据留在 GetInputBuffer 里, 恢复后和新数据一起交给回调
+TEST_F(TcpConnectionTest, StopAndStartReading) {
+    std::promise<EventLoop*> loop_promise;
+    auto loop_future = loop_promise.get_future();
+    std::thread server_thread([&]() {
+        EventLoop loop;
+        loop_promise.set_value(&loop);
+        loop.Loop();
+    });
+    EventLoop* loop = loop_future.get();
+
+    Socket listen_sock = Socket::CreateNonblockingTCP();
+    listen_sock.SetReuseAddr(true);
+    ASSERT_TRUE(listen_sock.Bind(InetAddress("127.0.0.1", 0)));
+    ASSERT_TRUE(listen_sock.Listen());
+    struct sockaddr_in actual_addr;
+    socklen_t len = sizeof(actual_addr);
+    ASSERT_EQ(::getsockname(listen_sock.GetFd(), (struct sockaddr*)&actual_addr, &len), 0);
+
+    int client_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(::connect(client_fd, InetAddress(actual_addr).GetSockAddr(), sizeof(struct sockaddr_in)), 0);
+    InetAddress peer_addr;
+    Socket conn_socket = listen_sock.Accept(&peer_addr);
+    ASSERT_TRUE(conn_socket.IsValid());
+    int conn_fd = conn_socket.Release();
+
+    std::atomic<int> messages{0};
+    std::promise<std::string> second_promise;
+    auto second_future = second_promise.get_future();
+    std::promise<TcpConnection::Ptr> conn_promise;
+    auto conn_future = conn_promise.get_future();
+    loop->RunInLoop([&]() {
+        auto conn = std::make_shared<TcpConnection>(loop, conn_fd, 1, peer_addr);
+        conn->SetMessageCallback([&](const TcpConnection::Ptr& c, Buffer& buf) {
+            if (++messages == 1) {
+                c->StopReading(); // 不取走数据, 模拟应用层暂停解析
+            } else {
+                second_promise.set_value(buf.RetrieveAllToString());
+            }
+        });
+        conn->ConnectEstablished();
+        conn_promise.set_value(conn);
+    });
+    TcpConnection::Ptr conn = conn_future.get();
+
+    ASSERT_EQ(::write(client_fd, "a", 1), 1);
+    for (int i = 0; i < 100 && messages == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(::write(client_fd, "b", 1), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(messages.load(), 1);
+
+    std::promise<size_t> parked_promise;
+    loop->RunInLoop([&]() {
+        parked_promise.set_value(conn->GetInputBuffer().ReadableBytes());
+        conn->StartReading();
+    });
+    EXPECT_EQ(parked_promise.get_future().get(), 1u);
+    ASSERT_EQ(second_future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(second_future.get(), "ab");
+
+    ::close(client_fd);
+    loop->RunInLoop([conn]() { conn->ConnectDestroyed(); });
+    loop->Quit();
+    server_thread.join();
+}
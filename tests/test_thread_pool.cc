@@ -0,0 +1,116 @@
+#include "context/thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ctx;
+
+class ThreadPoolTest : public ::testing::Test {};
+
+// 测试 RunTask / RunRetTask 的基本功能, 包括带参数的调用
+TEST_F(ThreadPoolTest, RunTaskAndRetTask) {
+    ThreadPool pool(4);
+
+    auto add = pool.RunRetTask([](int a, int b) { return a + b; }, 1, 2);
+    EXPECT_EQ(add.get(), 3);
+
+    std::promise<std::string> promise;
+    auto future = promise.get_future();
+    pool.RunTask([&promise](const std::string& s) { promise.set_value(s + "!"); }, std::string("hi"));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(future.get(), "hi!");
+}
+
+// 多个外部线程同时提交, 所有任务都恰好执行一次
+TEST_F(ThreadPoolTest, ManyProducersAllTasksRun) {
+    constexpr int kProducers = 4;
+    constexpr int kTasksPerProducer = 20000;
+    ThreadPool pool(4);
+
+    std::atomic<int> executed{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&]() {
+            for (int i = 0; i < kTasksPerProducer; i++) {
+                pool.RunTask([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (executed.load() < kProducers * kTasksPerProducer && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(executed.load(), kProducers * kTasksPerProducer);
+}
+
+// 工作线程内部派生的子任务会被其他空闲线程窃取执行
+TEST_F(ThreadPoolTest, NestedTasksAreStolen) {
+    constexpr int kChildren = 64;
+    ThreadPool pool(4);
+
+    std::mutex mutex;
+    std::set<std::thread::id> thread_ids;
+    std::atomic<int> done{0};
+    std::promise<void> all_done;
+
+    pool.RunTask([&]() {
+        for (int i = 0; i < kChildren; i++) {
+            pool.RunTask([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    thread_ids.insert(std::this_thread::get_id());
+                }
+                if (done.fetch_add(1) + 1 == kChildren) {
+                    all_done.set_value();
+                }
+            });
+        }
+    });
+
+    ASSERT_EQ(all_done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_GT(thread_ids.size(), 1u);
+}
+
+// 单线程的池 (strand) 必须按提交顺序执行, 包括任务内部再提交的任务
+TEST_F(ThreadPoolTest, SingleThreadKeepsFifoOrder) {
+    ThreadPool pool(1);
+    std::vector<int> order;
+    std::promise<void> gate;
+    auto gate_future = gate.get_future();
+
+    pool.RunTask([&]() {
+        gate_future.wait(); // 等外部任务全部提交完
+        order.push_back(0);
+        pool.RunTask([&]() { order.push_back(3); });
+    });
+    pool.RunTask([&]() { order.push_back(1); });
+    pool.RunTask([&]() { order.push_back(2); });
+    gate.set_value();
+    pool.RunRetTask([]() {}).wait();
+    pool.RunRetTask([]() {}).wait();
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+}
+
+// Stop 之后不再接受任务, 重新 Start 后可以继续使用
+TEST_F(ThreadPoolTest, StopAndRestart) {
+    ThreadPool pool(2);
+    EXPECT_EQ(pool.RunRetTask([]() { return 1; }).get(), 1);
+
+    pool.Stop();
+    auto invalid = pool.RunRetTask([]() { return 2; });
+    EXPECT_FALSE(invalid.valid());
+
+    pool.Start();
+    EXPECT_EQ(pool.RunRetTask([]() { return 3; }).get(), 3);
+}
@@ -0,0 +1,108 @@
+#include "context/timing_wheel.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace ctx;
+
+class TimingWheelTest : public ::testing::Test {
+protected:
+    // 逐 tick 推进, 记录每个任务实际执行时的 tick
+    void AdvanceTo(uint64_t tick) {
+        while (wheel_.CurrentTick() < tick) {
+            std::vector<Task> expired;
+            wheel_.Advance(wheel_.CurrentTick() + 1, &expired);
+            now_ = wheel_.CurrentTick();
+            for (auto& task : expired) {
+                task();
+            }
+        }
+    }
+
+    TimingWheel wheel_;
+    uint64_t now_ = 0;
+};
+
+// 各层的定时器都恰好在到期的 tick 执行, 包括超出时间轮范围的
+TEST_F(TimingWheelTest, ExpiresAtExactTickOnEveryLevel) {
+    const std::vector<uint64_t> expires = {1, 2, 255, 256, 257, 300, 16383, 16384, 70000,
+                                           1048576, 3000000, (uint64_t(1) << 26) + 5};
+    std::vector<uint64_t> fired_at(expires.size(), 0);
+    for (size_t i = 0; i < expires.size(); i++) {
+        wheel_.Add(expires[i], [this, &fired_at, i]() { fired_at[i] = now_; });
+    }
+    EXPECT_EQ(wheel_.Size(), expires.size());
+
+    AdvanceTo(expires.back());
+    for (size_t i = 0; i < expires.size(); i++) {
+        EXPECT_EQ(fired_at[i], expires[i]) << "timer " << i;
+    }
+    EXPECT_EQ(wheel_.Size(), 0u);
+}
+
+// 一次推进多个 tick, 到期任务按顺序批量返回
+TEST_F(TimingWheelTest, BatchedAdvance) {
+    std::vector<int> order;
+    for (int i = 0; i < 10; i++) {
+        wheel_.Add(100 + i * 50, [&order, i]() { order.push_back(i); });
+    }
+    std::vector<Task> expired;
+    wheel_.Advance(400, &expired);
+    EXPECT_EQ(expired.size(), 7u);
+    for (auto& task : expired) {
+        task();
+    }
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(wheel_.Size(), 3u);
+}
+
+// 取消后立即释放任务持有的资源, 旧的 id 复用节点后也不会误取消
+TEST_F(TimingWheelTest, CancelReleasesImmediately) {
+    auto resource = std::make_shared<int>(1);
+    std::weak_ptr<int> weak = resource;
+    bool fired = false;
+    TimerId id = wheel_.Add(1000, [resource = std::move(resource), &fired]() { fired = true; });
+    EXPECT_NE(id, 0u);
+
+    EXPECT_TRUE(wheel_.Cancel(id));
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(wheel_.Cancel(id));
+
+    TimerId reused = wheel_.Add(10, []() {});
+    EXPECT_NE(reused, id);
+    EXPECT_FALSE(wheel_.Cancel(id));
+    EXPECT_EQ(wheel_.Size(), 1u);
+
+    AdvanceTo(2000);
+    EXPECT_FALSE(fired);
+}
+
+// 重复定时器按间隔执行指定次数, 中途可以取消
+TEST_F(TimingWheelTest, RepeatedTimer) {
+    std::vector<uint64_t> fired_at;
+    wheel_.AddRepeated(10, 300, 4, [this, &fired_at]() { fired_at.push_back(now_); });
+    EXPECT_EQ(wheel_.AddRepeated(10, 10, 0, []() {}), 0u);
+
+    AdvanceTo(2000);
+    EXPECT_EQ(fired_at, (std::vector<uint64_t>{10, 310, 610, 910}));
+    EXPECT_EQ(wheel_.Size(), 0u);
+
+    int count = 0;
+    TimerId id = wheel_.AddRepeated(2001, 5, 100, [&count]() { count++; });
+    AdvanceTo(2021);
+    EXPECT_TRUE(wheel_.Cancel(id));
+    AdvanceTo(3000);
+    EXPECT_EQ(count, 5);
+}
+
+// NextExpiry 不会晚于最早的定时器
+TEST_F(TimingWheelTest, NextExpiryIsLowerBound) {
+    EXPECT_EQ(wheel_.NextExpiry(), UINT64_MAX);
+    wheel_.Add(40, []() {});
+    EXPECT_EQ(wheel_.NextExpiry(), 40u);
+    wheel_.Add(5000, []() {});
+    AdvanceTo(40);
+    uint64_t next = wheel_.NextExpiry();
+    EXPECT_GT(next, 40u);
+    EXPECT_LE(next, 5000u);
+}
@@ -0,0 +1,115 @@
+#include "tracing/tracer.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using tracing::Tracer;
+
+namespace {
+
+// 按名字和 id 找出导出结果里的事件
+std::vector<nlohmann::json> FindEvents(const nlohmann::json& trace, const std::string& name, uint64_t id) {
+    std::vector<nlohmann::json> events;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event.value("name", "") == name && event.contains("args") && event["args"].value("id", 0ull) == id) {
+            events.push_back(event);
+        }
+    }
+    return events;
+}
+
+}
+
+// 区间记录开始时间和持续时间, 换算成微秒
+TEST(TracerTest, SpanIsDumpedAsCompleteEvent) {
+    {
+        TRACE_SPAN("test", "span", 1001);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    auto trace = nlohmann::json::parse(Tracer::GetInstance().DumpChromeJson());
+    auto events = FindEvents(trace, "span", 1001);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0]["ph"], "X");
+    EXPECT_EQ(events[0]["cat"], "test");
+    EXPECT_GE(events[0]["dur"].get<double>(), 2000.0);
+}
+
+// 异步区间可以在一个线程开始, 在另一个线程结束, 两端带相同的 id
+TEST(TracerTest, AsyncEventsPairAcrossThreads) {
+    TRACE_ASYNC_BEGIN("test", "hop", 1002);
+    std::thread([]() { TRACE_ASYNC_END("test", "hop", 1002); }).join();
+
+    auto trace = nlohmann::json::parse(Tracer::GetInstance().DumpChromeJson());
+    auto events = FindEvents(trace, "hop", 1002);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0]["id"], events[1]["id"]);
+    EXPECT_NE(events[0]["tid"], events[1]["tid"]);
+    std::set<std::string> phases{events[0]["ph"].get<std::string>(), events[1]["ph"].get<std::string>()};
+    EXPECT_EQ(phases, std::set<std::string>({"b", "e"}));
+}
+
+// 环形缓冲区写满后只保留最近的事件, 导出时最旧的一个槽位可能正被覆盖, 也会被丢掉
+TEST(TracerTest, RingKeepsMostRecentEvents) {
+    std::thread([]() {
+        for (uint64_t i = 0; i < Tracer::kRingCapacity + 100; i++) {
+            TRACE_INSTANT("test", "wrap", 2'000'000 + i);
+        }
+    }).join();
+
+    auto trace = nlohmann::json::parse(Tracer::GetInstance().DumpChromeJson());
+    size_t count = 0;
+    uint64_t min_id = UINT64_MAX;
+    uint64_t max_id = 0;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event.value("name", "") == "wrap") {
+            count++;
+            min_id = std::min(min_id, event["args"]["id"].get<uint64_t>());
+            max_id = std::max(max_id, event["args"]["id"].get<uint64_t>());
+        }
+    }
+    EXPECT_GE(count, Tracer::kRingCapacity - 1);
+    EXPECT_LE(count, Tracer::kRingCapacity);
+    EXPECT_GE(min_id, 2'000'000u + 100);
+    EXPECT_EQ(max_id, 2'000'000u + Tracer::kRingCapacity + 99);
+}
+
+// 导出时其他线程还在写, 结果仍然是合法的 JSON
+TEST(TracerTest, DumpWhileRecording) {
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+        writers.emplace_back([&stop, t]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                TRACE_SPAN("test", "busy", 3000 + t);
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (int i = 0; i < 5; i++) {
+        auto trace = nlohmann::json::parse(Tracer::GetInstance().DumpChromeJson(), nullptr, false);
+        ASSERT_FALSE(trace.is_discarded());
+    }
+    stop = true;
+    for (auto& writer : writers) {
+        writer.join();
+    }
+}
+
+TEST(TracerTest, DumpToFileWritesTrace) {
+    TRACE_INSTANT("test", "file", 1003);
+    auto dir = std::filesystem::temp_directory_path();
+    std::string path = Tracer::GetInstance().DumpToFile(dir.string());
+    ASSERT_FALSE(path.empty());
+    std::ifstream file(path);
+    auto trace = nlohmann::json::parse(file, nullptr, false);
+    std::filesystem::remove(path);
+    ASSERT_FALSE(trace.is_discarded());
+    EXPECT_EQ(FindEvents(trace, "file", 1003).size(), 1u);
+}